@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_bitgrid_h
+#define au_bitgrid_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "grid.h"
+#include "kernels.h"
+
+namespace au
+{
+
+/// A bounded N-dimensional grid of booleans stored one bit per cell.
+///
+/// Cells are stored in row-major order with each row of the last dimension
+/// padded to a whole number of 64-bit words, so rows start on word
+/// boundaries and can be read, combined, and scanned a word at a time. The
+/// padding bits are always zero. Element access returns a proxy reference,
+/// as std::vector<bool> does.
+template <int N>
+class bitgrid
+{
+public:
+
+    typedef size_t              size_type;
+    typedef bool                value_type;
+    typedef bool                const_reference;
+    typedef uint64_t            word_type;
+
+    typedef grid_index<N, bool> index;
+
+    static const size_type bits_per_word = 64;
+
+    /// Proxy for a single bit of the grid.
+    class reference
+    {
+    public:
+
+        operator bool() const { return (*word_ & mask_) != 0; }
+        reference& operator=(bool value);
+        reference& operator=(const reference& other) { return *this = (bool)other; }
+        void flip() { *word_ ^= mask_; }
+
+    private:
+
+        friend class bitgrid;
+
+        word_type*  word_;
+        word_type   mask_;
+
+        reference(word_type* word, word_type mask) : word_(word), mask_(mask) { }
+    };
+
+    bitgrid();
+
+    template <typename... SizeTypes>
+    bitgrid(SizeTypes... sizes);
+
+    /// \name Element access
+    ///@{
+    template <typename... CoordTypes>
+    reference operator()(CoordTypes... coords);
+
+    template <typename... CoordTypes>
+    const_reference operator()(CoordTypes... coords) const;
+
+    reference operator()(const index& i);
+    const_reference operator()(const index& i) const;
+
+    template <typename... CoordTypes>
+    bool within_bounds(CoordTypes... coords) const;
+
+    /// Copy count bits of a row, starting at cell start and continuing along
+    /// the last dimension, into out, least significant bit first. out must
+    /// hold (count + 63) / 64 words; unused bits of the last word are cleared.
+    /// The bits must lie within the row.
+    void extract(const index& start, size_type count, word_type* out) const;
+    ///@}
+
+    /// \name Word access
+    ///
+    /// Rows are numbered in row-major order over all but the last dimension.
+    ///@{
+    word_type* words() { return words_.data(); }
+    const word_type* words() const { return words_.data(); }
+
+    word_type* row_words(size_type row) { return words_.data() + row * words_per_row_; }
+    const word_type* row_words(size_type row) const { return words_.data() + row * words_per_row_; }
+
+    size_type num_words() const { return words_.size(); }
+    size_type num_rows() const { return num_rows_; }
+    size_type words_per_row() const { return words_per_row_; }
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return dims_[dim]; }
+    size_type total_size() const { return num_rows_ * dims_[N - 1]; }
+
+    /// Return the number of bytes used by the grid.
+    size_type memory_usage() const { return sizeof(*this) + words_.capacity() * sizeof(word_type); }
+    ///@}
+
+    /// \name Bulk operations
+    ///
+    /// Binary operations require grids of the same size.
+    ///@{
+    bitgrid& operator&=(const bitgrid& rhs);
+    bitgrid& operator|=(const bitgrid& rhs);
+    bitgrid& operator^=(const bitgrid& rhs);
+
+    /// Invert every cell.
+    bitgrid& flip();
+
+    /// Return the number of set cells.
+    size_type count() const;
+
+    bool any() const;
+    bool none() const { return !any(); }
+
+    /// Find the first set cell in row-major order. Return false if there is
+    /// none.
+    bool find_first(index& i) const;
+
+    /// Find the first set cell after i in row-major order. Return false if
+    /// there is none.
+    bool find_next(index& i) const;
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+    void clear();
+
+    /// Resize the grid and reset every cell.
+    template <typename... SizeTypes>
+    void resize(SizeTypes... sizes);
+
+    void assign(bool value);
+
+    /// Resize to match a grid and set the cells whose values are nonzero.
+    template <typename T, typename Allocator>
+    void assign(const grid<N, T, row_major, Allocator>& g);
+
+    /// Resize a grid to match and store 1 in set cells and 0 elsewhere.
+    template <typename T, typename Allocator>
+    void unpack(grid<N, T, row_major, Allocator>& g) const;
+    ///@}
+
+private:
+
+    size_type               dims_[N];
+    size_type               num_rows_;
+    size_type               words_per_row_;
+    word_type               tail_mask_; // valid bits of the last word of each row
+    std::vector<word_type>  words_;
+
+    void set_dims(const size_type* dims);
+
+    size_type row_of(const size_type* c) const;
+
+    // find the first set cell in or after word w
+    bool find_from(size_type w, index& i) const;
+
+    void mask_padding();
+};
+
+} // namespace au
+
+#include "detail/bitgrid.h"
+
+#endif
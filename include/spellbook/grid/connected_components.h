@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_connected_components_h
+#define au_connected_components_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "grid.h"
+#include "parallel.h"
+
+namespace au
+{
+
+/// Which neighbors of a cell are connected to it.
+enum grid_connectivity
+{
+    connect_faces,  ///< neighbors sharing a face: 4 in 2D, 6 in 3D
+    connect_all     ///< neighbors sharing a face, edge, or corner: 8 in 2D, 26 in 3D
+};
+
+/// Summary of one connected component, in cell coordinates.
+template <int N>
+struct component_stats
+{
+    size_t size;
+    size_t min[N];      ///< inclusive bounding box
+    size_t max[N];
+    double centroid[N];
+};
+
+/// \name Connected-component labeling
+///
+/// Label the connected components of the foreground cells of a grid (those
+/// for which is_foreground(value) is true; the overloads without a predicate
+/// treat every value other than T() as foreground). Background cells are
+/// labeled 0 and components are labeled 1, 2, ... in row-major order of their
+/// first cells. labels is resized to match src, which may have at most 2^32 - 2
+/// cells.
+///
+/// The labeler is a two-pass union-find labeler that keeps its equivalence
+/// forest in the label grid itself. The first pass splits the grid into slabs
+/// along the first dimension that are scanned in parallel; the components
+/// that cross slab boundaries are then merged, and a final pass assigns
+/// consecutive labels.
+///@{
+
+/// Return the number of components.
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator, typename Predicate>
+uint32_t label_components(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    Predicate is_foreground,
+    grid_connectivity connectivity = connect_faces,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator>
+uint32_t label_components(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    grid_connectivity connectivity = connect_faces);
+
+/// Compute the size, bounding box, and centroid of each of the components of
+/// a label grid; stats[k - 1] describes the component labeled k.
+template <int N, typename LabelAllocator>
+void component_statistics(
+    const grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    uint32_t num_components,
+    std::vector<component_stats<N>>& stats);
+///@}
+
+} // namespace au
+
+#include "detail/connected_components.h"
+
+#endif
@@ -0,0 +1,344 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_bitgrid_h
+#define au_detail_bitgrid_h
+
+#include "../bitgrid.h"
+
+// standard includes
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+namespace au
+{
+
+template <int N>
+auto bitgrid<N>::reference::operator=(bool value) -> reference&
+{
+    if (value) {
+        *word_ |= mask_;
+    }
+    else {
+        *word_ &= ~mask_;
+    }
+    return *this;
+}
+
+template <int N>
+bitgrid<N>::bitgrid() :
+    num_rows_(0),
+    words_per_row_(0),
+    tail_mask_(0),
+    words_()
+{
+    std::fill(dims_, dims_ + N, 0);
+}
+
+template <int N>
+template <typename... SizeTypes>
+bitgrid<N>::bitgrid(SizeTypes... sizes) :
+    words_()
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to bitgrid");
+    const size_type dims[N] = { (size_type)sizes... };
+    set_dims(dims);
+}
+
+template <int N>
+template <typename... CoordTypes>
+auto bitgrid<N>::operator()(CoordTypes... coords) -> reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    return reference(
+            &words_[row_of(c) * words_per_row_ + c[N - 1] / bits_per_word],
+            (word_type)1 << (c[N - 1] % bits_per_word));
+}
+
+template <int N>
+template <typename... CoordTypes>
+auto bitgrid<N>::operator()(CoordTypes... coords) const -> const_reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    const word_type w = words_[row_of(c) * words_per_row_ + c[N - 1] / bits_per_word];
+    return (w >> (c[N - 1] % bits_per_word)) & 1;
+}
+
+template <int N>
+auto bitgrid<N>::operator()(const index& i) -> reference
+{
+    const size_type* c = i.coords();
+    return reference(
+            &words_[row_of(c) * words_per_row_ + c[N - 1] / bits_per_word],
+            (word_type)1 << (c[N - 1] % bits_per_word));
+}
+
+template <int N>
+auto bitgrid<N>::operator()(const index& i) const -> const_reference
+{
+    const size_type* c = i.coords();
+    const word_type w = words_[row_of(c) * words_per_row_ + c[N - 1] / bits_per_word];
+    return (w >> (c[N - 1] % bits_per_word)) & 1;
+}
+
+template <int N>
+template <typename... CoordTypes>
+bool bitgrid<N>::within_bounds(CoordTypes... coords) const
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
+    return CoordsInBounds(dims_, coords...);
+}
+
+template <int N>
+void bitgrid<N>::extract(const index& start, size_type count, word_type* out) const
+{
+    const size_type* c = start.coords();
+    assert(c[N - 1] + count <= dims_[N - 1]);
+
+    const word_type* row = row_words(row_of(c));
+    const size_type first = c[N - 1] / bits_per_word;
+    const size_type shift = c[N - 1] % bits_per_word;
+    const size_type out_words = (count + bits_per_word - 1) / bits_per_word;
+
+    if (shift == 0) {
+        memcpy(out, row + first, out_words * sizeof(word_type));
+    }
+    else {
+        const size_type last = (c[N - 1] + count - 1) / bits_per_word;
+        for (size_type i = 0; i < out_words; ++i) {
+            word_type w = row[first + i] >> shift;
+            if (first + i + 1 <= last) {
+                w |= row[first + i + 1] << (bits_per_word - shift);
+            }
+            out[i] = w;
+        }
+    }
+
+    if (count % bits_per_word) {
+        out[out_words - 1] &= ((word_type)1 << (count % bits_per_word)) - 1;
+    }
+}
+
+template <int N>
+auto bitgrid<N>::operator&=(const bitgrid& rhs) -> bitgrid&
+{
+    assert(words_.size() == rhs.words_.size());
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words_[i] &= rhs.words_[i];
+    }
+    return *this;
+}
+
+template <int N>
+auto bitgrid<N>::operator|=(const bitgrid& rhs) -> bitgrid&
+{
+    assert(words_.size() == rhs.words_.size());
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words_[i] |= rhs.words_[i];
+    }
+    return *this;
+}
+
+template <int N>
+auto bitgrid<N>::operator^=(const bitgrid& rhs) -> bitgrid&
+{
+    assert(words_.size() == rhs.words_.size());
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words_[i] ^= rhs.words_[i];
+    }
+    return *this;
+}
+
+template <int N>
+auto bitgrid<N>::flip() -> bitgrid&
+{
+    for (size_type i = 0; i < words_.size(); ++i) {
+        words_[i] = ~words_[i];
+    }
+    mask_padding();
+    return *this;
+}
+
+template <int N>
+auto bitgrid<N>::count() const -> size_type
+{
+    return PopcountWords(words_.data(), words_.size());
+}
+
+template <int N>
+bool bitgrid<N>::any() const
+{
+    for (size_type i = 0; i < words_.size(); ++i) {
+        if (words_[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <int N>
+bool bitgrid<N>::find_first(index& i) const
+{
+    return find_from(0, i);
+}
+
+template <int N>
+bool bitgrid<N>::find_next(index& i) const
+{
+    const size_type* c = i.coords();
+    const size_type next = c[N - 1] + 1;
+    size_type w = row_of(c) * words_per_row_ + next / bits_per_word;
+    if (next % bits_per_word) {
+        // remaining bits of the word containing i; the padding bits are zero,
+        // so this never runs past the end of the row
+        const word_type rest = words_[w] & (~(word_type)0 << (next % bits_per_word));
+        if (rest) {
+            i(N - 1) = next - next % bits_per_word + __builtin_ctzll(rest);
+            return true;
+        }
+        ++w;
+    }
+
+    return find_from(w, i);
+}
+
+template <int N>
+void bitgrid<N>::clear()
+{
+    const size_type dims[N] = { 0 };
+    set_dims(dims);
+    words_.shrink_to_fit();
+}
+
+template <int N>
+template <typename... SizeTypes>
+void bitgrid<N>::resize(SizeTypes... sizes)
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to resize");
+    const size_type dims[N] = { (size_type)sizes... };
+    set_dims(dims);
+}
+
+template <int N>
+void bitgrid<N>::assign(bool value)
+{
+    std::fill(words_.begin(), words_.end(), value ? ~(word_type)0 : 0);
+    if (value) {
+        mask_padding();
+    }
+}
+
+template <int N>
+template <typename T, typename Allocator>
+void bitgrid<N>::assign(const grid<N, T, row_major, Allocator>& g)
+{
+    size_type dims[N];
+    for (int i = 0; i < N; ++i) {
+        dims[i] = g.size(i);
+    }
+    set_dims(dims);
+
+    // pack each row separately so that rows start on word boundaries
+    const T* src = g.data();
+    for (size_type r = 0; r < num_rows_; ++r) {
+        PackBitsKernel(src + r * dims_[N - 1], dims_[N - 1], row_words(r),
+                (typename KernelByteType<T>::type*)0);
+    }
+}
+
+template <int N>
+template <typename T, typename Allocator>
+void bitgrid<N>::unpack(grid<N, T, row_major, Allocator>& g) const
+{
+    ResizeDiscard(g, dims_);
+    T* dst = g.data();
+    const size_type len = dims_[N - 1];
+    for (size_type r = 0; r < num_rows_; ++r) {
+        const word_type* row = row_words(r);
+        for (size_type x = 0; x < len; ++x) {
+            *dst++ = (T)((row[x / bits_per_word] >> (x % bits_per_word)) & 1);
+        }
+    }
+}
+
+template <int N>
+void bitgrid<N>::set_dims(const size_type* dims)
+{
+    std::copy(dims, dims + N, dims_);
+    num_rows_ = 1;
+    for (int i = 0; i < N - 1; ++i) {
+        num_rows_ *= dims_[i];
+    }
+    words_per_row_ = (dims_[N - 1] + bits_per_word - 1) / bits_per_word;
+    tail_mask_ = dims_[N - 1] % bits_per_word ?
+            ((word_type)1 << (dims_[N - 1] % bits_per_word)) - 1 : ~(word_type)0;
+    words_.assign(num_rows_ * words_per_row_, 0);
+}
+
+template <int N>
+auto bitgrid<N>::row_of(const size_type* c) const -> size_type
+{
+    size_type row = 0;
+    for (int i = 0; i < N - 1; ++i) {
+        row = row * dims_[i] + c[i];
+    }
+    return row;
+}
+
+template <int N>
+bool bitgrid<N>::find_from(size_type w, index& i) const
+{
+    for (; w < words_.size(); ++w) {
+        if (words_[w]) {
+            size_type row = w / words_per_row_;
+            i(N - 1) = (w % words_per_row_) * bits_per_word + __builtin_ctzll(words_[w]);
+            for (int d = N - 2; d >= 0; --d) {
+                i(d) = row % dims_[d];
+                row /= dims_[d];
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+template <int N>
+void bitgrid<N>::mask_padding()
+{
+    if (!words_per_row_) {
+        return;
+    }
+    for (size_type r = 0; r < num_rows_; ++r) {
+        words_[(r + 1) * words_per_row_ - 1] &= tail_mask_;
+    }
+}
+
+} // namespace au
+
+#endif
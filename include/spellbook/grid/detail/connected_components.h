@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_connected_components_h
+#define au_detail_connected_components_h
+
+#include "../connected_components.h"
+
+// standard includes
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace au
+{
+
+// The equivalence forest is stored in the label grid: a foreground cell at
+// offset x holds parent(x) + 1, and a background cell holds 0. Every parent
+// precedes its child in storage order, so roots are the first cells of their
+// trees.
+
+inline uint32_t FindLabelRoot(uint32_t* forest, uint32_t x)
+{
+    while (forest[x] - 1 != x) {
+        // path splitting: point x at its grandparent on the way up
+        const uint32_t parent = forest[x] - 1;
+        forest[x] = forest[parent];
+        x = parent;
+    }
+    return x;
+}
+
+inline void UniteLabels(uint32_t* forest, uint32_t a, uint32_t b)
+{
+    a = FindLabelRoot(forest, a);
+    b = FindLabelRoot(forest, b);
+    if (a < b) {
+        forest[b] = a + 1;
+    }
+    else if (b < a) {
+        forest[a] = b + 1;
+    }
+}
+
+/// The neighbors of a cell that precede it in row-major order, as coordinate
+/// deltas and storage offsets.
+template <int N>
+struct PrecedingNeighbors
+{
+    std::vector<int> deltas;        // N per neighbor
+    std::vector<ptrdiff_t> offsets;
+
+    template <typename LabelAllocator>
+    PrecedingNeighbors(
+        const grid<N, uint32_t, row_major, LabelAllocator>& labels,
+        grid_connectivity connectivity)
+    {
+        int num_neighbors = 1;
+        for (int i = 0; i < N; ++i) {
+            num_neighbors *= 3;
+        }
+
+        int d[N];
+        for (int n = 0; n < num_neighbors; ++n) {
+            int rem = n;
+            int nonzero = 0;
+            int first_nonzero = 0;
+            for (int i = N - 1; i >= 0; --i) {
+                d[i] = rem % 3 - 1;
+                rem /= 3;
+            }
+            for (int i = N - 1; i >= 0; --i) {
+                if (d[i]) {
+                    ++nonzero;
+                    first_nonzero = d[i];
+                }
+            }
+            // lexicographically negative deltas precede the cell
+            if (first_nonzero >= 0 || (connectivity == connect_faces && nonzero != 1)) {
+                continue;
+            }
+            ptrdiff_t offset = 0;
+            for (int i = 0; i < N; ++i) {
+                deltas.push_back(d[i]);
+                offset += d[i] * (ptrdiff_t)labels.stride(i);
+            }
+            offsets.push_back(offset);
+        }
+    }
+
+    size_t size() const { return offsets.size(); }
+};
+
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator, typename Predicate>
+void InitLabelForest(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    Predicate is_foreground,
+    thread_pool& pool,
+    std::true_type row_major_src)
+{
+    ParallelForRange(pool, src.total_size(), [&](size_t first, size_t last)
+    {
+        const T* s = src.data();
+        uint32_t* l = labels.data();
+        for (size_t k = first; k < last; ++k) {
+            l[k] = is_foreground(s[k]) ? (uint32_t)k + 1 : 0;
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator, typename Predicate>
+void InitLabelForest(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    Predicate is_foreground,
+    thread_pool& pool,
+    std::false_type row_major_src)
+{
+    uint32_t* l = labels.data();
+    for (auto it = src.begin(); it != src.end(); ++it) {
+        const uint32_t k = (uint32_t)StrideOffset(labels, it.cindex());
+        l[k] = is_foreground(*it) ? k + 1 : 0;
+    }
+}
+
+/// Unite each foreground cell in the box [start, end] with its foreground
+/// neighbors that precede it in row-major order, considering only neighbors
+/// along the first dimension at or after min_x.
+template <int N, typename LabelAllocator>
+void UniteNeighbors(
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    const PrecedingNeighbors<N>& neighbors,
+    const grid_index<N, uint32_t>& start,
+    const grid_index<N, uint32_t>& end,
+    size_t min_x)
+{
+    uint32_t* forest = labels.data();
+    ForEachRun(start, end, N - 1, [&](const grid_index<N, uint32_t>& row, size_t len)
+    {
+        grid_index<N, uint32_t> c = row;
+        size_t offset = StrideOffset(labels, row);
+        for (size_t k = 0; k < len; ++k, ++c(N - 1), ++offset) {
+            if (!forest[offset]) {
+                continue;
+            }
+            for (size_t n = 0; n < neighbors.size(); ++n) {
+                const int* d = &neighbors.deltas[n * N];
+                bool inside = (ptrdiff_t)c(0) + d[0] >= (ptrdiff_t)min_x;
+                for (int i = 0; i < N; ++i) {
+                    inside &= (size_t)((ptrdiff_t)c(i) + d[i]) < labels.size(i);
+                }
+                if (!inside) {
+                    continue;
+                }
+                const size_t neighbor = offset + neighbors.offsets[n];
+                if (forest[neighbor]) {
+                    UniteLabels(forest, (uint32_t)offset, (uint32_t)neighbor);
+                }
+            }
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator, typename Predicate>
+uint32_t label_components(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    Predicate is_foreground,
+    grid_connectivity connectivity,
+    thread_pool& pool)
+{
+    ResizeLike(src, labels);
+    const size_t total = src.total_size();
+    if (total == 0) {
+        return 0;
+    }
+    assert(total < std::numeric_limits<uint32_t>::max());
+
+    InitLabelForest(src, labels, is_foreground, pool,
+            std::integral_constant<bool, std::is_same<Layout, row_major>::value>());
+
+    const PrecedingNeighbors<N> neighbors(labels, connectivity);
+
+    grid_index<N, uint32_t> start;
+    grid_index<N, uint32_t> end;
+    for (int i = 0; i < N; ++i) {
+        start(i) = 0;
+        end(i) = labels.size(i) - 1;
+    }
+
+    // first pass: label each slab independently; unions only link cells
+    // within a slab, so the slabs' trees are disjoint
+    std::vector<uint32_t> slab_first(NumSlabs(start, end, pool));
+    ForEachSlab(start, end, pool, [&](
+        size_t s,
+        const grid_index<N, uint32_t>& slab_start,
+        const grid_index<N, uint32_t>& slab_end)
+    {
+        slab_first[s] = slab_start(0);
+        UniteNeighbors(labels, neighbors, slab_start, slab_end, slab_start(0));
+    });
+
+    // merge the components that cross slab boundaries by revisiting the
+    // first plane of each slab with neighbors in the previous slab allowed
+    for (size_t s = 1; s < slab_first.size(); ++s) {
+        grid_index<N, uint32_t> plane_start = start;
+        grid_index<N, uint32_t> plane_end = end;
+        plane_start(0) = plane_end(0) = slab_first[s];
+        UniteNeighbors(labels, neighbors, plane_start, plane_end, 0);
+    }
+
+    // final pass: a cell's parent precedes it and has already been given its
+    // component's final label
+    uint32_t* forest = labels.data();
+    uint32_t count = 0;
+    for (size_t k = 0; k < total; ++k) {
+        const uint32_t v = forest[k];
+        if (!v) {
+            continue;
+        }
+        forest[k] = v - 1 == k ? ++count : forest[v - 1];
+    }
+    return count;
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename LabelAllocator>
+uint32_t label_components(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    grid_connectivity connectivity)
+{
+    return label_components(src, labels, NonDefaultValue<T>(), connectivity);
+}
+
+template <int N, typename LabelAllocator>
+void component_statistics(
+    const grid<N, uint32_t, row_major, LabelAllocator>& labels,
+    uint32_t num_components,
+    std::vector<component_stats<N>>& stats)
+{
+    stats.resize(num_components);
+    std::vector<double> sums(num_components * N, 0.0);
+    for (component_stats<N>& s : stats) {
+        s.size = 0;
+        std::fill(s.min, s.min + N, std::numeric_limits<size_t>::max());
+        std::fill(s.max, s.max + N, 0);
+    }
+
+    for (auto it = labels.begin(); it != labels.end(); ++it) {
+        if (!*it) {
+            continue;
+        }
+        component_stats<N>& s = stats[*it - 1];
+        double* sum = &sums[(*it - 1) * N];
+        ++s.size;
+        for (int i = 0; i < N; ++i) {
+            const size_t c = it.coord(i);
+            s.min[i] = std::min(s.min[i], c);
+            s.max[i] = std::max(s.max[i], c);
+            sum[i] += (double)c;
+        }
+    }
+
+    for (uint32_t k = 0; k < num_components; ++k) {
+        for (int i = 0; i < N; ++i) {
+            stats[k].centroid[i] = sums[k * N + i] / (double)stats[k].size;
+        }
+    }
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_distance_transform_h
+#define au_detail_distance_transform_h
+
+#include "../distance_transform.h"
+
+// standard includes
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace au
+{
+
+/// Lower envelope of the parabolas rooted at the finite samples of f, as in
+/// Felzenszwalb and Huttenlocher. Evaluates d[q] = min_p (q - p)^2 + f[p] for
+/// every q in [0, n). The scratch arrays v and z must hold n and n + 1
+/// elements.
+inline void SquaredDistanceTransform1D(
+    const float* f, float* d, size_t n, size_t* v, double* z)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+
+    size_t q = 0;
+    while (q < n && f[q] == inf) {
+        ++q;
+    }
+    if (q == n) {
+        std::fill(d, d + n, inf);
+        return;
+    }
+
+    size_t k = 0;
+    v[0] = q;
+    z[0] = -std::numeric_limits<double>::infinity();
+    z[1] = std::numeric_limits<double>::infinity();
+
+    // abscissa of the intersection of the parabolas rooted at a and b
+    auto intersect = [&](size_t a, size_t b)
+    {
+        const double da = (double)a;
+        const double db = (double)b;
+        return (((double)f[b] + db * db) - ((double)f[a] + da * da)) /
+                (2.0 * (db - da));
+    };
+
+    for (++q; q < n; ++q) {
+        if (f[q] == inf) {
+            continue;
+        }
+        double s = intersect(v[k], q);
+        while (s <= z[k]) {
+            --k;
+            s = intersect(v[k], q);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = std::numeric_limits<double>::infinity();
+    }
+
+    k = 0;
+    for (q = 0; q < n; ++q) {
+        while (z[k + 1] < (double)q) {
+            ++k;
+        }
+        const double dq = (double)q - (double)v[k];
+        d[q] = (float)(dq * dq + (double)f[v[k]]);
+    }
+}
+
+/// Transform every line of the row-major grid g along dimension dim in place.
+template <int N, typename Allocator>
+void DistanceTransformPass(
+    grid<N, float, row_major, Allocator>& g, int dim, thread_pool& pool)
+{
+    const size_t n = g.size(dim);
+    const size_t stride = g.stride(dim);
+    const size_t num_lines = g.total_size() / n;
+
+    // enumerate lines by the coordinates of the remaining dimensions, with the
+    // innermost varying fastest, so that consecutive lines are adjacent in
+    // memory
+    size_t line_dims[N];
+    size_t line_strides[N];
+    int m = 0;
+    for (int i = 0; i < N; ++i) {
+        if (i != dim) {
+            line_dims[m] = g.size(i);
+            line_strides[m] = g.stride(i);
+            ++m;
+        }
+    }
+
+    ParallelForRange(pool, num_lines, [&](size_t first, size_t last)
+    {
+        std::vector<float> f(n);
+        std::vector<float> d(n);
+        std::vector<size_t> v(n);
+        std::vector<double> z(n + 1);
+
+        // coordinates of the first line of the chunk
+        size_t c[N];
+        size_t rem = first;
+        for (int i = m - 1; i >= 0; --i) {
+            c[i] = rem % line_dims[i];
+            rem /= line_dims[i];
+        }
+
+        for (size_t l = first; l < last; ++l) {
+            size_t base = 0;
+            for (int i = 0; i < m; ++i) {
+                base += c[i] * line_strides[i];
+            }
+
+            float* p = g.data() + base;
+            for (size_t q = 0; q < n; ++q) {
+                f[q] = p[q * stride];
+            }
+            SquaredDistanceTransform1D(f.data(), d.data(), n, v.data(), z.data());
+            for (size_t q = 0; q < n; ++q) {
+                p[q * stride] = d[q];
+            }
+
+            for (int i = m - 1; i >= 0; --i) {
+                if (++c[i] < line_dims[i]) {
+                    break;
+                }
+                c[i] = 0;
+            }
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void InitDistanceTransform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool,
+    std::true_type row_major_src)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    ParallelForRange(pool, src.total_size(), [&](size_t first, size_t last)
+    {
+        const T* s = src.data();
+        float* d = dst.data();
+        for (size_t k = first; k < last; ++k) {
+            d[k] = is_obstacle(s[k]) ? 0.0f : inf;
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void InitDistanceTransform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool,
+    std::false_type row_major_src)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    grid_index<N, float> first;
+    grid_index<N, float> last;
+    for (int i = 0; i < N; ++i) {
+        last(i) = dst.size(i) - 1;
+    }
+    parallel_for_each(dst, first, last, [&](const grid_index<N, float>& i, float& d)
+    {
+        typename grid<N, T, Layout, Allocator>::index j;
+        for (int k = 0; k < N; ++k) {
+            j(k) = i(k);
+        }
+        d = is_obstacle(src(j)) ? 0.0f : inf;
+    },
+    pool);
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void squared_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool)
+{
+    ResizeLike(src, dst);
+    if (src.total_size() == 0) {
+        return;
+    }
+
+    InitDistanceTransform(src, dst, is_obstacle, pool,
+            std::integral_constant<bool, std::is_same<Layout, row_major>::value>());
+
+    // the innermost dimension first, while the lines are contiguous and the
+    // grid is mostly infinite
+    for (int dim = N - 1; dim >= 0; --dim) {
+        DistanceTransformPass(dst, dim, pool);
+    }
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void squared_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst)
+{
+    squared_distance_transform(src, dst, NonDefaultValue<T>());
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool)
+{
+    squared_distance_transform(src, dst, is_obstacle, pool);
+    ParallelForRange(pool, dst.total_size(), [&](size_t first, size_t last)
+    {
+        float* d = dst.data();
+        for (size_t k = first; k < last; ++k) {
+            d[k] = std::sqrt(d[k]);
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst)
+{
+    distance_transform(src, dst, NonDefaultValue<T>());
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void signed_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool)
+{
+    grid<N, float, row_major, DstAllocator> inside;
+    squared_distance_transform(src, dst, is_obstacle, pool);
+    squared_distance_transform(src, inside,
+            [&](const T& value) { return !is_obstacle(value); }, pool);
+
+    // exactly one of the two distances is zero at each cell
+    ParallelForRange(pool, dst.total_size(), [&](size_t first, size_t last)
+    {
+        float* d = dst.data();
+        const float* in = inside.data();
+        for (size_t k = first; k < last; ++k) {
+            d[k] = std::sqrt(d[k]) - std::sqrt(in[k]);
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void signed_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst)
+{
+    signed_distance_transform(src, dst, NonDefaultValue<T>());
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,355 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_dynamic_distance_field_h
+#define au_detail_dynamic_distance_field_h
+
+#include "../dynamic_distance_field.h"
+
+// standard includes
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace au
+{
+
+template <int N>
+const uint32_t dynamic_distance_field<N>::no_obstacle;
+
+template <int N>
+dynamic_distance_field<N>::dynamic_distance_field()
+{
+}
+
+template <int N>
+template <typename... SizeTypes>
+dynamic_distance_field<N>::dynamic_distance_field(SizeTypes... sizes) :
+    cells_()
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to dynamic_distance_field");
+    const size_type dims[N] = { (size_type)sizes... };
+    resize(dims);
+}
+
+template <int N>
+float dynamic_distance_field<N>::distance(const index& i) const
+{
+    const uint32_t d = squared_distance(i);
+    return d == max_squared_distance() ?
+            std::numeric_limits<float>::infinity() : std::sqrt((float)d);
+}
+
+template <int N>
+uint32_t dynamic_distance_field<N>::squared_distance(const index& i) const
+{
+    return cells_.data()[offset(i)].sqdist;
+}
+
+template <int N>
+bool dynamic_distance_field<N>::is_obstacle(const index& i) const
+{
+    return is_obstacle(offset(i));
+}
+
+template <int N>
+bool dynamic_distance_field<N>::nearest_obstacle(const index& i, index& obstacle) const
+{
+    const uint32_t o = cells_.data()[offset(i)].obstacle;
+    if (o == no_obstacle) {
+        return false;
+    }
+    int c[N];
+    coords(o, c);
+    for (int d = 0; d < N; ++d) {
+        obstacle(d) = c[d];
+    }
+    return true;
+}
+
+template <int N>
+template <typename T, typename Layout, typename Allocator, typename Predicate>
+void dynamic_distance_field<N>::assign(
+    const grid<N, T, Layout, Allocator>& occupancy,
+    Predicate is_obstacle)
+{
+    size_type dims[N];
+    bool same_size = true;
+    for (int d = 0; d < N; ++d) {
+        dims[d] = occupancy.size(d);
+        same_size &= dims[d] == cells_.size(d);
+    }
+    if (same_size) {
+        cells_.assign(cell());
+        open_ = open_list();
+    }
+    else {
+        resize(dims);
+    }
+
+    for (auto it = occupancy.begin(); it != occupancy.end(); ++it) {
+        if (is_obstacle(*it)) {
+            const typename grid<N, T, Layout, Allocator>::index& i = it.cindex();
+            index j;
+            for (int d = 0; d < N; ++d) {
+                j(d) = i(d);
+            }
+            set_obstacle(j);
+        }
+    }
+    update();
+}
+
+template <int N>
+void dynamic_distance_field<N>::set_obstacle(const index& i)
+{
+    const uint32_t o = offset(i);
+    cell& c = cells_.data()[o];
+    if (c.obstacle == o) {
+        return;
+    }
+    c.obstacle = o;
+    c.sqdist = 0;
+    c.raise = false;
+    c.state = lower_queued;
+    open_.push(queue_entry(0, o));
+}
+
+template <int N>
+void dynamic_distance_field<N>::clear_obstacle(const index& i)
+{
+    const uint32_t o = offset(i);
+    cell& c = cells_.data()[o];
+    if (c.obstacle != o) {
+        return;
+    }
+    c.obstacle = no_obstacle;
+    c.sqdist = UINT32_MAX;
+    c.raise = true;
+    c.state = raise_queued;
+    open_.push(queue_entry(0, o));
+}
+
+template <int N>
+auto dynamic_distance_field<N>::update() -> size_type
+{
+    size_type processed = 0;
+    int c[N];
+    while (!open_.empty()) {
+        const uint32_t s = open_.top().second;
+        open_.pop();
+
+        cell& cs = cells_.data()[s];
+        if (cs.state == lower_processed) {
+            continue; // stale entry
+        }
+
+        ++processed;
+        coords(s, c);
+        if (cs.raise) {
+            raise(s, c);
+        }
+        else if (cs.obstacle != no_obstacle && is_obstacle(cs.obstacle)) {
+            lower(s, c);
+        }
+    }
+    return processed;
+}
+
+template <int N>
+void dynamic_distance_field<N>::resize(const size_type* dims)
+{
+    // cell offsets are 32-bit and no_obstacle is reserved, and the squared
+    // distance between any two cells must fit below max_squared_distance();
+    // check before allocating, since a grid this large may not be
+    // allocatable at all
+    size_type total = 1;
+    uint64_t max_sqdist = 0;
+    for (int d = 0; d < N; ++d) {
+        if (dims[d] != 0 && total > (size_type)no_obstacle / dims[d]) {
+            throw std::length_error("dynamic_distance_field supports fewer than 2^32 - 1 cells");
+        }
+        total *= dims[d];
+        if (dims[d] != 0) {
+            max_sqdist += (uint64_t)(dims[d] - 1) * (dims[d] - 1);
+            if (max_sqdist >= max_squared_distance()) {
+                throw std::length_error("dynamic_distance_field squared distances must fit in 32 bits");
+            }
+        }
+    }
+    if (total >= no_obstacle) {
+        throw std::length_error("dynamic_distance_field supports fewer than 2^32 - 1 cells");
+    }
+
+    ResizeDiscard(cells_, dims);
+    open_ = open_list();
+    init();
+}
+
+template <int N>
+void dynamic_distance_field<N>::init()
+{
+    neighbor_offsets_.clear();
+    neighbor_steps_.clear();
+
+    // enumerate the 3^N - 1 neighbors by counting in base 3
+    int step[N];
+    for (int d = 0; d < N; ++d) {
+        step[d] = -1;
+    }
+    while (true) {
+        ptrdiff_t off = 0;
+        bool center = true;
+        for (int d = 0; d < N; ++d) {
+            off += step[d] * (ptrdiff_t)cells_.stride(d);
+            center &= step[d] == 0;
+        }
+        if (!center) {
+            neighbor_offsets_.push_back(off);
+            neighbor_steps_.insert(neighbor_steps_.end(), step, step + N);
+        }
+
+        int d = N - 1;
+        while (d >= 0 && step[d] == 1) {
+            step[d] = -1;
+            --d;
+        }
+        if (d < 0) {
+            break;
+        }
+        ++step[d];
+    }
+}
+
+template <int N>
+uint32_t dynamic_distance_field<N>::offset(const index& i) const
+{
+    size_type o = 0;
+    for (int d = 0; d < N; ++d) {
+        o += cells_.stride(d) * i(d);
+    }
+    return (uint32_t)o;
+}
+
+template <int N>
+void dynamic_distance_field<N>::coords(uint32_t offset, int* c) const
+{
+    for (int d = 0; d < N; ++d) {
+        c[d] = (int)(offset / cells_.stride(d));
+        offset %= cells_.stride(d);
+    }
+}
+
+// Invalidate the neighbors of s whose nearest obstacle was removed, and
+// queue the neighbors with valid obstacles to refill the invalidated region.
+template <int N>
+void dynamic_distance_field<N>::raise(uint32_t s, const int* c)
+{
+    cell* cells = cells_.data();
+    const size_t num_neighbors = neighbor_offsets_.size();
+    for (size_t k = 0; k < num_neighbors; ++k) {
+        const int* step = &neighbor_steps_[k * N];
+        bool inside = true;
+        for (int d = 0; d < N; ++d) {
+            const int nc = c[d] + step[d];
+            inside &= nc >= 0 && nc < (int)cells_.size(d);
+        }
+        if (!inside) {
+            continue;
+        }
+
+        const uint32_t n = (uint32_t)(s + neighbor_offsets_[k]);
+        cell& cn = cells[n];
+        if (cn.obstacle == no_obstacle || cn.raise) {
+            continue;
+        }
+
+        if (!is_obstacle(cn.obstacle)) {
+            open_.push(queue_entry(cn.sqdist, n));
+            cn.state = raise_queued;
+            cn.raise = true;
+            cn.obstacle = no_obstacle;
+            cn.sqdist = UINT32_MAX;
+        }
+        else if (cn.state != lower_queued) {
+            open_.push(queue_entry(cn.sqdist, n));
+            cn.state = lower_queued;
+        }
+    }
+
+    cells[s].raise = false;
+    cells[s].state = raise_processed;
+}
+
+// Offer the nearest obstacle of s to each of its neighbors.
+template <int N>
+void dynamic_distance_field<N>::lower(uint32_t s, const int* c)
+{
+    cell* cells = cells_.data();
+    const uint32_t obstacle = cells[s].obstacle;
+    cells[s].state = lower_processed;
+
+    int oc[N];
+    coords(obstacle, oc);
+
+    const size_t num_neighbors = neighbor_offsets_.size();
+    for (size_t k = 0; k < num_neighbors; ++k) {
+        const int* step = &neighbor_steps_[k * N];
+        bool inside = true;
+        uint32_t sqdist = 0;
+        for (int d = 0; d < N; ++d) {
+            const int nc = c[d] + step[d];
+            inside &= nc >= 0 && nc < (int)cells_.size(d);
+            const int64_t delta = nc - oc[d];
+            sqdist += (uint32_t)(delta * delta);
+        }
+        if (!inside) {
+            continue;
+        }
+
+        const uint32_t n = (uint32_t)(s + neighbor_offsets_[k]);
+        cell& cn = cells[n];
+        if (cn.raise) {
+            continue;
+        }
+
+        bool overwrite = sqdist < cn.sqdist;
+        if (!overwrite && sqdist == cn.sqdist) {
+            // prefer a valid obstacle at the same distance
+            overwrite = cn.obstacle == no_obstacle || !is_obstacle(cn.obstacle);
+        }
+        if (overwrite) {
+            open_.push(queue_entry(sqdist, n));
+            cn.state = lower_queued;
+            cn.sqdist = sqdist;
+            cn.obstacle = obstacle;
+        }
+    }
+}
+
+} // namespace au
+
+#endif
@@ -31,9 +31,14 @@
 
 // standard includes
 #include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <new>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 
 template <class T> typename std::add_rvalue_reference<T>::type val();
 template <class T> struct id { typedef T type; };
@@ -67,35 +72,139 @@ typename mul_type<A0, A1, Sizes...>::type mul(A0 a0, A1 a1, Sizes... dims)
 namespace au
 {
 
+// internal to this file; undefined at its end
+#if defined(AU_GRID_DEBUG)
+#define AU_GRID_DETAIL_ASSERT(cond) assert(cond)
+#else
+#define AU_GRID_DETAIL_ASSERT(cond) ((void)0)
+#endif
+
+#if defined(__GNUC__)
+#define AU_GRID_DETAIL_COLD __attribute__((noinline, cold))
+#else
+#define AU_GRID_DETAIL_COLD
+#endif
+
+/// Test 0 <= c < n without converting negative coordinates to size_t, which
+/// wraps integers and is undefined for floating-point values. For signed
+/// integers the two comparisons fold into one unsigned comparison.
+template <typename Coord>
+bool CoordInBounds(Coord c, size_t n, std::false_type is_signed, std::false_type is_float) noexcept
+{
+    return (size_t)c < n;
+}
+
+template <typename Coord>
+bool CoordInBounds(Coord c, size_t n, std::true_type is_signed, std::false_type is_float) noexcept
+{
+    return c >= 0 && (size_t)c < n;
+}
+
+template <typename Coord>
+bool CoordInBounds(Coord c, size_t n, std::true_type is_signed, std::true_type is_float) noexcept
+{
+    return c >= 0 && c < (Coord)n;
+}
+
+template <typename Coord>
+bool CoordInBounds(Coord c, size_t n) noexcept
+{
+    return CoordInBounds(c, n, std::is_signed<Coord>(), std::is_floating_point<Coord>());
+}
+
+/// Test each coordinate against the corresponding entry of dims, as
+/// CoordInBounds, for containers that store their sizes in an array.
+template <typename Coord>
+bool CoordsInBounds(const size_t* dims, Coord c) noexcept
+{
+    return CoordInBounds(c, *dims);
+}
+
+template <typename Coord, typename... CoordTypes>
+bool CoordsInBounds(const size_t* dims, Coord c, CoordTypes... coords) noexcept
+{
+    return CoordInBounds(c, *dims) & CoordsInBounds(dims + 1, coords...);
+}
+
+// unary + prints character-typed coordinates as numbers
+template <typename Coord>
+void PrintCoords(std::ostream& os, Coord c)
+{
+    os << +c;
+}
+
+template <typename Coord, typename... CoordTypes>
+void PrintCoords(std::ostream& os, Coord c, CoordTypes... coords)
+{
+    os << +c << ", ";
+    PrintCoords(os, coords...);
+}
+
+/// The throwing paths of the checked accessors are kept out of line so that
+/// the accessors inline to a comparison and a branch. The message reports the
+/// coordinates as given, since out-of-range coordinates may have no linear
+/// index.
+AU_GRID_DETAIL_COLD inline void ThrowOutOfRange(
+    const std::string& coords,
+    const size_t* dims,
+    int n)
+{
+    std::stringstream ss;
+    ss << "coordinates (" << coords << ") out of range of grid of size (";
+    for (int d = 0; d < n; ++d) {
+        ss << (d ? ", " : "") << dims[d];
+    }
+    ss << ")";
+    throw std::out_of_range(ss.str());
+}
+
+template <int N, typename... CoordTypes>
+AU_GRID_DETAIL_COLD void ThrowCoordsOutOfRange(const size_t* dims, CoordTypes... coords)
+{
+    std::stringstream ss;
+    PrintCoords(ss, coords...);
+    ThrowOutOfRange(ss.str(), dims, N);
+}
+
+template <int N, typename Index>
+AU_GRID_DETAIL_COLD void ThrowIndexOutOfRange(const size_t* dims, const Index& i)
+{
+    std::stringstream ss;
+    for (int d = 0; d < N; ++d) {
+        ss << (d ? ", " : "") << +i(d);
+    }
+    ThrowOutOfRange(ss.str(), dims, N);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // grid Implementation
 ////////////////////////////////////////////////////////////////////////////////
 
-template <int N, typename T>
-grid<N, T>::grid() :
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>::grid() :
     data_(nullptr)
 {
     this->clear();
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... sizes>
-grid<N, T>::grid(sizes... counts) :
+grid<N, T, Layout, Allocator>::grid(sizes... counts) :
     data_(nullptr)
 {
     static_assert(sizeof...(counts) == N, "Invalid dimensions passed to grid constructor");
     this->resize(counts...);
 }
 
-template <int N, typename T>
-grid<N, T>::grid(const grid& other) :
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>::grid(const grid& other) :
     data_(nullptr)
 {
     this->copy(other);
 }
 
-template <int N, typename T>
-grid<N, T>& grid<N, T>::operator=(const grid& rhs)
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>& grid<N, T, Layout, Allocator>::operator=(const grid& rhs)
 {
     if (this != &rhs) {
         this->copy(rhs);
@@ -103,10 +212,11 @@ grid<N, T>& grid<N, T>::operator=(const grid& rhs)
     return *this;
 }
 
-template <int N, typename T>
-grid<N, T>::grid(grid&& other) :
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>::grid(grid&& other) :
     data_(other.data_),
-    dims_()
+    dims_(),
+    layout_(other.layout_)
 {
     // copy over dimensions
     memcpy(dims_, other.dims_, N * sizeof(size_type));
@@ -116,14 +226,15 @@ grid<N, T>::grid(grid&& other) :
     other.clear();
 }
 
-template <int N, typename T>
-grid<N, T>& grid<N, T>::operator=(grid&& rhs)
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>& grid<N, T, Layout, Allocator>::operator=(grid&& rhs)
 {
     if (this != &rhs) {
         clear();
 
         data_ = rhs.data_;
         memcpy(dims_, rhs.dims_, N * sizeof(size_type));
+        layout_ = rhs.layout_;
 
         // clear other
         rhs.data_ = nullptr;
@@ -132,108 +243,143 @@ grid<N, T>& grid<N, T>::operator=(grid&& rhs)
     return *this;
 }
 
-template <int N, typename T>
-grid<N, T>::~grid()
+template <int N, typename T, typename Layout, typename Allocator>
+grid<N, T, Layout, Allocator>::~grid()
 {
     this->clear();
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-typename grid<N, T>::reference grid<N, T>::operator()(CoordTypes... coords)
+auto grid<N, T, Layout, Allocator>::operator()(CoordTypes... coords) -> reference
 {
     static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    AU_GRID_DETAIL_ASSERT(this->within_bounds(coords...));
     size_type ind = this->coord_to_index(coords...);
     return data_[ind];
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-typename grid<N, T>::const_reference grid<N, T>::operator()(CoordTypes... coords) const
+auto grid<N, T, Layout, Allocator>::operator()(CoordTypes... coords) const -> const_reference
 {
-    return const_cast<const T&>(const_cast<grid<N, T>*>(this)->operator()(coords...));
+    return const_cast<const T&>(const_cast<grid*>(this)->operator()(coords...));
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-typename grid<N, T>::reference grid<N, T>::at(CoordTypes... coords)
+auto grid<N, T, Layout, Allocator>::at(CoordTypes... coords) -> reference
 {
-    size_type ind = this->coord_to_index(coords...);
-    if (!(ind < this->total_size())) {
-        std::stringstream ss;
-        ss << "invalid index " << ind << " into array of size " << this->total_size();
-        throw std::out_of_range(ss.str());
+    T* p = this->find(coords...);
+    if (!p) {
+        ThrowCoordsOutOfRange<N>(dims_, coords...);
     }
-    return data_[ind];
+    return *p;
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-typename grid<N, T>::const_reference grid<N, T>::at(CoordTypes... coords) const
+auto grid<N, T, Layout, Allocator>::at(CoordTypes... coords) const -> const_reference
 {
-    return const_cast<const T&>(const_cast<grid<N, T>*>(this)->at(coords...));
+    return const_cast<const T&>(const_cast<grid*>(this)->at(coords...));
 }
 
-template <int N, typename T>
-auto grid<N, T>::operator()(const index& i) -> reference
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::operator()(const index& i) -> reference
 {
+    AU_GRID_DETAIL_ASSERT(this->within_bounds(i));
     size_type ind = this->coord_to_index(i);
     return data_[ind];
 }
 
-template <int N, typename T>
-auto grid<N, T>::operator()(const index& i) const -> const_reference
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::operator()(const index& i) const -> const_reference
 {
-    return const_cast<const T&>(const_cast<grid<N, T>*>(this)->operator()(i));
+    return const_cast<const T&>(const_cast<grid*>(this)->operator()(i));
 }
 
-template <int N, typename T>
-auto grid<N, T>::at(const index& i) -> reference
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::at(const index& i) -> reference
 {
-    size_type ind = this->coord_to_index(i);
-    if (!(ind < this->total_size())) {
-        std::stringstream ss;
-        ss << "invalid index " << ind << " into array of size " << this->total_size();
-        throw std::out_of_range(ss.str());
+    T* p = this->find(i);
+    if (!p) {
+        ThrowIndexOutOfRange<N>(dims_, i);
     }
-    return data_[ind];
+    return *p;
 }
 
-template <int N, typename T>
-auto grid<N, T>::at(const index& i) const -> const_reference
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::at(const index& i) const -> const_reference
 {
-    return const_cast<const T&>(const_cast<grid<N, T>*>(this)->at(i));
+    return const_cast<const T&>(const_cast<grid*>(this)->at(i));
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
+template <typename... CoordTypes>
+T* grid<N, T, Layout, Allocator>::find(CoordTypes... coords) noexcept
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to find");
+    return this->within_bounds(coords...) ? data_ + this->coord_to_index(coords...) : nullptr;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+template <typename... CoordTypes>
+const T* grid<N, T, Layout, Allocator>::find(CoordTypes... coords) const noexcept
+{
+    return const_cast<grid*>(this)->find(coords...);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+T* grid<N, T, Layout, Allocator>::find(const index& i) noexcept
+{
+    return this->within_bounds(i) ? data_ + this->coord_to_index(i) : nullptr;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+const T* grid<N, T, Layout, Allocator>::find(const index& i) const noexcept
+{
+    return const_cast<grid*>(this)->find(i);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-bool grid<N, T>::within_bounds(CoordTypes... coords) const
+bool grid<N, T, Layout, Allocator>::within_bounds(CoordTypes... coords) const noexcept
 {
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
     return within_bounds<0>(coords...);
 }
 
-template <int N, typename T>
-typename grid<N, T>::iterator grid<N, T>::begin()
+template <int N, typename T, typename Layout, typename Allocator>
+bool grid<N, T, Layout, Allocator>::within_bounds(const index& i) const noexcept
+{
+    bool inside = true;
+    for (int d = 0; d < N; ++d) {
+        inside &= i(d) < dims_[d];
+    }
+    return inside;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::begin() -> iterator
 {
     iterator it;
     it.grid_ = this;
+    it.contiguous_ = Layout::contiguous_rows;
     if (total_size() == 0) {
-        // it.begin_ = [ 0, 0, .., 0 ]
-        it.end_ = this->create_last_index();
-        it.curr_ = this->create_last_index();
-        it.inc_ = std::numeric_limits<size_type>::max();
+        return this->end();
     }
     else {
         // it.begin_ = [ 0, 0, .., 0 ]
         it.end_ = this->create_last_index();
         // it.curr_ = [ 0, 0,, .., 0 ]
         // it.inc_ = N - 1
+        it.ptr_ = data_;
     }
     return it;
 }
 
-template <int N, typename T>
-typename grid<N, T>::iterator grid<N, T>::end()
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::end() -> iterator
 {
     iterator it;
     it.grid_ = this;
@@ -241,115 +387,141 @@ typename grid<N, T>::iterator grid<N, T>::end()
     it.end_ = this->create_last_index();
     it.curr_ = this->create_last_index();
     it.inc_ = std::numeric_limits<size_type>::max();
+    it.contiguous_ = Layout::contiguous_rows;
+    it.ptr_ = it.contiguous_ ? data_ + total_size() : nullptr;
     return it;
 }
 
-template <int N, typename T>
-const typename grid<N, T>::iterator
-grid<N, T>::begin() const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::begin() const -> const_iterator
 {
-    return const_cast<grid<N, T>*>(this)->begin();
+    return const_cast<grid*>(this)->begin();
 }
 
-template <int N, typename T>
-const typename grid<N, T>::iterator
-grid<N, T>::end() const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::end() const -> const_iterator
 {
-    return const_cast<grid<N, T>*>(this)->end();
+    return const_cast<grid*>(this)->end();
 }
 
-template <int N, typename T>
-typename grid<N, T>::iterator
-grid<N, T>::gbegin(const index& begin, const index& end)
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::gbegin(const index& begin, const index& end) -> iterator
 {
-    iterator it;
-    it.grid_ = this;
     if (total_size() == 0) {
-        // it.begin_ = [ 0, 0, .., 0 ]
-        it.end_ = this->create_last_index();
-        it.curr_ = this->create_last_index();
-        it.inc_ = std::numeric_limits<size_type>::max();
-    }
-    else {
-        it.begin_ = begin;
-        it.end_ = end;
-        it.curr_ = begin;
-        // it.inc_ = N - 1
+        return this->end();
     }
+
+    iterator it;
+    it.grid_ = this;
+    it.begin_ = begin;
+    it.end_ = end;
+    it.curr_ = begin;
+    // it.inc_ = N - 1
+    it.ptr_ = data_ + coord_to_index(begin);
+    it.contiguous_ = is_contiguous(begin, end);
     return it;
 }
 
-template <int N, typename T>
-const typename grid<N, T>::iterator
-grid<N, T>::gbegin(const index& begin, const index& end) const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::gbegin(const index& begin, const index& end) const
+    -> const_iterator
 {
-    return const_cast<typename grid<N, T>::const_iterator>(const_cast<grid<N, T>*>(this)->gbegin(begin, end));
+    return const_cast<grid*>(this)->gbegin(begin, end);
 }
 
-template <int N, typename T>
-typename grid<N, T>::iterator
-grid<N, T>::gend(const index& begin, const index& end)
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::gend(const index& begin, const index& end) -> iterator
 {
+    if (total_size() == 0) {
+        return this->end();
+    }
+
     iterator it;
     it.grid_ = this;
     it.begin_ = begin;
     it.end_ = end;
     it.curr_ = end;
     it.inc_ = std::numeric_limits<size_type>::max();
+    it.contiguous_ = is_contiguous(begin, end);
+    it.ptr_ = it.contiguous_ ? data_ + coord_to_index(end) + 1 : nullptr;
     return it;
 }
 
-template <int N, typename T>
-const typename grid<N, T>::iterator
-grid<N, T>::gend(const index& begin, const index& end) const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::gend(const index& begin, const index& end) const
+    -> const_iterator
 {
-    return const_cast<typename grid<N, T>::const_iterator>(const_cast<grid<N, T>*>(this)->gend(begin, end));
+    return const_cast<grid*>(this)->gend(begin, end);
 }
 
-template <int N, typename T>
-typename grid<N, T>::size_type grid<N, T>::size(size_type dim) const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::size(size_type dim) const -> size_type
 {
     return dims_[dim];
 }
 
-template <int N, typename T>
-typename grid<N, T>::size_type grid<N, T>::total_size() const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::total_size() const -> size_type
 {
     size_type s = 1;
     for (int i = 0; i < N; ++i) { s *= dims_[i]; }
     return s;
 }
 
-template <int N, typename T>
-void grid<N, T>::clear()
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::clear()
 {
-    if (data_) {
-        delete[] data_;
-        data_ = nullptr;
-    }
+    deallocate();
 
     for (int i = 0; i < N; ++i) {
         dims_[i] = 0;
     }
+    layout_.resize(dims_);
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... SizeTypes>
-void grid<N, T>::resize(SizeTypes... sizes)
+void grid<N, T, Layout, Allocator>::resize(SizeTypes... sizes)
 {
     static_assert(sizeof...(sizes) == N, "resize requires same number of arguments as dimensions");
 
     if (data_) {
-        grid<N, T> new_grid(sizes...);
+        grid new_grid(sizes...);
         copy_grid(new_grid);
         *this = std::move(new_grid);
     }
     else {
         clear();
-        size_type total_size = mul(sizes...);
-        data_ = new T[total_size];
         set_sizes<0>(dims_, sizes...);
+        layout_.resize(dims_);
+        allocate(layout_.storage_size());
+        for (size_type i = 0; i < layout_.storage_size(); ++i) {
+            new (data_ + i) T();
+        }
+    }
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+template <typename... SizeTypes>
+void grid<N, T, Layout, Allocator>::resize_uninitialized(SizeTypes... sizes)
+{
+    static_assert(sizeof...(sizes) == N, "resize_uninitialized requires same number of arguments as dimensions");
+    static_assert(std::is_trivially_default_constructible<T>::value &&
+            std::is_trivially_destructible<T>::value,
+            "resize_uninitialized requires a trivial element type");
+
+    size_type dims[N];
+    set_sizes<0>(dims, sizes...);
+    mapping_type layout;
+    layout.resize(dims);
+
+    if (!data_ || layout.storage_size() != layout_.storage_size()) {
+        clear();
+        allocate(layout.storage_size());
     }
+
+    memcpy(dims_, dims, N * sizeof(size_type));
+    layout_ = layout;
 }
 
 //template <int N, typename T>
@@ -364,157 +536,220 @@ void grid<N, T>::resize(SizeTypes... sizes)
 //
 //}
 
-template <int N, typename T>
-void grid<N, T>::assign(const T& value)
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::assign(const T& value)
 {
-    for (size_type i = 0; i < this->total_size(); ++i) {
-        data_[i] = value;
-    }
+    std::fill(data_, data_ + this->storage_size(), value);
 }
 
-template <int N, typename T>
-void grid<N, T>::copy(const grid& other)
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::copy(const grid& other)
 {
     this->clear();
 
     if (other.data_) {
-        size_type other_size = other.total_size();
-        data_ = new T[other_size];
-        for (size_type i = 0; i < other_size; ++i) {
-            data_[i] = other.data_[i];
-        }
+        size_type other_size = other.storage_size();
+        allocate(other_size);
+        std::uninitialized_copy(other.data_, other.data_ + other_size, data_);
         for (int i = 0; i < N; ++i) {
             dims_[i] = other.dims_[i];
         }
+        layout_ = other.layout_;
     }
 }
 
-template <int N, typename T>
-struct IndexCoordinatorBase
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::allocate(size_type count)
 {
-    typedef grid<N, T> grid_type;
-    typedef typename grid_type::size_type size_type;
-    typedef typename grid_type::index index_type;
-
-    IndexCoordinatorBase(size_type& agg) : agg_(agg) { }
-    size_type& agg_;
-};
-
-template <int N, typename T, int DIM>
-struct IndexCoordinator;
+    data_ = static_cast<T*>(Allocator::allocate(count * sizeof(T)));
+    if (!data_) {
+        throw std::bad_alloc();
+    }
+}
 
-template <int N, typename T, int DIM>
-struct IndexCoordinator : public IndexCoordinatorBase<N, T>
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::deallocate()
 {
-    typedef IndexCoordinatorBase<N, T> base;
-    typedef typename base::grid_type grid_type;
-    typedef typename base::size_type size_type;
-    typedef typename base::index_type index_type;
-
-    IndexCoordinator(size_type& agg) : base(agg) { }
-
-    size_type operator()(const grid_type& grid, const index_type& i)
-    {
-        size_type s = IndexCoordinator<N, T, DIM+1>(base::agg_)(grid, i);
-        if (DIM + 1 != N) {
-            base::agg_ *= grid.size(DIM + 1);
-        }
-        return base::agg_ * i(DIM) + s;
+    if (data_) {
+        destroy_elements(std::integral_constant<bool, std::is_trivially_destructible<T>::value>());
+        Allocator::deallocate(data_, layout_.storage_size() * sizeof(T));
+        data_ = nullptr;
     }
-};
+}
 
-template <int N, typename T>
-struct IndexCoordinator<N, T, N> : public IndexCoordinatorBase<N, T>
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::destroy_elements(std::true_type)
 {
-    typedef IndexCoordinatorBase<N, T> base;
-    typedef typename base::grid_type grid_type;
-    typedef typename base::size_type size_type;
-    typedef typename base::index_type index_type;
-
-    IndexCoordinator(size_type& agg) : base(agg) { }
+}
 
-    size_type operator()(const grid_type& grid, const index_type& i)
-    {
-        return 0;
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::destroy_elements(std::false_type)
+{
+    for (size_type i = 0; i < layout_.storage_size(); ++i) {
+        data_[i].~T();
     }
-};
+}
 
-template <int N, typename T>
-typename grid<N, T>::size_type grid<N, T>::coord_to_index(const index& i)
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::coord_to_index(const index& i) const -> size_type
 {
-    std::size_t agg = 1;
-    return IndexCoordinator<N, T, 0>(agg)(*this, i);
+    return layout_.offset(i.coords());
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <typename... CoordTypes>
-typename grid<N, T>::size_type grid<N, T>::coord_to_index(CoordTypes... coords)
+auto grid<N, T, Layout, Allocator>::coord_to_index(CoordTypes... coords) const -> size_type
 {
-    size_type s = 1;
-    return this->coord_to_index_rec<0>(s, coords...);
+    const size_type c[N] = { (size_type)coords... };
+    return layout_.offset(c);
 }
 
-template <int N, typename T>
-template <int DIM, typename... CoordTypes, typename Coord>
-typename grid<N, T>::size_type grid<N, T>::coord_to_index_rec(size_type& agg, Coord coord, CoordTypes... coords)
+template <int N, typename T, typename Layout, typename Allocator>
+template <int DIM, typename Coord, typename... CoordTypes>
+bool grid<N, T, Layout, Allocator>::within_bounds(Coord coord, CoordTypes... coords) const noexcept
 {
-    size_type s = this->coord_to_index_rec<DIM+1>(agg, coords...);
-    agg *= dims_[DIM + 1];
-    return agg * coord + s;
+    return CoordInBounds(coord, dims_[DIM]) & within_bounds<DIM+1>(coords...);
 }
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 template <int DIM, typename Coord>
-typename grid<N, T>::size_type grid<N, T>::coord_to_index_rec(size_type& agg, Coord coord)
+bool grid<N, T, Layout, Allocator>::within_bounds(Coord coord) const noexcept
 {
     static_assert(DIM == N - 1, "Something is wrong");
-//    agg *= dims_[DIM];
-    return coord;
+    return CoordInBounds(coord, dims_[DIM]);
 }
 
-template <int N, typename T>
-template <int DIM, typename Coord, typename... CoordTypes>
-bool grid<N, T>::within_bounds(Coord coord, CoordTypes... coords) const
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid<N, T, Layout, Allocator>::create_last_index() const -> index
 {
-    return (size_type)coord >= 0 && (size_type)coord < dims_[DIM] && within_bounds<DIM+1>(coords...);
+    index i;
+    for (int d = 0; d < N; ++d) {
+        i(d) = dims_[d] - 1;
+    }
+    return i;
 }
 
-template <int N, typename T>
-template <int DIM, typename Coord>
-bool grid<N, T>::within_bounds(Coord coord) const
+template <int N, typename T, typename Layout, typename Allocator>
+bool grid<N, T, Layout, Allocator>::is_contiguous(const index& start, const index& end) const
 {
-    static_assert(DIM == N - 1, "Something is wrong");
-    return (size_type)coord >= 0 && (size_type)coord < dims_[DIM];
+    if (!Layout::contiguous_rows) {
+        return false;
+    }
+    for (int i = 1; i < N; ++i) {
+        if (start(i) != 0 || end(i) != dims_[i] - 1) {
+            return false;
+        }
+    }
+    return true;
 }
 
-template <int N, typename T, int DIM>
-struct IndexSizeFiller
+/// Return the outermost dimension d such that, within the box [start, end] of
+/// the row-major grid g, each run of elements over dimensions d..N-1 is
+/// contiguous in memory.
+template <int N, typename T, typename Layout, typename Allocator>
+int ContiguousRunDim(
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end)
 {
-    void operator()(const grid<N, T>& g, typename grid<N, T>::index& i)
-    {
-        i(DIM) = g.size(DIM) - 1;
-        IndexSizeFiller<N, T, DIM+1>()(g, i);
+    int d = N - 1;
+    while (d > 0 && start(d) == 0 && end(d) + 1 == g.size(d)) {
+        --d;
     }
-};
+    return d;
+}
 
-template <int N, typename T>
-struct IndexSizeFiller<N, T, N>
+/// Call fn(run_start, run_length) for each run of the box [start, end] that
+/// spans dimensions run_dim..N-1, in row-major order.
+template <int N, typename T, typename Function>
+void ForEachRun(
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    int run_dim,
+    Function fn)
 {
-    void operator()(const grid<N, T>& g, typename grid<N, T>::index& i)
-    {
+    typedef typename grid_index<N, T>::size_type size_type;
+
+    size_type len = 1;
+    for (int i = run_dim; i < N; ++i) {
+        len *= end(i) - start(i) + 1;
     }
-};
 
-template <int N, typename T>
-auto grid<N, T>::create_last_index() const -> typename grid<N, T>::index
+    grid_index<N, T> curr = start;
+    while (true) {
+        fn(curr, len);
+
+        // advance the outer dimensions odometer-style
+        int d = run_dim - 1;
+        while (d >= 0 && curr(d) == end(d)) {
+            curr(d) = start(d);
+            --d;
+        }
+        if (d < 0) {
+            break;
+        }
+        ++curr(d);
+    }
+}
+
+template <int N, typename T, typename U, typename Layout, typename Allocator>
+typename grid_index<N, T>::size_type
+StrideOffset(const grid<N, U, Layout, Allocator>& g, const grid_index<N, T>& i)
 {
-    index i;
-    IndexSizeFiller<N, T, 0>()(*this, i);
-    return i;
+    typename grid_index<N, T>::size_type off = 0;
+    for (int d = 0; d < N; ++d) {
+        off += g.stride(d) * i(d);
+    }
+    return off;
 }
 
-template <int N, typename T>
-void grid<N, T>::copy_grid(grid& g)
+template <typename T>
+void CopyRun(const T* src, std::size_t len, T* dst, std::true_type)
+{
+    memcpy(dst, src, len * sizeof(T));
+}
+
+template <typename T>
+void CopyRun(const T* src, std::size_t len, T* dst, std::false_type)
+{
+    std::copy(src, src + len, dst);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::copy_grid(grid& g)
+{
+    if (total_size() == 0 || g.total_size() == 0) {
+        return;
+    }
+
+    copy_grid(g, std::integral_constant<bool, Layout::contiguous_rows>());
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::copy_grid(grid& g, std::true_type contiguous_rows)
+{
+    index start; // [ 0, 0, .., 0 ]
+
+    index end = create_last_index();
+    for (int i = 0; i < N; ++i) {
+        if (end(i) > g.size(i) - 1) {
+            end(i) = g.size(i) - 1;
+        }
+    }
+
+    // copy over old data into new buffer one contiguous run at a time
+    const int run_dim = std::max(
+            ContiguousRunDim(*this, start, end),
+            ContiguousRunDim(g, start, end));
+    ForEachRun(start, end, run_dim, [&](const index& i, size_type len)
+    {
+        CopyRun(data_ + coord_to_index(i), len, g.data_ + g.coord_to_index(i),
+                std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void grid<N, T, Layout, Allocator>::copy_grid(grid& g, std::false_type contiguous_rows)
 {
     index start; // [ 0, 0, .., 0 ]
 
@@ -525,34 +760,195 @@ void grid<N, T>::copy_grid(grid& g)
         }
     }
 
-    // copy over old data into new buffer; shouldn't copy anything if the
-    // current data buffer is null
     for (auto git = gbegin(start, end); git != gend(start, end); ++git) {
         g(git.cindex()) = *git;
     }
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// grid_index Implementation
-////////////////////////////////////////////////////////////////////////////////
+template <size_t... I>
+struct IndexSequence { };
 
-template <int N, typename T, int DIM>
-struct IndexAssigner
+template <size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> { };
+
+template <size_t... I>
+struct MakeIndexSequence<0, I...>
 {
-    void operator()(grid_index<N, T>& ind, typename grid<N, T>::size_type coord)
-    {
-        ind(DIM) = coord;
-        IndexAssigner<N, T, DIM+1>()(ind, coord);
+    typedef IndexSequence<I...> type;
+};
+
+template <int N, typename T, typename Layout, typename Allocator, size_t... I>
+void ResizeDiscard(
+    grid<N, T, Layout, Allocator>& g,
+    const size_t* dims,
+    IndexSequence<I...>,
+    std::true_type trivial)
+{
+    g.resize_uninitialized(dims[I]...);
+}
+
+template <int N, typename T, typename Layout, typename Allocator, size_t... I>
+void ResizeDiscard(
+    grid<N, T, Layout, Allocator>& g,
+    const size_t* dims,
+    IndexSequence<I...>,
+    std::false_type trivial)
+{
+    g.clear();
+    g.resize(dims[I]...);
+}
+
+/// Resize a grid to the sizes in dims, discarding its contents. Elements are
+/// left uninitialized if T is trivial and value-initialized otherwise.
+template <int N, typename T, typename Layout, typename Allocator>
+void ResizeDiscard(grid<N, T, Layout, Allocator>& g, const size_t* dims)
+{
+    ResizeDiscard(g, dims, typename MakeIndexSequence<N>::type(),
+            std::integral_constant<bool,
+                    std::is_trivially_default_constructible<T>::value &&
+                    std::is_trivially_destructible<T>::value>());
+}
+
+/// Resize dst to the sizes of src, discarding its contents.
+template <int N, typename T, typename Layout, typename Allocator, typename U, typename DstLayout, typename DstAllocator>
+void ResizeLike(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, DstLayout, DstAllocator>& dst)
+{
+    size_t dims[N];
+    for (int i = 0; i < N; ++i) {
+        dims[i] = src.size(i);
     }
+    ResizeDiscard(dst, dims);
+}
+
+/// The default predicate for algorithms over occupancy grids: true for every
+/// value other than T(), which matches the 0/1 cells of a Map.
+template <typename T>
+struct NonDefaultValue
+{
+    bool operator()(const T& value) const { return !(value == T()); }
 };
 
-template <int N, typename T>
-struct IndexAssigner<N, T, N>
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void for_each_row(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn)
+{
+    static_assert(Layout::contiguous_rows, "for_each_row requires a layout with contiguous rows");
+    typedef typename grid<N, T, Layout, Allocator>::size_type size_type;
+    if (g.total_size() == 0) {
+        return;
+    }
+    ForEachRun(start, end, ContiguousRunDim(g, start, end),
+            [&](const grid_index<N, T>& i, size_type len)
+    {
+        T* first = g.data() + StrideOffset(g, i);
+        fn(first, first + len);
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void FillBox(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    const T& value,
+    std::true_type contiguous_rows)
+{
+    for_each_row(g, start, end, [&](T* first, T* last)
+    {
+        std::fill(first, last, value);
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void FillBox(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    const T& value,
+    std::false_type contiguous_rows)
+{
+    std::fill(g.gbegin(start, end), g.gend(start, end), value);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void fill(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    const T& value)
+{
+    FillBox(g, start, end, value,
+            std::integral_constant<bool, Layout::contiguous_rows>());
+}
+
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void TransformBox(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op,
+    std::true_type contiguous_rows)
 {
-    void operator()(grid_index<N, T>& ind, typename grid<N, T>::size_type coord)
+    typedef typename grid<N, T, Layout, Allocator>::size_type size_type;
+    bool dst_contiguous = true;
+    int run_dim = ContiguousRunDim(src, start, end);
+    for (int d = run_dim + 1; d < N; ++d) {
+        dst_contiguous &= (dst.size(d) == src.size(d));
+    }
+    if (!dst_contiguous) {
+        run_dim = N - 1;
+    }
+    ForEachRun(start, end, run_dim, [&](const grid_index<N, T>& i, size_type len)
     {
+        const T* first = src.data() + StrideOffset(src, i);
+        std::transform(first, first + len, dst.data() + StrideOffset(dst, i), op);
+    });
+}
+
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void TransformBox(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op,
+    std::false_type contiguous_rows)
+{
+    for (auto it = src.gbegin(start, end); it != src.gend(start, end); ++it) {
+        const grid_index<N, T>& i = it.cindex();
+        // grid_index<N, T> and grid_index<N, U> are distinct types
+        typename grid<N, U, Layout, DstAllocator>::index j;
+        for (int d = 0; d < N; ++d) {
+            j(d) = i(d);
+        }
+        dst(j) = op(*it);
     }
-};
+}
+
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op)
+{
+    if (src.total_size() == 0 || dst.total_size() == 0) {
+        return;
+    }
+    TransformBox(src, dst, start, end, op,
+            std::integral_constant<bool, Layout::contiguous_rows>());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// grid_index Implementation
+////////////////////////////////////////////////////////////////////////////////
 
 template <int N, typename T>
 grid_index<N, T>::grid_index()
@@ -571,7 +967,9 @@ grid_index<N, T>::grid_index(Coords... coords)
 template <int N, typename T>
 void grid_index<N, T>::grid_index::assign_all(size_type coord)
 {
-    IndexAssigner<N, T, 0>()(*this, coord);
+    for (int i = 0; i < N; ++i) {
+        coords_[i] = coord;
+    }
 }
 
 template <int N, typename T>
@@ -593,110 +991,136 @@ std::ostream& operator<<(std::ostream& o, const grid_index<N, T>& index)
 // grid_iterator Implementation
 ////////////////////////////////////////////////////////////////////////////////
 
-template <int N, typename T>
-grid_iterator<N, T>::grid_iterator() :
+template <int N, typename T, typename Layout, typename Allocator>
+grid_iterator<N, T, Layout, Allocator>::grid_iterator() :
     grid_(nullptr),
     begin_(),   // 0, 0, ..., 0
     end_(),     // 0, 0, ..., 0
     curr_(),    // 0, 0, ..., 0
-    inc_(N - 1)
+    inc_(N - 1),
+    ptr_(nullptr),
+    contiguous_(false)
 {
 }
 
-template <int N, typename T>
-grid_iterator<N, T>& grid_iterator<N, T>::grid_iterator::operator++()
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator++() -> grid_iterator&
 {
+    if (contiguous_) {
+        ++ptr_;
+        return *this;
+    }
+
     if (inc_ == std::numeric_limits<size_type>::max()) {
         return *this;
     }
-    else if (curr_(inc_) < begin_(inc_) + size(inc_) - 1) {
+    else if (curr_(inc_) < end_(inc_)) {
+        // fast path: step along the innermost dimension
         ++curr_(inc_);
+        if (Layout::contiguous_rows) {
+            ++ptr_;
+        }
+        else {
+            ptr_ = grid_->data_ + grid_->coord_to_index(curr_);
+        }
         return *this;
     }
     else {
         --inc_;
         while (inc_ != std::numeric_limits<size_type>::max()) {
-            if (curr_(inc_) < begin_(inc_) + size(inc_) - 1) {
+            if (curr_(inc_) < end_(inc_)) {
                 ++curr_(inc_);
                 // unload the bases
                 for (int j = inc_ + 1; j < N; ++j) {
                     curr_(j) = begin_(j);
                 }
                 inc_ = N - 1;
+                ptr_ = grid_->data_ + grid_->coord_to_index(curr_);
                 break;
             }
             else {
                 --inc_;
             }
         }
+        if (inc_ == std::numeric_limits<size_type>::max()) {
+            // past the end; match gend()
+            curr_ = end_;
+            ptr_ = nullptr;
+        }
         return *this;
     }
 }
 
-template <int N, typename T>
-grid_iterator<N, T> grid_iterator<N, T>::grid_iterator::operator++(int)
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator++(int) -> grid_iterator
 {
     grid_iterator git(*this);
     this->operator++();
     return git;
 }
 
-template <int N, typename T>
-bool grid_iterator<N, T>::grid_iterator::operator==(const grid_iterator& other) const
+template <int N, typename T, typename Layout, typename Allocator>
+bool grid_iterator<N, T, Layout, Allocator>::operator==(const grid_iterator& other) const
 {
-    auto index_equals = [](const index& gi, const index& gj) -> bool
-    {
-        for (int i = 0; i < N; ++i) {
-            if (gi(i) != gj(i)) {
-                return false;
-            }
-        }
-        return true;
-    };
-
-    // TODO: inc_ == other._inc => equal regardless?
-    return index_equals(curr_, other.curr_) &&
-           grid_ == other.grid_ &&
-           index_equals(begin_, other.begin_) &&
-           index_equals(end_, other.end_) &&
-           inc_ == other.inc_;
+    // the element pointer uniquely identifies the position within a range
+    return ptr_ == other.ptr_ && grid_ == other.grid_;
 }
 
-template <int N, typename T>
-bool grid_iterator<N, T>::grid_iterator::operator!=(const grid_iterator& other) const
+template <int N, typename T, typename Layout, typename Allocator>
+bool grid_iterator<N, T, Layout, Allocator>::operator!=(const grid_iterator& other) const
 {
     return !(this->operator==(other));
 }
 
-template <int N, typename T>
-auto grid_iterator<N, T>::grid_iterator::operator*() -> value_type&
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator*() -> value_type&
 {
-    return grid_->at(curr_);
+    return *ptr_;
 }
 
-template <int N, typename T>
-auto grid_iterator<N, T>::grid_iterator::operator->() -> value_type*
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator->() -> value_type*
 {
-    return grid_->at(curr_);
+    return ptr_;
 }
 
-template <int N, typename T>
-auto grid_iterator<N, T>::grid_iterator::operator--() -> grid_iterator&
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::cindex() const -> const index&
+{
+    if (contiguous_ && grid_ && grid_->data_) {
+        recover_index(std::integral_constant<bool, Layout::contiguous_rows>());
+    }
+    return curr_;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void grid_iterator<N, T, Layout, Allocator>::recover_index(std::true_type) const
+{
+    // recover the coordinates from the offset into the contiguous span
+    size_type off = ptr_ - grid_->data_;
+    for (int i = 0; i < N; ++i) {
+        curr_(i) = off / grid_->stride(i);
+        off -= curr_(i) * grid_->stride(i);
+    }
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator--() -> grid_iterator&
 {
     // TODO: implement
     return *this;
 }
 
-template <int N, typename T>
-auto grid_iterator<N, T>::grid_iterator::operator--(int) -> grid_iterator
+template <int N, typename T, typename Layout, typename Allocator>
+auto grid_iterator<N, T, Layout, Allocator>::operator--(int) -> grid_iterator
 {
     grid_iterator git(*this);
     this->operator--();
     return git;
 }
 
-template <int N, typename T>
-std::ostream& operator<<(std::ostream& o, const grid_iterator<N, T>& it)
+template <int N, typename T, typename Layout, typename Allocator>
+std::ostream& operator<<(std::ostream& o, const grid_iterator<N, T, Layout, Allocator>& it)
 {
     o << "{begin = " << it.begin_ << ", end = " << it.end_ << ", curr = " << it.curr_ << ", inc = " << it.inc_ << "}";
     return o;
@@ -704,4 +1128,7 @@ std::ostream& operator<<(std::ostream& o, const grid_iterator<N, T>& it)
 
 } // namespace au
 
+#undef AU_GRID_DETAIL_ASSERT
+#undef AU_GRID_DETAIL_COLD
+
 #endif
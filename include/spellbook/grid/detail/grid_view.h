@@ -0,0 +1,289 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_grid_view_h
+#define au_detail_grid_view_h
+
+#include "../grid_view.h"
+
+namespace au
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// grid_view Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T>
+grid_view<N, T>::grid_view() :
+    data_(nullptr)
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = 0;
+        strides_[i] = 0;
+    }
+}
+
+template <int N, typename T>
+grid_view<N, T>::grid_view(
+    T* data,
+    const size_type* sizes,
+    const difference_type* strides)
+:
+    data_(data)
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = sizes[i];
+        strides_[i] = strides[i];
+    }
+}
+
+template <int N, typename T>
+template <typename... SizeTypes>
+grid_view<N, T>::grid_view(T* data, SizeTypes... sizes) :
+    data_(data)
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to grid_view");
+    const size_type s[N] = { (size_type)sizes... };
+    difference_type stride = 1;
+    for (int i = N - 1; i >= 0; --i) {
+        dims_[i] = s[i];
+        strides_[i] = stride;
+        stride *= (difference_type)s[i];
+    }
+}
+
+template <int N, typename T>
+template <typename Allocator>
+grid_view<N, T>::grid_view(grid<N, value_type, row_major, Allocator>& g) :
+    data_(g.data())
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = g.data() ? g.size(i) : 0;
+        strides_[i] = (difference_type)g.stride(i);
+    }
+}
+
+template <int N, typename T>
+template <typename Allocator>
+grid_view<N, T>::grid_view(const grid<N, value_type, row_major, Allocator>& g) :
+    data_(g.data())
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = g.data() ? g.size(i) : 0;
+        strides_[i] = (difference_type)g.stride(i);
+    }
+}
+
+template <int N, typename T>
+template <typename U>
+grid_view<N, T>::grid_view(
+    const grid_view<N, U>& other,
+    typename std::enable_if<std::is_convertible<U*, T*>::value>::type*)
+:
+    data_(other.data_)
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = other.dims_[i];
+        strides_[i] = other.strides_[i];
+    }
+}
+
+template <int N, typename T>
+template <typename... CoordTypes>
+auto grid_view<N, T>::operator()(CoordTypes... coords) const -> reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    return data_[offset(c)];
+}
+
+template <int N, typename T>
+auto grid_view<N, T>::operator()(const index& i) const -> reference
+{
+    return data_[offset(i.coords())];
+}
+
+template <int N, typename T>
+template <typename... CoordTypes>
+bool grid_view<N, T>::within_bounds(CoordTypes... coords) const
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
+    return CoordsInBounds(dims_, coords...);
+}
+
+template <int N, typename T>
+auto grid_view<N, T>::begin() const -> iterator
+{
+    iterator it;
+    it.view_ = *this;
+    for (int i = 0; i < N; ++i) {
+        it.curr_(i) = 0;
+    }
+    it.ptr_ = data_;
+    it.pos_ = 0;
+    return it;
+}
+
+template <int N, typename T>
+auto grid_view<N, T>::end() const -> iterator
+{
+    // the coordinates one step past the last element, as reached by
+    // incrementing it: the outermost coordinate overflows and all others wrap
+    iterator it;
+    it.view_ = *this;
+    it.curr_(0) = dims_[0];
+    for (int i = 1; i < N; ++i) {
+        it.curr_(i) = 0;
+    }
+    it.ptr_ = data_ + (difference_type)dims_[0] * strides_[0];
+    it.pos_ = total_size();
+    return it;
+}
+
+template <int N, typename T>
+auto grid_view<N, T>::total_size() const -> size_type
+{
+    size_type s = 1;
+    for (int i = 0; i < N; ++i) {
+        s *= dims_[i];
+    }
+    return s;
+}
+
+template <int N, typename T>
+grid_view<N, T> grid_view<N, T>::window(const index& start, const index& end) const
+{
+    grid_view v;
+    v.data_ = data_ + offset(start.coords());
+    for (int i = 0; i < N; ++i) {
+        v.dims_[i] = end(i) - start(i) + 1;
+        v.strides_[i] = strides_[i];
+    }
+    return v;
+}
+
+template <int N, typename T>
+grid_view<N - 1, T> grid_view<N, T>::slice(size_type dim, size_type coord) const
+{
+    static_assert(N > 1, "Cannot slice a one-dimensional grid_view");
+    grid_view<N - 1, T> v;
+    v.data_ = data_ + (difference_type)coord * strides_[dim];
+    for (int i = 0, j = 0; i < N; ++i) {
+        if (i != (int)dim) {
+            v.dims_[j] = dims_[i];
+            v.strides_[j] = strides_[i];
+            ++j;
+        }
+    }
+    return v;
+}
+
+template <int N, typename T>
+auto grid_view<N, T>::offset(const size_type* c) const -> difference_type
+{
+    difference_type o = 0;
+    for (int i = 0; i < N; ++i) {
+        o += (difference_type)c[i] * strides_[i];
+    }
+    return o;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// grid_view_iterator Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T>
+grid_view_iterator<N, T>::grid_view_iterator() :
+    view_(),
+    curr_(),
+    ptr_(nullptr),
+    pos_(0)
+{
+}
+
+template <int N, typename T>
+grid_view_iterator<N, T>& grid_view_iterator<N, T>::operator++()
+{
+    for (int i = N - 1; i >= 0; --i) {
+        ++curr_(i);
+        ptr_ += view_.strides_[i];
+        if (i == 0 || curr_(i) < view_.dims_[i]) {
+            break;
+        }
+        ptr_ -= (ptrdiff_t)view_.dims_[i] * view_.strides_[i];
+        curr_(i) = 0;
+    }
+    ++pos_;
+    return *this;
+}
+
+template <int N, typename T>
+grid_view_iterator<N, T> grid_view_iterator<N, T>::operator++(int)
+{
+    grid_view_iterator it(*this);
+    ++(*this);
+    return it;
+}
+
+template <int N, typename T>
+bool grid_view_iterator<N, T>::operator==(const grid_view_iterator& other) const
+{
+    return view_.data_ == other.view_.data_ && pos_ == other.pos_;
+}
+
+template <int N, typename T>
+bool grid_view_iterator<N, T>::operator!=(const grid_view_iterator& other) const
+{
+    return !(*this == other);
+}
+
+template <int N, typename T>
+grid_view_iterator<N, T>& grid_view_iterator<N, T>::operator--()
+{
+    for (int i = N - 1; i >= 0; --i) {
+        if (i == 0 || curr_(i) > 0) {
+            --curr_(i);
+            ptr_ -= view_.strides_[i];
+            break;
+        }
+        curr_(i) = view_.dims_[i] - 1;
+        ptr_ += (ptrdiff_t)curr_(i) * view_.strides_[i];
+    }
+    --pos_;
+    return *this;
+}
+
+template <int N, typename T>
+grid_view_iterator<N, T> grid_view_iterator<N, T>::operator--(int)
+{
+    grid_view_iterator it(*this);
+    --(*this);
+    return it;
+}
+
+} // namespace au
+
+#endif
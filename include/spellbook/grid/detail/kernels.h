@@ -0,0 +1,752 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_grid_kernels_h
+#define au_detail_grid_kernels_h
+
+#include "../kernels.h"
+
+// standard includes
+#include <assert.h>
+#include <atomic>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define AU_GRID_X86_SIMD 1
+#include <immintrin.h>
+// AVX2 code is compiled regardless of the target flags and only called after
+// checking that the processor supports it
+#define AU_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace au
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Instruction Set Selection
+////////////////////////////////////////////////////////////////////////////////
+
+inline simd_isa detected_simd_isa()
+{
+#if AU_GRID_X86_SIMD
+    static const simd_isa isa =
+            __builtin_cpu_supports("avx2") ? simd_avx2 : simd_sse2;
+    return isa;
+#else
+    return simd_scalar;
+#endif
+}
+
+inline std::atomic<int>& SimdIsaLimit()
+{
+    static std::atomic<int> limit(simd_avx2);
+    return limit;
+}
+
+inline simd_isa active_simd_isa()
+{
+    const simd_isa detected = detected_simd_isa();
+    const int limit = SimdIsaLimit().load(std::memory_order_relaxed);
+    return limit < (int)detected ? (simd_isa)limit : detected;
+}
+
+inline void set_simd_isa(simd_isa isa)
+{
+    SimdIsaLimit().store(isa, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Byte Operations
+////////////////////////////////////////////////////////////////////////////////
+
+// Each operation provides apply() overloads for scalars, SSE2 vectors, and
+// AVX2 vectors, so that a single loop template can be instantiated for each
+// instruction set.
+
+#if AU_GRID_X86_SIMD
+// flip the sign bit to map signed bytes onto unsigned bytes in order, for
+// operations that SSE2 only provides for unsigned bytes
+inline __m128i FlipSign(__m128i v) { return _mm_xor_si128(v, _mm_set1_epi8((char)0x80)); }
+#endif
+
+struct MinU8
+{
+    typedef uint8_t value_type;
+    static uint8_t apply(uint8_t a, uint8_t b) { return a < b ? a : b; }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+#endif
+};
+
+struct MinI8
+{
+    typedef int8_t value_type;
+    static int8_t apply(int8_t a, int8_t b) { return a < b ? a : b; }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return FlipSign(_mm_min_epu8(FlipSign(a), FlipSign(b))); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_min_epi8(a, b); }
+#endif
+};
+
+struct MaxU8
+{
+    typedef uint8_t value_type;
+    static uint8_t apply(uint8_t a, uint8_t b) { return a > b ? a : b; }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_max_epu8(a, b); }
+#endif
+};
+
+struct MaxI8
+{
+    typedef int8_t value_type;
+    static int8_t apply(int8_t a, int8_t b) { return a > b ? a : b; }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return FlipSign(_mm_max_epu8(FlipSign(a), FlipSign(b))); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_max_epi8(a, b); }
+#endif
+};
+
+template <typename T>
+struct AddI8
+{
+    typedef T value_type;
+    static T apply(T a, T b) { return (T)(uint8_t)((uint8_t)a + (uint8_t)b); }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return _mm_add_epi8(a, b); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_add_epi8(a, b); }
+#endif
+};
+
+struct AddSaturateU8
+{
+    typedef uint8_t value_type;
+    static uint8_t apply(uint8_t a, uint8_t b)
+    {
+        const unsigned s = (unsigned)a + b;
+        return s > 255 ? 255 : (uint8_t)s;
+    }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return _mm_adds_epu8(a, b); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_adds_epu8(a, b); }
+#endif
+};
+
+struct AddSaturateI8
+{
+    typedef int8_t value_type;
+    static int8_t apply(int8_t a, int8_t b)
+    {
+        const int s = (int)a + b;
+        return s > 127 ? 127 : s < -128 ? -128 : (int8_t)s;
+    }
+#if AU_GRID_X86_SIMD
+    static __m128i apply(__m128i a, __m128i b) { return _mm_adds_epi8(a, b); }
+    AU_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) { return _mm256_adds_epi8(a, b); }
+#endif
+};
+
+// x >= value ? 1 : 0
+struct AtLeastU8
+{
+    typedef uint8_t value_type;
+    uint8_t value;
+    uint8_t apply(uint8_t x) const { return x >= value; }
+#if AU_GRID_X86_SIMD
+    __m128i apply(__m128i x) const
+    {
+        const __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(x, _mm_set1_epi8((char)value)), x);
+        return _mm_and_si128(ge, _mm_set1_epi8(1));
+    }
+    AU_TARGET_AVX2 __m256i apply(__m256i x) const
+    {
+        const __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(x, _mm256_set1_epi8((char)value)), x);
+        return _mm256_and_si256(ge, _mm256_set1_epi8(1));
+    }
+#endif
+};
+
+struct AtLeastI8
+{
+    typedef int8_t value_type;
+    int8_t value;
+    uint8_t apply(int8_t x) const { return x >= value; }
+#if AU_GRID_X86_SIMD
+    __m128i apply(__m128i x) const
+    {
+        const __m128i lt = _mm_cmpgt_epi8(_mm_set1_epi8(value), x);
+        return _mm_andnot_si128(lt, _mm_set1_epi8(1));
+    }
+    AU_TARGET_AVX2 __m256i apply(__m256i x) const
+    {
+        const __m256i lt = _mm256_cmpgt_epi8(_mm256_set1_epi8(value), x);
+        return _mm256_andnot_si256(lt, _mm256_set1_epi8(1));
+    }
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernel Loops
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Op>
+void BinaryScalar(const typename Op::value_type* a, const typename Op::value_type* b, size_t n, typename Op::value_type* dst)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = Op::apply(a[i], b[i]);
+    }
+}
+
+template <typename Op, typename T>
+void UnaryScalar(const Op& op, const T* src, size_t n, uint8_t* dst)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = op.apply(src[i]);
+    }
+}
+
+template <typename Op, typename T>
+size_t CountScalar(const Op& op, const T* src, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += op.apply(src[i]);
+    }
+    return count;
+}
+
+inline void PackBitsScalar(const uint8_t* src, size_t n, uint64_t* bits, size_t first_word)
+{
+    for (size_t w = first_word; w * 64 < n; ++w) {
+        uint64_t word = 0;
+        const size_t end = n - w * 64 < 64 ? n - w * 64 : 64;
+        for (size_t i = 0; i < end; ++i) {
+            word |= (uint64_t)(src[w * 64 + i] != 0) << i;
+        }
+        bits[w] = word;
+    }
+}
+
+#if AU_GRID_X86_SIMD
+
+template <typename Op>
+void BinarySse2(const typename Op::value_type* a, const typename Op::value_type* b, size_t n, typename Op::value_type* dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        const __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), Op::apply(va, vb));
+    }
+    BinaryScalar<Op>(a + i, b + i, n - i, dst + i);
+}
+
+template <typename Op>
+AU_TARGET_AVX2
+void BinaryAvx2(const typename Op::value_type* a, const typename Op::value_type* b, size_t n, typename Op::value_type* dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), Op::apply(va, vb));
+    }
+    BinaryScalar<Op>(a + i, b + i, n - i, dst + i);
+}
+
+template <typename Op, typename T>
+void UnarySse2(const Op& op, const T* src, size_t n, uint8_t* dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), op.apply(v));
+    }
+    UnaryScalar(op, src + i, n - i, dst + i);
+}
+
+template <typename Op, typename T>
+AU_TARGET_AVX2
+void UnaryAvx2(const Op& op, const T* src, size_t n, uint8_t* dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), op.apply(v));
+    }
+    UnaryScalar(op, src + i, n - i, dst + i);
+}
+
+// Sum the 0/1 bytes produced by op with psadbw, which adds groups of eight
+// bytes into 64-bit lanes and so cannot overflow.
+template <typename Op, typename T>
+size_t CountSse2(const Op& op, const T* src, size_t n)
+{
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(op.apply(v), _mm_setzero_si128()));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, sum);
+    return (size_t)(lanes[0] + lanes[1]) + CountScalar(op, src + i, n - i);
+}
+
+template <typename Op, typename T>
+AU_TARGET_AVX2
+size_t CountAvx2(const Op& op, const T* src, size_t n)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(op.apply(v), _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, sum);
+    return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + CountScalar(op, src + i, n - i);
+}
+
+inline void PackBitsSse2(const uint8_t* src, size_t n, uint64_t* bits)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t w = 0;
+    for (; (w + 1) * 64 <= n; ++w) {
+        uint64_t word = 0;
+        for (int k = 0; k < 4; ++k) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(src + w * 64 + k * 16));
+            const uint32_t z = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+            word |= (uint64_t)(~z & 0xFFFF) << (k * 16);
+        }
+        bits[w] = word;
+    }
+    PackBitsScalar(src, n, bits, w);
+}
+
+AU_TARGET_AVX2
+inline void PackBitsAvx2(const uint8_t* src, size_t n, uint64_t* bits)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t w = 0;
+    for (; (w + 1) * 64 <= n; ++w) {
+        const __m256i lo = _mm256_loadu_si256((const __m256i*)(src + w * 64));
+        const __m256i hi = _mm256_loadu_si256((const __m256i*)(src + w * 64 + 32));
+        const uint32_t zlo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero));
+        const uint32_t zhi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero));
+        bits[w] = ~((uint64_t)zhi << 32 | zlo);
+    }
+    PackBitsScalar(src, n, bits, w);
+}
+
+#endif
+
+template <typename Op>
+void Binary(const typename Op::value_type* a, const typename Op::value_type* b, size_t n, typename Op::value_type* dst)
+{
+#if AU_GRID_X86_SIMD
+    switch (active_simd_isa()) {
+    case simd_avx2:
+        BinaryAvx2<Op>(a, b, n, dst);
+        return;
+    case simd_sse2:
+        BinarySse2<Op>(a, b, n, dst);
+        return;
+    default:
+        break;
+    }
+#endif
+    BinaryScalar<Op>(a, b, n, dst);
+}
+
+template <typename Op, typename T>
+void Unary(const Op& op, const T* src, size_t n, uint8_t* dst)
+{
+#if AU_GRID_X86_SIMD
+    switch (active_simd_isa()) {
+    case simd_avx2:
+        UnaryAvx2(op, src, n, dst);
+        return;
+    case simd_sse2:
+        UnarySse2(op, src, n, dst);
+        return;
+    default:
+        break;
+    }
+#endif
+    UnaryScalar(op, src, n, dst);
+}
+
+template <typename Op, typename T>
+size_t Count(const Op& op, const T* src, size_t n)
+{
+#if AU_GRID_X86_SIMD
+    switch (active_simd_isa()) {
+    case simd_avx2:
+        return CountAvx2(op, src, n);
+    case simd_sse2:
+        return CountSse2(op, src, n);
+    default:
+        break;
+    }
+#endif
+    return CountScalar(op, src, n);
+}
+
+inline size_t PopcountWordsScalar(const uint64_t* words, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += __builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+#if AU_GRID_X86_SIMD
+// the popcnt instruction predates AVX2 but is not part of the x86-64
+// baseline, so without it __builtin_popcountll is a bit-twiddling sequence
+__attribute__((target("popcnt")))
+inline size_t PopcountWordsPopcnt(const uint64_t* words, size_t n)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += __builtin_popcountll(words[i]);
+    }
+    return count;
+}
+#endif
+
+/// Return the number of set bits in an array of words.
+inline size_t PopcountWords(const uint64_t* words, size_t n)
+{
+#if AU_GRID_X86_SIMD
+    static const bool has_popcnt = __builtin_cpu_supports("popcnt");
+    if (has_popcnt && active_simd_isa() != simd_scalar) {
+        return PopcountWordsPopcnt(words, n);
+    }
+#endif
+    return PopcountWordsScalar(words, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Buffer Kernels
+////////////////////////////////////////////////////////////////////////////////
+
+inline void threshold(const uint8_t* src, size_t n, uint8_t value, uint8_t* mask)
+{
+    AtLeastU8 op = { value };
+    Unary(op, src, n, mask);
+}
+
+inline void threshold(const int8_t* src, size_t n, int8_t value, uint8_t* mask)
+{
+    AtLeastI8 op = { value };
+    Unary(op, src, n, mask);
+}
+
+inline void elementwise_min(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst)
+{
+    Binary<MinU8>(a, b, n, dst);
+}
+
+inline void elementwise_min(const int8_t* a, const int8_t* b, size_t n, int8_t* dst)
+{
+    Binary<MinI8>(a, b, n, dst);
+}
+
+inline void elementwise_max(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst)
+{
+    Binary<MaxU8>(a, b, n, dst);
+}
+
+inline void elementwise_max(const int8_t* a, const int8_t* b, size_t n, int8_t* dst)
+{
+    Binary<MaxI8>(a, b, n, dst);
+}
+
+inline void add(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst)
+{
+    Binary<AddI8<uint8_t>>(a, b, n, dst);
+}
+
+inline void add(const int8_t* a, const int8_t* b, size_t n, int8_t* dst)
+{
+    Binary<AddI8<int8_t>>(a, b, n, dst);
+}
+
+inline void add_saturate(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst)
+{
+    Binary<AddSaturateU8>(a, b, n, dst);
+}
+
+inline void add_saturate(const int8_t* a, const int8_t* b, size_t n, int8_t* dst)
+{
+    Binary<AddSaturateI8>(a, b, n, dst);
+}
+
+inline size_t count_at_least(const uint8_t* src, size_t n, uint8_t value)
+{
+    AtLeastU8 op = { value };
+    return Count(op, src, n);
+}
+
+inline size_t count_at_least(const int8_t* src, size_t n, int8_t value)
+{
+    AtLeastI8 op = { value };
+    return Count(op, src, n);
+}
+
+inline size_t count_nonzero(const uint8_t* src, size_t n)
+{
+    return count_at_least(src, n, (uint8_t)1);
+}
+
+inline void pack_bits(const uint8_t* src, size_t n, uint64_t* bits)
+{
+#if AU_GRID_X86_SIMD
+    switch (active_simd_isa()) {
+    case simd_avx2:
+        PackBitsAvx2(src, n, bits);
+        return;
+    case simd_sse2:
+        PackBitsSse2(src, n, bits);
+        return;
+    default:
+        break;
+    }
+#endif
+    PackBitsScalar(src, n, bits, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Grid Kernels
+////////////////////////////////////////////////////////////////////////////////
+
+// The byte type whose kernels implement an element type: int8_t or uint8_t
+// for 8-bit integers (including char), and void for other types, which use
+// scalar loops.
+template <typename T>
+struct KernelByteType
+{
+    typedef typename std::conditional<
+            std::is_integral<T>::value && sizeof(T) == 1 && !std::is_same<T, bool>::value,
+            typename std::conditional<std::is_signed<T>::value, int8_t, uint8_t>::type,
+            void>::type type;
+};
+
+template <typename T, typename Byte>
+void ThresholdKernel(const T* src, size_t n, const T& value, uint8_t* mask, Byte*)
+{
+    threshold((const Byte*)src, n, (Byte)value, mask);
+}
+
+template <typename T>
+void ThresholdKernel(const T* src, size_t n, const T& value, uint8_t* mask, void*)
+{
+    for (size_t i = 0; i < n; ++i) {
+        mask[i] = !(src[i] < value);
+    }
+}
+
+template <typename T, typename Byte>
+size_t CountAtLeastKernel(const T* src, size_t n, const T& value, Byte*)
+{
+    return count_at_least((const Byte*)src, n, (Byte)value);
+}
+
+template <typename T>
+size_t CountAtLeastKernel(const T* src, size_t n, const T& value, void*)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += !(src[i] < value);
+    }
+    return count;
+}
+
+template <typename T, typename Byte>
+size_t CountNonzeroKernel(const T* src, size_t n, Byte*)
+{
+    return count_nonzero((const uint8_t*)src, n);
+}
+
+template <typename T>
+size_t CountNonzeroKernel(const T* src, size_t n, void*)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += !(src[i] == T());
+    }
+    return count;
+}
+
+template <typename T, typename Byte>
+void PackBitsKernel(const T* src, size_t n, uint64_t* bits, Byte*)
+{
+    pack_bits((const uint8_t*)src, n, bits);
+}
+
+template <typename T>
+void PackBitsKernel(const T* src, size_t n, uint64_t* bits, void*)
+{
+    for (size_t w = 0; w * 64 < n; ++w) {
+        uint64_t word = 0;
+        const size_t end = n - w * 64 < 64 ? n - w * 64 : 64;
+        for (size_t i = 0; i < end; ++i) {
+            word |= (uint64_t)!(src[w * 64 + i] == T()) << i;
+        }
+        bits[w] = word;
+    }
+}
+
+// Binary kernels over grid storage: the byte kernel above for 8-bit integers
+// and scalar_expr, in terms of the elements x and y, for other types.
+#define AU_GRID_BINARY_KERNEL(kernel, name, scalar_expr)                        \
+template <typename T, typename Byte>                                            \
+void kernel(const T* a, const T* b, size_t n, T* dst, Byte*)                    \
+{                                                                               \
+    name((const Byte*)a, (const Byte*)b, n, (Byte*)dst);                        \
+}                                                                               \
+                                                                                \
+template <typename T>                                                           \
+void kernel(const T* a, const T* b, size_t n, T* dst, void*)                    \
+{                                                                               \
+    for (size_t i = 0; i < n; ++i) {                                            \
+        const T& x = a[i];                                                      \
+        const T& y = b[i];                                                      \
+        dst[i] = scalar_expr;                                                   \
+    }                                                                           \
+}
+
+AU_GRID_BINARY_KERNEL(ElementwiseMinKernel, elementwise_min, y < x ? y : x)
+AU_GRID_BINARY_KERNEL(ElementwiseMaxKernel, elementwise_max, x < y ? y : x)
+AU_GRID_BINARY_KERNEL(AddKernel, add, x + y)
+
+#undef AU_GRID_BINARY_KERNEL
+
+template <typename T, typename Byte>
+void AddSaturateKernel(const T* a, const T* b, size_t n, T* dst, Byte*)
+{
+    add_saturate((const Byte*)a, (const Byte*)b, n, (Byte*)dst);
+}
+
+template <typename T>
+void AddSaturateKernel(const T* a, const T* b, size_t n, T* dst, void*)
+{
+    static_assert(std::is_integral<T>::value, "add_saturate requires an integral element type");
+    for (size_t i = 0; i < n; ++i) {
+        const T x = a[i];
+        const T y = b[i];
+        T s;
+        if (y > 0 && x > std::numeric_limits<T>::max() - y) {
+            s = std::numeric_limits<T>::max();
+        }
+        else if (y < 0 && x < std::numeric_limits<T>::min() - y) {
+            s = std::numeric_limits<T>::min();
+        }
+        else {
+            s = x + y;
+        }
+        dst[i] = s;
+    }
+}
+
+template <int N, typename T, typename A, typename B>
+void threshold(
+    const grid<N, T, row_major, A>& src,
+    const T& value,
+    grid<N, uint8_t, row_major, B>& mask)
+{
+    ResizeLike(src, mask);
+    ThresholdKernel(src.data(), src.storage_size(), value, mask.data(),
+            (typename KernelByteType<T>::type*)0);
+}
+
+#define AU_GRID_BINARY_OP(name, kernel)                                         \
+template <int N, typename T, typename A, typename B, typename C>                \
+void name(                                                                      \
+    const grid<N, T, row_major, A>& a,                                          \
+    const grid<N, T, row_major, B>& b,                                          \
+    grid<N, T, row_major, C>& dst)                                              \
+{                                                                               \
+    assert(a.total_size() == b.total_size());                                   \
+    if ((const void*)&dst != (const void*)&a &&                                 \
+        (const void*)&dst != (const void*)&b)                                   \
+    {                                                                           \
+        ResizeLike(a, dst);                                                     \
+    }                                                                           \
+    kernel(a.data(), b.data(), a.storage_size(), dst.data(),                    \
+            (typename KernelByteType<T>::type*)0);                              \
+}
+
+AU_GRID_BINARY_OP(elementwise_min, ElementwiseMinKernel)
+AU_GRID_BINARY_OP(elementwise_max, ElementwiseMaxKernel)
+AU_GRID_BINARY_OP(add, AddKernel)
+AU_GRID_BINARY_OP(add_saturate, AddSaturateKernel)
+
+#undef AU_GRID_BINARY_OP
+
+template <int N, typename T, typename A>
+size_t count_at_least(const grid<N, T, row_major, A>& g, const T& value)
+{
+    return CountAtLeastKernel(g.data(), g.storage_size(), value,
+            (typename KernelByteType<T>::type*)0);
+}
+
+template <int N, typename T, typename A, typename Predicate>
+size_t count_if(const grid<N, T, row_major, A>& g, Predicate pred)
+{
+    const T* data = g.data();
+    const size_t n = g.storage_size();
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += pred(data[i]) ? 1 : 0;
+    }
+    return count;
+}
+
+template <int N, typename T, typename A>
+size_t count_nonzero(const grid<N, T, row_major, A>& g)
+{
+    return CountNonzeroKernel(g.data(), g.storage_size(),
+            (typename KernelByteType<T>::type*)0);
+}
+
+template <int N, typename T, typename A>
+void pack_bits(const grid<N, T, row_major, A>& g, std::vector<uint64_t>& bits)
+{
+    const size_t n = g.storage_size();
+    bits.resize((n + 63) / 64);
+    PackBitsKernel(g.data(), n, bits.data(),
+            (typename KernelByteType<T>::type*)0);
+}
+
+} // namespace au
+
+#endif
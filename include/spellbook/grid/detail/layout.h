@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_grid_layout_h
+#define au_detail_grid_layout_h
+
+#include "../layout.h"
+
+#include <stdint.h>
+
+namespace au
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// row_major Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N>
+void row_major::mapping<N>::resize(const size_t* dims)
+{
+    strides_[N - 1] = 1;
+    for (int i = N - 2; i >= 0; --i) {
+        strides_[i] = strides_[i + 1] * dims[i + 1];
+    }
+    size_ = strides_[0] * dims[0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// brick_mapping Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N>
+void brick_mapping<N>::resize(const size_t* dims, size_t shift)
+{
+    shift_ = shift;
+    mask_ = ((size_t)1 << shift) - 1;
+
+    size_t counts[N];
+    for (int i = 0; i < N; ++i) {
+        counts[i] = (dims[i] + mask_) >> shift;
+    }
+
+    brick_strides_[N - 1] = 1;
+    for (int i = N - 2; i >= 0; --i) {
+        brick_strides_[i] = brick_strides_[i + 1] * counts[i + 1];
+    }
+    size_ = (brick_strides_[0] * counts[0]) << (N * shift);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// tiled Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <size_t B>
+struct BrickShift
+{
+    static const size_t value = 1 + BrickShift<(B >> 1)>::value;
+};
+
+template <>
+struct BrickShift<1>
+{
+    static const size_t value = 0;
+};
+
+template <size_t B>
+template <int N>
+void tiled<B>::mapping<N>::resize(const size_t* dims)
+{
+    brick_mapping<N>::resize(dims, BrickShift<B>::value);
+}
+
+template <size_t B>
+template <int N>
+size_t tiled<B>::mapping<N>::offset(const size_t* c) const
+{
+    const size_t shift = BrickShift<B>::value;
+    size_t brick = 0;
+    size_t inner = 0;
+    for (int i = 0; i < N; ++i) {
+        brick += this->brick_strides_[i] * (c[i] >> shift);
+        inner = (inner << shift) | (c[i] & (B - 1));
+    }
+    return (brick << (N * shift)) | inner;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// morton Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+// Spread the low bits of v so that there are N - 1 zero bits between each of
+// them.
+template <int N>
+struct MortonSpread
+{
+    static uint64_t apply(uint64_t v)
+    {
+        uint64_t r = 0;
+        for (size_t b = 0; b * N < 64; ++b) {
+            r |= ((v >> b) & 1) << (N * b);
+        }
+        return r;
+    }
+};
+
+template <>
+struct MortonSpread<1>
+{
+    static uint64_t apply(uint64_t v) { return v; }
+};
+
+template <>
+struct MortonSpread<2>
+{
+    static uint64_t apply(uint64_t v)
+    {
+        v &= 0x00000000ffffffffull;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+        v = (v | (v << 8))  & 0x00ff00ff00ff00ffull;
+        v = (v | (v << 4))  & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v << 2))  & 0x3333333333333333ull;
+        v = (v | (v << 1))  & 0x5555555555555555ull;
+        return v;
+    }
+};
+
+template <>
+struct MortonSpread<3>
+{
+    static uint64_t apply(uint64_t v)
+    {
+        v &= 0x00000000001fffffull;
+        v = (v | (v << 32)) & 0x001f00000000ffffull;
+        v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+        v = (v | (v << 8))  & 0x100f00f00f00f00full;
+        v = (v | (v << 4))  & 0x10c30c30c30c30c3ull;
+        v = (v | (v << 2))  & 0x1249249249249249ull;
+        return v;
+    }
+};
+
+template <int N>
+void morton::mapping<N>::resize(const size_t* dims)
+{
+    size_t min_dim = dims[0];
+    for (int i = 1; i < N; ++i) {
+        if (dims[i] < min_dim) {
+            min_dim = dims[i];
+        }
+    }
+
+    // smallest power of two covering the smallest dimension, limited so that
+    // the interleaved in-brick offset fits in 64 bits
+    size_t shift = 0;
+    while (((size_t)1 << shift) < min_dim && (shift + 1) * N < 64) {
+        ++shift;
+    }
+    brick_mapping<N>::resize(dims, shift);
+}
+
+template <int N>
+size_t morton::mapping<N>::offset(const size_t* c) const
+{
+    size_t brick = 0;
+    uint64_t inner = 0;
+    for (int i = 0; i < N; ++i) {
+        brick += this->brick_strides_[i] * (c[i] >> this->shift_);
+        // the first coordinate takes the most significant bit of each group,
+        // matching the dimension ordering of row_major
+        inner |= MortonSpread<N>::apply(c[i] & this->mask_) << (N - 1 - i);
+    }
+    return (brick << (N * this->shift_)) | (size_t)inner;
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,278 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_mapped_grid_h
+#define au_detail_mapped_grid_h
+
+#include "../mapped_grid.h"
+
+// standard includes
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+// system includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace au
+{
+
+static const char MappedGridMagic[8] = { 'A', 'U', 'G', 'R', 'I', 'D', '\0', '\0' };
+
+static const uint64_t MappedGridAlignment = 4096;
+
+////////////////////////////////////////////////////////////////////////////////
+// mapped_grid Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, typename Layout>
+mapped_grid<N, T, Layout>::mapped_grid() :
+    base_(nullptr),
+    length_(0),
+    mode_(read_only),
+    data_(nullptr)
+{
+    reset();
+}
+
+template <int N, typename T, typename Layout>
+mapped_grid<N, T, Layout>::mapped_grid(mapped_grid&& other) :
+    base_(other.base_),
+    length_(other.length_),
+    mode_(other.mode_),
+    data_(other.data_),
+    layout_(other.layout_)
+{
+    memcpy(dims_, other.dims_, N * sizeof(size_type));
+    other.base_ = nullptr;
+    other.close();
+}
+
+template <int N, typename T, typename Layout>
+mapped_grid<N, T, Layout>& mapped_grid<N, T, Layout>::operator=(mapped_grid&& rhs)
+{
+    if (this != &rhs) {
+        close();
+        base_ = rhs.base_;
+        length_ = rhs.length_;
+        mode_ = rhs.mode_;
+        data_ = rhs.data_;
+        memcpy(dims_, rhs.dims_, N * sizeof(size_type));
+        layout_ = rhs.layout_;
+        rhs.base_ = nullptr;
+        rhs.close();
+    }
+    return *this;
+}
+
+template <int N, typename T, typename Layout>
+mapped_grid<N, T, Layout>::~mapped_grid()
+{
+    close();
+}
+
+template <int N, typename T, typename Layout>
+bool mapped_grid<N, T, Layout>::open(const std::string& path, mode_type mode)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mapped_grid_header)) {
+        ::close(fd);
+        return false;
+    }
+
+    const size_type length = (size_type)st.st_size;
+    const int prot = mode == copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ;
+    const int flags = mode == copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+    void* base = mmap(nullptr, length, prot, flags, fd, 0);
+
+    // the mapping holds its own reference to the file
+    ::close(fd);
+
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    mapped_grid_header header;
+    memcpy(&header, base, sizeof(header));
+
+    bool valid =
+            memcmp(header.magic, MappedGridMagic, sizeof(MappedGridMagic)) == 0 &&
+            header.version == mapped_grid_header::current_version &&
+            header.num_dims == (uint32_t)N &&
+            header.element_size == (uint32_t)sizeof(T) &&
+            header.layout_id == Layout::id &&
+            header.layout_param == Layout::param &&
+            header.data_offset % MappedGridAlignment == 0 &&
+            header.data_offset <= length &&
+            header.data_size <= length - header.data_offset;
+
+    size_type dims[N];
+    mapping_type layout;
+    if (valid) {
+        for (int i = 0; i < N; ++i) {
+            dims[i] = (size_type)header.dims[i];
+        }
+        layout.resize(dims);
+        valid = header.data_size == layout.storage_size() * sizeof(T);
+    }
+
+    if (!valid) {
+        munmap(base, length);
+        return false;
+    }
+
+    base_ = base;
+    length_ = length;
+    mode_ = mode;
+    data_ = reinterpret_cast<T*>(static_cast<char*>(base) + header.data_offset);
+    memcpy(dims_, dims, N * sizeof(size_type));
+    layout_ = layout;
+    return true;
+}
+
+template <int N, typename T, typename Layout>
+void mapped_grid<N, T, Layout>::close()
+{
+    if (base_) {
+        munmap(base_, length_);
+    }
+    reset();
+}
+
+template <int N, typename T, typename Layout>
+void mapped_grid<N, T, Layout>::reset()
+{
+    base_ = nullptr;
+    length_ = 0;
+    mode_ = read_only;
+    data_ = nullptr;
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = 0;
+    }
+    layout_.resize(dims_);
+}
+
+template <int N, typename T, typename Layout>
+template <typename... CoordTypes>
+auto mapped_grid<N, T, Layout>::operator()(CoordTypes... coords) -> reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    return data_[layout_.offset(c)];
+}
+
+template <int N, typename T, typename Layout>
+template <typename... CoordTypes>
+auto mapped_grid<N, T, Layout>::operator()(CoordTypes... coords) const -> const_reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    return data_[layout_.offset(c)];
+}
+
+template <int N, typename T, typename Layout>
+auto mapped_grid<N, T, Layout>::operator()(const index& i) -> reference
+{
+    return data_[layout_.offset(i.coords())];
+}
+
+template <int N, typename T, typename Layout>
+auto mapped_grid<N, T, Layout>::operator()(const index& i) const -> const_reference
+{
+    return data_[layout_.offset(i.coords())];
+}
+
+template <int N, typename T, typename Layout>
+template <typename... CoordTypes>
+bool mapped_grid<N, T, Layout>::within_bounds(CoordTypes... coords) const
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
+    return CoordsInBounds(dims_, coords...);
+}
+
+template <int N, typename T, typename Layout>
+auto mapped_grid<N, T, Layout>::total_size() const -> size_type
+{
+    size_type s = 1;
+    for (int i = 0; i < N; ++i) { s *= dims_[i]; }
+    return s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// save_mapped_grid Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool save_mapped_grid(
+    const std::string& path,
+    const grid<N, T, Layout, Allocator>& g)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "save_mapped_grid requires a trivially copyable element type");
+    static_assert(N <= (int)mapped_grid_header::max_dims, "Too many dimensions for mapped_grid");
+
+    mapped_grid_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MappedGridMagic, sizeof(MappedGridMagic));
+    header.version = mapped_grid_header::current_version;
+    header.num_dims = N;
+    header.element_size = sizeof(T);
+    header.layout_id = Layout::id;
+    header.layout_param = Layout::param;
+    for (int i = 0; i < N; ++i) {
+        header.dims[i] = g.size(i);
+    }
+    header.data_offset = MappedGridAlignment;
+    header.data_size = g.storage_size() * sizeof(T);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+
+    char pad[MappedGridAlignment] = { };
+    bool ok =
+            fwrite(&header, sizeof(header), 1, f) == 1 &&
+            fwrite(pad, MappedGridAlignment - sizeof(header), 1, f) == 1;
+    if (ok && header.data_size > 0) {
+        ok = fwrite(g.data(), header.data_size, 1, f) == 1;
+    }
+
+    return fclose(f) == 0 && ok;
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_metric_grid_h
+#define au_detail_metric_grid_h
+
+#include "../metric_grid.h"
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace au
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// grid_frame Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+// floor(x) as an integer, without a branch or a libm call: truncate, then
+// subtract one if truncation rounded up. NaN, infinities, and values beyond
+// +/-OutOfRangeCell, which cannot be converted safely, become OutOfRangeCell,
+// whose unsigned value is larger than any grid dimension.
+static const ptrdiff_t OutOfRangeCell = -(std::numeric_limits<ptrdiff_t>::max() / 2 + 1);
+
+inline ptrdiff_t FloorToCell(double x)
+{
+    // the comparison is false for NaN
+    x = (std::fabs(x) < -(double)OutOfRangeCell) ? x : (double)OutOfRangeCell;
+    const ptrdiff_t t = (ptrdiff_t)x;
+    return t - (ptrdiff_t)(x < (double)t);
+}
+
+template <int N>
+grid_frame<N>::grid_frame() :
+    resolution_(1.0),
+    inv_resolution_(1.0)
+{
+    std::fill(origin_, origin_ + N, 0.0);
+}
+
+template <int N>
+grid_frame<N>::grid_frame(const double* origin, double resolution)
+{
+    set_origin(origin);
+    set_resolution(resolution);
+}
+
+template <int N>
+void grid_frame<N>::set_origin(const double* origin)
+{
+    std::copy(origin, origin + N, origin_);
+}
+
+template <int N>
+void grid_frame<N>::set_resolution(double res)
+{
+    resolution_ = res;
+    inv_resolution_ = 1.0 / res;
+}
+
+template <int N>
+void grid_frame<N>::world_to_grid(const double* p, ptrdiff_t* c) const
+{
+    for (int d = 0; d < N; ++d) {
+        c[d] = FloorToCell((p[d] - origin_[d]) * inv_resolution_);
+    }
+}
+
+template <int N>
+void grid_frame<N>::grid_to_world(const ptrdiff_t* c, double* p) const
+{
+    for (int d = 0; d < N; ++d) {
+        p[d] = origin_[d] + ((double)c[d] + 0.5) * resolution_;
+    }
+}
+
+template <int N>
+template <typename Real>
+void grid_frame<N>::world_to_grid(
+    const Real* points,
+    size_t count,
+    size_t stride,
+    ptrdiff_t* cells) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Real* p = points + i * stride;
+        ptrdiff_t* c = cells + i * N;
+        for (int d = 0; d < N; ++d) {
+            c[d] = FloorToCell(((double)p[d] - origin_[d]) * inv_resolution_);
+        }
+    }
+}
+
+template <int N>
+template <typename Real>
+void grid_frame<N>::grid_to_world(
+    const ptrdiff_t* cells,
+    size_t count,
+    Real* points,
+    size_t stride) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        const ptrdiff_t* c = cells + i * N;
+        Real* p = points + i * stride;
+        for (int d = 0; d < N; ++d) {
+            p[d] = (Real)(origin_[d] + ((double)c[d] + 0.5) * resolution_);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// metric_grid Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, typename Layout, typename Allocator>
+metric_grid<N, T, Layout, Allocator>::metric_grid() :
+    grid_(),
+    frame_()
+{
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+template <typename... SizeTypes>
+metric_grid<N, T, Layout, Allocator>::metric_grid(
+    const frame_type& frame,
+    SizeTypes... sizes)
+:
+    grid_(sizes...),
+    frame_(frame)
+{
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+T* metric_grid<N, T, Layout, Allocator>::find(const double* p)
+{
+    ptrdiff_t c[N];
+    frame_.world_to_grid(p, c);
+    index i;
+    return to_index(c, i) ? &grid_(i) : nullptr;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+const T* metric_grid<N, T, Layout, Allocator>::find(const double* p) const
+{
+    ptrdiff_t c[N];
+    frame_.world_to_grid(p, c);
+    index i;
+    return to_index(c, i) ? &grid_(i) : nullptr;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool metric_grid<N, T, Layout, Allocator>::world_to_grid(
+    const double* p,
+    index& i) const
+{
+    ptrdiff_t c[N];
+    frame_.world_to_grid(p, c);
+    return to_index(c, i);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void metric_grid<N, T, Layout, Allocator>::grid_to_world(
+    const index& i,
+    double* p) const
+{
+    ptrdiff_t c[N];
+    for (int d = 0; d < N; ++d) {
+        c[d] = (ptrdiff_t)i(d);
+    }
+    frame_.grid_to_world(c, p);
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+template <typename Real>
+auto metric_grid<N, T, Layout, Allocator>::insert(
+    const Real* points,
+    size_type count,
+    size_type stride,
+    const T& value) -> size_type
+{
+    // convert a batch of points at a time so that the conversion loop runs
+    // without interruption
+    const size_type batch = 256;
+    ptrdiff_t cells[batch * N];
+
+    size_type dims[N];
+    for (int d = 0; d < N; ++d) {
+        dims[d] = grid_.size(d);
+    }
+
+    size_type inserted = 0;
+    for (size_type first = 0; first < count; first += batch) {
+        const size_type n = std::min(batch, count - first);
+        frame_.world_to_grid(points + first * stride, n, stride, cells);
+        for (size_type k = 0; k < n; ++k) {
+            const ptrdiff_t* c = cells + k * N;
+            bool inside = true;
+            for (int d = 0; d < N; ++d) {
+                inside &= (size_type)c[d] < dims[d];
+            }
+            if (inside) {
+                index i;
+                for (int d = 0; d < N; ++d) {
+                    i(d) = (size_type)c[d];
+                }
+                grid_(i) = value;
+                ++inserted;
+            }
+        }
+    }
+    return inserted;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool metric_grid<N, T, Layout, Allocator>::to_index(
+    const ptrdiff_t* c,
+    index& i) const
+{
+    // negative coordinates wrap around to large unsigned values, so one
+    // comparison per dimension checks both bounds
+    bool inside = true;
+    for (int d = 0; d < N; ++d) {
+        i(d) = (size_type)c[d];
+        inside &= i(d) < grid_.size(d);
+    }
+    return inside;
+}
+
+} // namespace au
+
+#endif
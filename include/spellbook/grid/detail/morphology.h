@@ -0,0 +1,340 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_morphology_h
+#define au_detail_morphology_h
+
+#include "../morphology.h"
+
+// standard includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace au
+{
+
+template <typename T>
+struct MaxFilterOp
+{
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T apply(const T& a, const T& b) { return a < b ? b : a; }
+};
+
+template <typename T>
+struct MinFilterOp
+{
+    static T identity() { return std::numeric_limits<T>::max(); }
+    static T apply(const T& a, const T& b) { return b < a ? b : a; }
+};
+
+/// van Herk/Gil-Werman running extremum over windows of 2r + 1 elements,
+/// applied to a batch of lanes adjacent lines at once, where element j of
+/// lane k is p[j * stride + k]. Each line is padded with r identity elements
+/// on each side and split into blocks of the window size; the extremum of
+/// any window is then the combination of a suffix extremum of the block
+/// where it starts and a prefix extremum of the block where it ends. The
+/// lanes are the innermost loops, so that they vectorize.
+template <typename T, typename Op>
+struct VanHerkLines
+{
+    size_t n;
+    size_t r;
+    size_t max_lanes;
+    std::vector<T> prefix;
+    std::vector<T> suffix;
+
+    VanHerkLines(size_t n, size_t r, size_t max_lanes) :
+        n(n),
+        r(r),
+        max_lanes(max_lanes),
+        prefix((n + 2 * r) * max_lanes),
+        suffix((n + 2 * r) * max_lanes)
+    {
+    }
+
+    void operator()(T* p, size_t stride, size_t lanes)
+    {
+        if (max_lanes == 1) {
+            filter_line(p, stride);
+            return;
+        }
+
+        const size_t w = 2 * r + 1;
+        const size_t m = n + 2 * r;
+        const size_t k = max_lanes;
+        T* pre = prefix.data();
+        T* suf = suffix.data();
+
+        // the padded lines
+        std::fill(suf, suf + r * k, Op::identity());
+        for (size_t i = 0; i < n; ++i) {
+            std::copy(p + i * stride, p + i * stride + lanes, suf + (r + i) * k);
+        }
+        std::fill(suf + (r + n) * k, suf + m * k, Op::identity());
+
+        // prefix and suffix extrema within each block
+        for (size_t b = 0; b < m; b += w) {
+            const size_t e = std::min(b + w, m);
+            std::copy(suf + b * k, suf + b * k + lanes, pre + b * k);
+            for (size_t j = b + 1; j < e; ++j) {
+                T* dst = pre + j * k;
+                const T* prev = dst - k;
+                const T* cur = suf + j * k;
+                for (size_t l = 0; l < lanes; ++l) {
+                    dst[l] = Op::apply(prev[l], cur[l]);
+                }
+            }
+            for (size_t j = e - 1; j > b; --j) {
+                T* dst = suf + (j - 1) * k;
+                const T* next = dst + k;
+                for (size_t l = 0; l < lanes; ++l) {
+                    dst[l] = Op::apply(dst[l], next[l]);
+                }
+            }
+        }
+
+        // the window for output i is [i, i + w - 1] in padded coordinates
+        for (size_t i = 0; i < n; ++i) {
+            T* dst = p + i * stride;
+            const T* lo = suf + i * k;
+            const T* hi = pre + (i + w - 1) * k;
+            for (size_t l = 0; l < lanes; ++l) {
+                dst[l] = Op::apply(lo[l], hi[l]);
+            }
+        }
+    }
+
+    /// The same for a single line, without the per-lane loops.
+    void filter_line(T* p, size_t stride)
+    {
+        const size_t w = 2 * r + 1;
+        const size_t m = n + 2 * r;
+        T* pre = prefix.data();
+        T* suf = suffix.data();
+
+        std::fill(suf, suf + r, Op::identity());
+        for (size_t i = 0; i < n; ++i) {
+            suf[r + i] = p[i * stride];
+        }
+        std::fill(suf + r + n, suf + m, Op::identity());
+
+        for (size_t b = 0; b < m; b += w) {
+            const size_t e = std::min(b + w, m);
+            T acc = suf[b];
+            pre[b] = acc;
+            for (size_t j = b + 1; j < e; ++j) {
+                acc = Op::apply(acc, suf[j]);
+                pre[j] = acc;
+            }
+            acc = suf[e - 1];
+            for (size_t j = e - 1; j > b; --j) {
+                acc = Op::apply(suf[j - 1], acc);
+                suf[j - 1] = acc;
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            p[i * stride] = Op::apply(suf[i], pre[i + w - 1]);
+        }
+    }
+};
+
+/// Filter every line of g along dim. Viewed along dim, a row-major grid is
+/// an outer x size(dim) x inner array; the lines of each outer slice are
+/// processed in batches of adjacent inner coordinates.
+template <typename Op, int N, typename T, typename Allocator>
+void VanHerkPass(grid<N, T, row_major, Allocator>& g, int dim, size_t r, thread_pool& pool)
+{
+    const size_t n = g.size(dim);
+    const size_t inner = g.stride(dim);
+    const size_t outer = g.total_size() / (n * inner);
+    const size_t lanes = std::min<size_t>(inner, 64);
+    const size_t batches_per_slice = (inner + lanes - 1) / lanes;
+
+    const VanHerkLines<T, Op> fn(n, r, lanes);
+    ParallelForRange(pool, outer * batches_per_slice, [&](size_t first, size_t last)
+    {
+        VanHerkLines<T, Op> lines_fn(fn);
+        for (size_t b = first; b < last; ++b) {
+            const size_t o = b / batches_per_slice;
+            const size_t i = (b % batches_per_slice) * lanes;
+            lines_fn(g.data() + o * n * inner + i, inner, std::min(lanes, inner - i));
+        }
+    });
+}
+
+template <typename Op, int N, typename T, typename Allocator, typename DstAllocator>
+void SeparableFilter(
+    const grid<N, T, row_major, Allocator>& src,
+    grid<N, T, row_major, DstAllocator>& dst,
+    const size_t* radii,
+    thread_pool& pool)
+{
+    if ((const void*)&src != (const void*)&dst) {
+        ResizeLike(src, dst);
+        std::copy(src.data(), src.data() + src.total_size(), dst.data());
+    }
+    if (dst.total_size() == 0) {
+        return;
+    }
+
+    for (int dim = N - 1; dim >= 0; --dim) {
+        if (radii[dim] != 0) {
+            VanHerkPass<Op>(dst, dim, radii[dim], pool);
+        }
+    }
+}
+
+template <int N, typename T, typename Allocator, typename DstAllocator>
+void dilate(
+    const grid<N, T, row_major, Allocator>& src,
+    grid<N, T, row_major, DstAllocator>& dst,
+    const size_t* radii,
+    thread_pool& pool)
+{
+    SeparableFilter<MaxFilterOp<T>>(src, dst, radii, pool);
+}
+
+template <int N, typename T, typename Allocator, typename DstAllocator>
+void erode(
+    const grid<N, T, row_major, Allocator>& src,
+    grid<N, T, row_major, DstAllocator>& dst,
+    const size_t* radii,
+    thread_pool& pool)
+{
+    SeparableFilter<MinFilterOp<T>>(src, dst, radii, pool);
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void inflate(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    Predicate is_obstacle,
+    thread_pool& pool)
+{
+    grid<N, float> d;
+    squared_distance_transform(src, d, is_obstacle, pool);
+    ResizeLike(src, dst);
+
+    const float r2 = (float)(radius * radius);
+    ParallelForRange(pool, d.total_size(), [&](size_t first, size_t last)
+    {
+        const float* s = d.data();
+        uint8_t* o = dst.data();
+        for (size_t k = first; k < last; ++k) {
+            o[k] = s[k] <= r2;
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void inflate(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    thread_pool& pool)
+{
+    inflate(src, dst, radius, NonDefaultValue<T>(), pool);
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void inflate_region(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Predicate is_obstacle)
+{
+    // the cells whose inflation may have changed are those within radius of
+    // the box, and the obstacles that decide them are within radius of those
+    const size_t r = (size_t)std::ceil(radius);
+    grid_index<N, T> out_start;
+    grid_index<N, T> out_end;
+    grid_index<N, T> in_start;
+    grid_index<N, T> in_end;
+    size_t in_dims[N];
+    for (int i = 0; i < N; ++i) {
+        const size_t last = src.size(i) - 1;
+        out_start(i) = start(i) > r ? start(i) - r : 0;
+        out_end(i) = std::min(end(i) + r, last);
+        in_start(i) = start(i) > 2 * r ? start(i) - 2 * r : 0;
+        in_end(i) = std::min(end(i) + 2 * r, last);
+        in_dims[i] = in_end(i) - in_start(i) + 1;
+    }
+
+    // obstacles of the surrounding region, relative to in_start
+    grid<N, uint8_t> local;
+    ResizeDiscard(local, in_dims);
+    uint8_t* l = local.data();
+    ForEachRun(in_start, in_end, N - 1, [&](const grid_index<N, T>& row, size_t len)
+    {
+        grid_index<N, T> i = row;
+        size_t offset = 0;
+        for (int d = 0; d < N; ++d) {
+            offset += (row(d) - in_start(d)) * local.stride(d);
+        }
+        for (size_t k = 0; k < len; ++k, ++i(N - 1)) {
+            l[offset + k] = is_obstacle(src(i)) ? 1 : 0;
+        }
+    });
+
+    grid<N, float> d;
+    thread_pool serial(1);
+    squared_distance_transform(local, d, NonDefaultValue<uint8_t>(), serial);
+
+    const float r2 = (float)(radius * radius);
+    ForEachRun(out_start, out_end, N - 1, [&](const grid_index<N, T>& row, size_t len)
+    {
+        size_t local_offset = 0;
+        for (int i = 0; i < N; ++i) {
+            local_offset += (row(i) - in_start(i)) * d.stride(i);
+        }
+        uint8_t* o = dst.data() + StrideOffset(dst, row);
+        const float* s = d.data() + local_offset;
+        for (size_t k = 0; k < len; ++k) {
+            o[k] = s[k] <= r2;
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void inflate_region(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end)
+{
+    inflate_region(src, dst, radius, start, end, NonDefaultValue<T>());
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,343 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_grid_parallel_h
+#define au_detail_grid_parallel_h
+
+#include "../parallel.h"
+
+// standard includes
+#include <algorithm>
+
+namespace au
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// thread_pool Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+// true on threads that are currently executing a parallel_for body
+inline bool& InParallelRegion()
+{
+    static thread_local bool in_region = false;
+    return in_region;
+}
+
+inline thread_pool::thread_pool(size_t num_threads) :
+    stop_(false),
+    generation_(0),
+    busy_(0),
+    job_(nullptr),
+    job_count_(0),
+    next_(0)
+{
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers_.push_back(std::thread(&thread_pool::worker_loop, this));
+    }
+}
+
+inline thread_pool::~thread_pool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+inline void thread_pool::parallel_for(
+    size_t count,
+    const std::function<void(size_t)>& fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (workers_.empty() || count == 1 || InParallelRegion()) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> submit_lock(submit_mutex_);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_ = &fn;
+        job_count_ = count;
+        next_ = 0;
+        error_ = nullptr;
+        ++generation_;
+    }
+    work_cv_.notify_all();
+
+    run_tasks(&fn, count);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&]() { return busy_ == 0; });
+        job_ = nullptr;
+        job_count_ = 0;
+        std::swap(error, error_);
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+inline void thread_pool::worker_loop()
+{
+    unsigned long long seen = 0;
+    while (true) {
+        const std::function<void(size_t)>* job;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            // a worker that wakes up after the submitter has retired the job
+            // must not touch next_, which the next job may already be using
+            if (!job_) {
+                continue;
+            }
+            // the submitter cannot retire the job while this worker is busy
+            job = job_;
+            count = job_count_;
+            ++busy_;
+        }
+
+        run_tasks(job, count);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_cv_.notify_all();
+            }
+        }
+    }
+}
+
+inline void thread_pool::run_tasks(
+    const std::function<void(size_t)>* job,
+    size_t count)
+{
+    InParallelRegion() = true;
+    size_t i;
+    while ((i = next_++) < count) {
+        try {
+            (*job)(i);
+        }
+        catch (...) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+    InParallelRegion() = false;
+}
+
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parallel Algorithms Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+/// Call fn(first, last) for consecutive chunks [first, last) of [0, n) on the
+/// threads of pool.
+template <typename Function>
+void ParallelForRange(thread_pool& pool, size_t n, Function fn)
+{
+    const size_t chunks = std::min<size_t>(n, 4 * pool.size());
+    pool.parallel_for(chunks, [&](size_t c)
+    {
+        fn(n * c / chunks, n * (c + 1) / chunks);
+    });
+}
+
+template <int N, typename T>
+size_t NumSlabs(
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    const thread_pool& pool)
+{
+    // a few slabs per thread to even out the load
+    return std::min<size_t>(end(0) - start(0) + 1, 4 * pool.size());
+}
+
+/// Call fn(s, slab_start, slab_end) for each of the slabs of the box
+/// [start, end] along dimension 0, on the threads of pool.
+template <int N, typename T, typename Function>
+void ForEachSlab(
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    thread_pool& pool,
+    Function fn)
+{
+    typedef typename grid_index<N, T>::size_type size_type;
+
+    const size_type extent = end(0) - start(0) + 1;
+    const size_type num_slabs = NumSlabs(start, end, pool);
+
+    pool.parallel_for(num_slabs, [&](size_t s)
+    {
+        grid_index<N, T> slab_start = start;
+        grid_index<N, T> slab_end = end;
+        slab_start(0) = start(0) + extent * s / num_slabs;
+        slab_end(0) = start(0) + extent * (s + 1) / num_slabs - 1;
+        fn(s, slab_start, slab_end);
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void ForEachIndex(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn,
+    std::true_type contiguous_rows)
+{
+    typedef typename grid<N, T, Layout, Allocator>::size_type size_type;
+    ForEachRun(start, end, N - 1, [&](const grid_index<N, T>& row, size_type len)
+    {
+        grid_index<N, T> i = row;
+        T* p = g.data() + StrideOffset(g, row);
+        for (size_type k = 0; k < len; ++k, ++i(N - 1)) {
+            fn(const_cast<const grid_index<N, T>&>(i), p[k]);
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void ForEachIndex(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn,
+    std::false_type contiguous_rows)
+{
+    typedef typename grid<N, T, Layout, Allocator>::size_type size_type;
+    ForEachRun(start, end, N - 1, [&](const grid_index<N, T>& row, size_type len)
+    {
+        grid_index<N, T> i = row;
+        for (size_type k = 0; k < len; ++k, ++i(N - 1)) {
+            fn(const_cast<const grid_index<N, T>&>(i), g(i));
+        }
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void parallel_for_each(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn,
+    thread_pool& pool)
+{
+    if (g.total_size() == 0) {
+        return;
+    }
+    ForEachSlab(start, end, pool, [&](size_t, const grid_index<N, T>& s, const grid_index<N, T>& e)
+    {
+        ForEachIndex(g, s, e, fn,
+                std::integral_constant<bool, Layout::contiguous_rows>());
+    });
+}
+
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void parallel_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op,
+    thread_pool& pool)
+{
+    if (src.total_size() == 0 || dst.total_size() == 0) {
+        return;
+    }
+    ForEachSlab(start, end, pool, [&](size_t, const grid_index<N, T>& s, const grid_index<N, T>& e)
+    {
+        transform(src, dst, s, e, op);
+    });
+}
+
+template <int N, typename T, typename Layout, typename Allocator, typename R, typename BinaryOperation>
+R parallel_reduce(
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    R identity,
+    BinaryOperation op,
+    thread_pool& pool)
+{
+    if (g.total_size() == 0) {
+        return identity;
+    }
+
+    // reads only; ForEachIndex is written for mutable grids
+    grid<N, T, Layout, Allocator>& mg = const_cast<grid<N, T, Layout, Allocator>&>(g);
+
+    // wrapped so that slabs never share a std::vector<bool> word
+    struct partial_result { R value; };
+    std::vector<partial_result> partial(NumSlabs(start, end, pool), partial_result{ identity });
+    ForEachSlab(start, end, pool, [&](size_t slab, const grid_index<N, T>& s, const grid_index<N, T>& e)
+    {
+        R acc = identity;
+        ForEachIndex(mg, s, e, [&](const grid_index<N, T>&, const T& value)
+        {
+            acc = op(acc, value);
+        },
+        std::integral_constant<bool, Layout::contiguous_rows>());
+        partial[slab].value = acc;
+    });
+
+    R result = identity;
+    for (size_t i = 0; i < partial.size(); ++i) {
+        result = op(result, partial[i].value);
+    }
+    return result;
+}
+
+} // namespace au
+
+#endif
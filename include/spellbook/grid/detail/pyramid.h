@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_pyramid_h
+#define au_detail_pyramid_h
+
+#include "../pyramid.h"
+
+// standard includes
+#include <assert.h>
+#include <algorithm>
+
+namespace au
+{
+
+template <int N, typename T, typename Compare>
+grid_pyramid<N, T, Compare>::grid_pyramid() :
+    levels_(1),
+    comp_()
+{
+}
+
+template <int N, typename T, typename Compare>
+template <typename... SizeTypes>
+grid_pyramid<N, T, Compare>::grid_pyramid(SizeTypes... sizes) :
+    levels_(),
+    comp_()
+{
+    levels_.emplace_back(sizes...);
+    allocate_levels();
+    rebuild();
+}
+
+template <int N, typename T, typename Compare>
+grid_pyramid<N, T, Compare>::grid_pyramid(
+    const grid_type& base,
+    const Compare& comp)
+:
+    levels_(1, base),
+    comp_(comp)
+{
+    allocate_levels();
+    rebuild();
+}
+
+template <int N, typename T, typename Compare>
+T grid_pyramid<N, T, Compare>::reduce(const index& start, const index& end) const
+{
+    const size_type root[N] = { 0 };
+    T best = T();
+    bool found = false;
+    reduce(levels_.size() - 1, root, start, end, best, found);
+    return best;
+}
+
+template <int N, typename T, typename Compare>
+bool grid_pyramid<N, T, Compare>::any_at_least(
+    const index& start,
+    const index& end,
+    const T& value) const
+{
+    const size_type root[N] = { 0 };
+    return any_at_least(levels_.size() - 1, root, start, end, value);
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::assign(const grid_type& base)
+{
+    levels_.resize(1);
+    levels_[0] = base;
+    allocate_levels();
+    rebuild();
+}
+
+template <int N, typename T, typename Compare>
+template <typename... SizeTypes>
+void grid_pyramid<N, T, Compare>::resize(SizeTypes... sizes)
+{
+    levels_.resize(1);
+    levels_[0].clear();
+    levels_[0].resize(sizes...);
+    allocate_levels();
+    rebuild();
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::update(const index& start, const index& end)
+{
+    index s = start;
+    index e = end;
+    for (size_type k = 1; k < levels_.size(); ++k) {
+        for (int d = 0; d < N; ++d) {
+            s(d) >>= 1;
+            e(d) >>= 1;
+        }
+        pool(k, s, e);
+    }
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::rebuild()
+{
+    for (size_type k = 1; k < levels_.size(); ++k) {
+        index s;
+        index e;
+        for (int d = 0; d < N; ++d) {
+            s(d) = 0;
+            e(d) = levels_[k].size(d) - 1;
+        }
+        pool(k, s, e);
+    }
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::allocate_levels()
+{
+    if (!levels_[0].data()) {
+        return;
+    }
+
+    size_type dims[N];
+    for (int d = 0; d < N; ++d) {
+        dims[d] = levels_[0].size(d);
+    }
+
+    for (;;) {
+        bool coarsest = true;
+        for (int d = 0; d < N; ++d) {
+            coarsest &= dims[d] == 1;
+        }
+        if (coarsest) {
+            break;
+        }
+        for (int d = 0; d < N; ++d) {
+            dims[d] = (dims[d] + 1) / 2;
+        }
+        levels_.emplace_back();
+        ResizeDiscard(levels_.back(), dims);
+    }
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::pool(size_type k, const index& start, const index& end)
+{
+    const grid_type& fine = levels_[k - 1];
+    grid_type& coarse = levels_[k];
+
+    ForEachRun(start, end, N - 1, [&](const index& row, size_type len)
+    {
+        index c = row;
+        for (size_type x = 0; x < len; ++x, ++c(N - 1)) {
+            // visit the children of c, skipping those beyond the edges of
+            // the finer level
+            bool found = false;
+            T best = T();
+            for (unsigned bits = 0; bits < (1u << N); ++bits) {
+                index f;
+                bool inside = true;
+                for (int d = 0; d < N; ++d) {
+                    f(d) = 2 * c(d) + ((bits >> (N - 1 - d)) & 1);
+                    inside &= f(d) < fine.size(d);
+                }
+                if (!inside) {
+                    continue;
+                }
+                const T& v = fine(f);
+                if (!found || comp_(best, v)) {
+                    best = v;
+                    found = true;
+                }
+            }
+            coarse(c) = best;
+        }
+    });
+}
+
+template <int N, typename T, typename Compare>
+void grid_pyramid<N, T, Compare>::reduce(
+    size_type k,
+    const size_type* c,
+    const index& start,
+    const index& end,
+    T& best,
+    bool& found) const
+{
+    // the base-level box covered by c, clipped to the base grid
+    bool inside = true;
+    for (int d = 0; d < N; ++d) {
+        const size_type lo = c[d] << k;
+        const size_type hi = std::min(((c[d] + 1) << k) - 1, levels_[0].size(d) - 1);
+        if (lo > end(d) || hi < start(d)) {
+            return;
+        }
+        inside &= lo >= start(d) && hi <= end(d);
+    }
+
+    index i;
+    for (int d = 0; d < N; ++d) {
+        i(d) = c[d];
+    }
+    const T& v = levels_[k](i);
+
+    // nothing below c can improve on the current best
+    if (found && !comp_(best, v)) {
+        return;
+    }
+
+    if (inside || k == 0) {
+        best = v;
+        found = true;
+        return;
+    }
+
+    const grid_type& fine = levels_[k - 1];
+    for (unsigned bits = 0; bits < (1u << N); ++bits) {
+        size_type f[N];
+        bool valid = true;
+        for (int d = 0; d < N; ++d) {
+            f[d] = 2 * c[d] + ((bits >> (N - 1 - d)) & 1);
+            valid &= f[d] < fine.size(d);
+        }
+        if (valid) {
+            reduce(k - 1, f, start, end, best, found);
+        }
+    }
+}
+
+template <int N, typename T, typename Compare>
+bool grid_pyramid<N, T, Compare>::any_at_least(
+    size_type k,
+    const size_type* c,
+    const index& start,
+    const index& end,
+    const T& value) const
+{
+    bool inside = true;
+    for (int d = 0; d < N; ++d) {
+        const size_type lo = c[d] << k;
+        const size_type hi = std::min(((c[d] + 1) << k) - 1, levels_[0].size(d) - 1);
+        if (lo > end(d) || hi < start(d)) {
+            return false;
+        }
+        inside &= lo >= start(d) && hi <= end(d);
+    }
+
+    index i;
+    for (int d = 0; d < N; ++d) {
+        i(d) = c[d];
+    }
+    if (comp_(levels_[k](i), value)) {
+        return false;
+    }
+    if (inside || k == 0) {
+        return true;
+    }
+
+    const grid_type& fine = levels_[k - 1];
+    for (unsigned bits = 0; bits < (1u << N); ++bits) {
+        size_type f[N];
+        bool valid = true;
+        for (int d = 0; d < N; ++d) {
+            f[d] = 2 * c[d] + ((bits >> (N - 1 - d)) & 1);
+            valid &= f[d] < fine.size(d);
+        }
+        if (valid && any_at_least(k - 1, f, start, end, value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace au
+
+#endif
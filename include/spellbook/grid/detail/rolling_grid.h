@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_rolling_grid_h
+#define au_detail_rolling_grid_h
+
+#include "../rolling_grid.h"
+
+// standard includes
+#include <assert.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+
+namespace au
+{
+
+template <int N, typename T, typename Allocator>
+rolling_grid<N, T, Allocator>::rolling_grid() :
+    storage_(),
+    background_(),
+    resolution_(1.0)
+{
+    std::fill(origin_, origin_ + N, 0);
+    std::fill(head_, head_ + N, 0);
+}
+
+template <int N, typename T, typename Allocator>
+template <typename... SizeTypes>
+rolling_grid<N, T, Allocator>::rolling_grid(SizeTypes... sizes) :
+    storage_(sizes...),
+    background_(),
+    resolution_(1.0)
+{
+    std::fill(origin_, origin_ + N, 0);
+    std::fill(head_, head_ + N, 0);
+}
+
+template <int N, typename T, typename Allocator>
+template <typename... CoordTypes>
+auto rolling_grid<N, T, Allocator>::operator()(CoordTypes... coords)
+    -> typename std::enable_if<AllArithmetic<CoordTypes...>::value, reference>::type
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const ptrdiff_t c[N] = { (ptrdiff_t)coords... };
+    return storage_.data()[storage_offset(c)];
+}
+
+template <int N, typename T, typename Allocator>
+template <typename... CoordTypes>
+auto rolling_grid<N, T, Allocator>::operator()(CoordTypes... coords) const
+    -> typename std::enable_if<AllArithmetic<CoordTypes...>::value, const_reference>::type
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const ptrdiff_t c[N] = { (ptrdiff_t)coords... };
+    return storage_.data()[storage_offset(c)];
+}
+
+template <int N, typename T, typename Allocator>
+template <typename... CoordTypes>
+auto rolling_grid<N, T, Allocator>::within_bounds(CoordTypes... coords) const
+    -> typename std::enable_if<AllArithmetic<CoordTypes...>::value, bool>::type
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
+    const ptrdiff_t c[N] = { (ptrdiff_t)coords... };
+    return within_bounds(c);
+}
+
+template <int N, typename T, typename Allocator>
+bool rolling_grid<N, T, Allocator>::within_bounds(const ptrdiff_t* c) const
+{
+    for (int i = 0; i < N; ++i) {
+        if (c[i] < origin_[i] || c[i] - origin_[i] >= (ptrdiff_t)size(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::world_to_cell(const double* p, ptrdiff_t* c) const
+{
+    for (int i = 0; i < N; ++i) {
+        c[i] = (ptrdiff_t)std::floor(p[i] / resolution_);
+    }
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::cell_to_world(const ptrdiff_t* c, double* p) const
+{
+    for (int i = 0; i < N; ++i) {
+        p[i] = ((double)c[i] + 0.5) * resolution_;
+    }
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::shift(
+    const ptrdiff_t* delta,
+    std::vector<box>* invalidated)
+{
+    if (!storage_.data()) {
+        for (int i = 0; i < N; ++i) {
+            origin_[i] += delta[i];
+        }
+        return;
+    }
+
+    // the new window, which shrinks along each dimension as the cells
+    // entering along that dimension are split off, so that the boxes are
+    // disjoint
+    box rest;
+    bool moved = false;
+    bool replaced = false;
+    for (int i = 0; i < N; ++i) {
+        rest.min[i] = origin_[i] + delta[i];
+        rest.max[i] = rest.min[i] + (ptrdiff_t)size(i) - 1;
+        moved |= delta[i] != 0;
+        replaced |= std::abs(delta[i]) >= (ptrdiff_t)size(i);
+    }
+
+    if (!moved) {
+        return;
+    }
+
+    box entering[N];
+    int num_entering = 0;
+    if (replaced) {
+        entering[num_entering++] = rest;
+    }
+    else {
+        for (int i = 0; i < N; ++i) {
+            if (delta[i] == 0) {
+                continue;
+            }
+            box& b = entering[num_entering++];
+            b = rest;
+            if (delta[i] > 0) {
+                b.min[i] = rest.max[i] - delta[i] + 1;
+                rest.max[i] = b.min[i] - 1;
+            }
+            else {
+                b.max[i] = rest.min[i] - delta[i] - 1;
+                rest.min[i] = b.max[i] + 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < N; ++i) {
+        const ptrdiff_t n = (ptrdiff_t)size(i);
+        head_[i] = (size_type)((((ptrdiff_t)head_[i] + delta[i]) % n + n) % n);
+        origin_[i] += delta[i];
+    }
+
+    for (int k = 0; k < num_entering; ++k) {
+        fill_box(entering[k]);
+        if (invalidated) {
+            invalidated->push_back(entering[k]);
+        }
+    }
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::shift_to(
+    const ptrdiff_t* origin,
+    std::vector<box>* invalidated)
+{
+    ptrdiff_t delta[N];
+    for (int i = 0; i < N; ++i) {
+        delta[i] = origin[i] - origin_[i];
+    }
+    shift(delta, invalidated);
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::recenter(
+    const double* p,
+    std::vector<box>* invalidated)
+{
+    ptrdiff_t origin[N];
+    world_to_cell(p, origin);
+    for (int i = 0; i < N; ++i) {
+        origin[i] -= (ptrdiff_t)(size(i) / 2);
+    }
+    shift_to(origin, invalidated);
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::clear()
+{
+    storage_.clear();
+    std::fill(head_, head_ + N, 0);
+}
+
+template <int N, typename T, typename Allocator>
+template <typename... SizeTypes>
+void rolling_grid<N, T, Allocator>::resize(SizeTypes... sizes)
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to resize");
+    const size_type dims[N] = { (size_type)sizes... };
+    ResizeDiscard(storage_, dims);
+    storage_.assign(background_);
+    std::fill(head_, head_ + N, 0);
+}
+
+template <int N, typename T, typename Allocator>
+auto rolling_grid<N, T, Allocator>::storage_offset(const ptrdiff_t* c) const
+    -> size_type
+{
+    assert(within_bounds(c));
+    size_type offset = 0;
+    for (int i = 0; i < N; ++i) {
+        size_type s = (size_type)(c[i] - origin_[i]) + head_[i];
+        if (s >= size(i)) {
+            s -= size(i);
+        }
+        offset += s * storage_.stride(i);
+    }
+    return offset;
+}
+
+template <int N, typename T, typename Allocator>
+void rolling_grid<N, T, Allocator>::fill_box(const box& b)
+{
+    // storage coordinates of the box's first cell, and the box's extents
+    size_type start[N];
+    size_type len[N];
+    for (int i = 0; i < N; ++i) {
+        start[i] = (size_type)(b.min[i] - origin_[i]) + head_[i];
+        if (start[i] >= size(i)) {
+            start[i] -= size(i);
+        }
+        len[i] = (size_type)(b.max[i] - b.min[i] + 1);
+    }
+
+    // the box's rows wrap around the end of the storage row at most once
+    const size_type first_run = std::min(len[N - 1], size(N - 1) - start[N - 1]);
+    const size_type second_run = len[N - 1] - first_run;
+
+    T* data = storage_.data();
+    size_type s[N];
+    size_type count[N];
+    std::copy(start, start + N, s);
+    std::fill(count, count + N, 0);
+    for (;;) {
+        size_type row = 0;
+        for (int i = 0; i < N - 1; ++i) {
+            row += s[i] * storage_.stride(i);
+        }
+        std::fill(data + row + start[N - 1], data + row + start[N - 1] + first_run, background_);
+        std::fill(data + row, data + row + second_run, background_);
+
+        int i = N - 2;
+        for (; i >= 0; --i) {
+            if (++count[i] < len[i]) {
+                if (++s[i] == size(i)) {
+                    s[i] = 0;
+                }
+                break;
+            }
+            count[i] = 0;
+            s[i] = start[i];
+        }
+        if (i < 0) {
+            break;
+        }
+    }
+}
+
+} // namespace au
+
+#endif
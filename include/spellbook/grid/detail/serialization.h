@@ -0,0 +1,680 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_grid_serialization_h
+#define au_detail_grid_serialization_h
+
+#include "../serialization.h"
+
+// standard includes
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <new>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace au
+{
+
+static const char GridSnapshotMagic[8] = { 'A', 'U', 'G', 'R', 'I', 'D', 'S', '\0' };
+static const uint32_t GridSnapshotVersion = 1;
+static const uint32_t GridSnapshotByteOrder = 0x01020304;
+
+struct GridSnapshotHeader
+{
+    char        magic[8];
+    uint32_t    byte_order;
+    uint32_t    version;
+    uint32_t    num_dims;
+    uint32_t    element_kind;
+    uint32_t    element_size;
+    uint32_t    reserved;
+    uint64_t    slab_rows;      // rows of the outermost dimension per chunk
+    // followed by num_dims uint64_t sizes
+};
+
+enum GridChunkEncoding : uint32_t
+{
+    GridChunkRaw = 0,
+    GridChunkRLE = 1
+};
+
+struct GridChunkHeader
+{
+    uint32_t    encoding;
+    uint32_t    crc;            // CRC-32 of the decoded element bytes
+    uint64_t    raw_size;
+    uint64_t    stored_size;
+};
+
+/// Identifies the kind of element stored in a snapshot, in addition to its
+/// size, so that e.g. float and int32_t snapshots are not confused.
+template <typename T>
+struct GridElementKind
+{
+    static const uint32_t value =
+            std::is_same<T, bool>::value ? 4 :
+            std::is_floating_point<T>::value ? 3 :
+            std::is_integral<T>::value ? (std::is_signed<T>::value ? 2 : 1) :
+            0; // other trivially copyable types
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// CRC-32
+////////////////////////////////////////////////////////////////////////////////
+
+struct Crc32Table
+{
+    uint32_t t[8][256];
+
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int s = 1; s < 8; ++s) {
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+/// CRC-32 (IEEE 802.3) of a buffer, computed eight bytes at a time.
+inline uint32_t Crc32(const void* data, size_t len, uint32_t crc = 0)
+{
+    static const Crc32Table table;
+    const uint32_t (&t)[8][256] = table.t;
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (len >= 8) {
+        const uint32_t a = crc ^
+                ((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                 (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^
+              t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Run-length encoding
+////////////////////////////////////////////////////////////////////////////////
+
+// Elements are encoded as a sequence of tokens, each a LEB128 varint
+// (length << 1 | is_run) followed by one element for a run or length elements
+// for a literal sequence.
+
+inline void PutVarint(std::vector<char>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+inline bool GetVarint(const char*& p, const char* end, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        const unsigned char b = (unsigned char)*p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void RleEncode(const T* src, size_t count, std::vector<char>& out)
+{
+    // runs shorter than this are cheaper as part of a literal
+    const size_t min_run = sizeof(T) == 1 ? 4 : 2;
+
+    out.clear();
+    size_t literal = 0;
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && memcmp(&src[i + run], &src[i], sizeof(T)) == 0) {
+            ++run;
+        }
+        if (run < min_run) {
+            i += run;
+            continue;
+        }
+        if (literal < i) {
+            PutVarint(out, (uint64_t)(i - literal) << 1);
+            out.insert(out.end(), (const char*)&src[literal], (const char*)&src[i]);
+        }
+        PutVarint(out, (uint64_t)run << 1 | 1);
+        out.insert(out.end(), (const char*)&src[i], (const char*)&src[i + 1]);
+        i += run;
+        literal = i;
+    }
+    if (literal < count) {
+        PutVarint(out, (uint64_t)(count - literal) << 1);
+        out.insert(out.end(), (const char*)&src[literal], (const char*)&src[count]);
+    }
+}
+
+template <typename T>
+bool RleDecode(const char* p, size_t size, T* dst, size_t count)
+{
+    const char* end = p + size;
+    size_t i = 0;
+    while (p != end) {
+        uint64_t token;
+        if (!GetVarint(p, end, token)) {
+            return false;
+        }
+        const uint64_t len = token >> 1;
+        if (len > count - i) {
+            return false;
+        }
+        if (token & 1) {
+            if ((size_t)(end - p) < sizeof(T)) {
+                return false;
+            }
+            if (sizeof(T) == 1) {
+                memset(&dst[i], *p, len);
+            }
+            else {
+                memcpy(&dst[i], p, sizeof(T));
+                for (uint64_t k = 1; k < len; ++k) {
+                    memcpy(&dst[i + k], p, sizeof(T));
+                }
+            }
+            p += sizeof(T);
+        }
+        else {
+            if ((uint64_t)(end - p) < len * sizeof(T)) {
+                return false;
+            }
+            memcpy(&dst[i], p, len * sizeof(T));
+            p += len * sizeof(T);
+        }
+        i += len;
+    }
+    return i == count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Chunk I/O
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+bool WriteChunk(
+    std::ostream& os,
+    const T* src,
+    size_t count,
+    bool compress,
+    std::vector<char>& encoded)
+{
+    GridChunkHeader h;
+    h.encoding = GridChunkRaw;
+    h.raw_size = count * sizeof(T);
+    h.stored_size = h.raw_size;
+    h.crc = Crc32(src, h.raw_size);
+
+    if (compress) {
+        RleEncode(src, count, encoded);
+        if (encoded.size() < h.raw_size) {
+            h.encoding = GridChunkRLE;
+            h.stored_size = encoded.size();
+        }
+    }
+
+    os.write((const char*)&h, sizeof(h));
+    if (h.encoding == GridChunkRLE) {
+        os.write(encoded.data(), encoded.size());
+    }
+    else {
+        os.write((const char*)src, h.raw_size);
+    }
+    return os.good();
+}
+
+/// Check the sizes in a chunk header against the number of bytes the chunk
+/// should decode to.
+inline bool ValidChunkSizes(const GridChunkHeader& h, size_t raw_size)
+{
+    if (h.raw_size != raw_size) {
+        return false;
+    }
+    if (h.encoding == GridChunkRaw) {
+        return h.stored_size == h.raw_size;
+    }
+    if (h.encoding == GridChunkRLE) {
+        // the writer only stores chunks as RLE when that is smaller, which
+        // also bounds the buffer a corrupt size could make us allocate
+        return h.stored_size != 0 && h.stored_size < h.raw_size;
+    }
+    return false;
+}
+
+/// Read and decode the elements of a chunk whose header has already been
+/// read.
+template <typename T>
+bool ReadChunk(
+    std::istream& is,
+    const GridChunkHeader& h,
+    T* dst,
+    size_t count,
+    std::vector<char>& encoded)
+{
+    if (!ValidChunkSizes(h, count * sizeof(T))) {
+        return false;
+    }
+
+    if (h.encoding == GridChunkRaw) {
+        if (!is.read((char*)dst, h.raw_size)) {
+            return false;
+        }
+    }
+    else {
+        encoded.resize(h.stored_size);
+        if (!is.read(encoded.data(), h.stored_size) ||
+            !RleDecode(encoded.data(), encoded.size(), dst, count))
+        {
+            return false;
+        }
+    }
+
+    return Crc32(dst, h.raw_size) == h.crc;
+}
+
+/// Skip over the data of a chunk whose header has already been read.
+template <typename T>
+bool SkipChunk(std::istream& is, const GridChunkHeader& h, size_t count)
+{
+    if (!ValidChunkSizes(h, count * sizeof(T))) {
+        return false;
+    }
+
+    const std::streampos pos = is.tellg();
+    if (pos != std::streampos(-1)) {
+        // seeking past the end may succeed, so check against the remaining
+        // length of the stream first
+        if (!is.seekg(0, std::ios_base::end)) {
+            return false;
+        }
+        const std::streamoff remaining = is.tellg() - pos;
+        if (remaining < 0 || h.stored_size > (uint64_t)remaining) {
+            return false;
+        }
+        return (bool)is.seekg(pos + (std::streamoff)h.stored_size);
+    }
+
+    // not seekable
+    is.clear();
+    is.ignore((std::streamsize)h.stored_size);
+    return is.good() && is.gcount() == (std::streamsize)h.stored_size;
+}
+
+template <int N, typename T>
+bool ReadSnapshotHeader(std::istream& is, GridSnapshotHeader& h, size_t* dims)
+{
+    if (!is.read((char*)&h, sizeof(h)) ||
+        memcmp(h.magic, GridSnapshotMagic, sizeof(GridSnapshotMagic)) != 0 ||
+        h.byte_order != GridSnapshotByteOrder ||
+        h.version != GridSnapshotVersion ||
+        h.num_dims != (uint32_t)N ||
+        h.element_kind != GridElementKind<T>::value ||
+        h.element_size != (uint32_t)sizeof(T) ||
+        h.slab_rows == 0)
+    {
+        return false;
+    }
+
+    uint64_t sizes[N];
+    if (!is.read((char*)sizes, sizeof(sizes))) {
+        return false;
+    }
+
+    // reject sizes whose element count would overflow or could never be
+    // allocated, rather than failing in the grid's allocation
+    const size_t max_count = std::numeric_limits<size_t>::max() / sizeof(T);
+    bool empty = false;
+    for (int i = 0; i < N; ++i) {
+        if (sizes[i] > max_count) {
+            return false;
+        }
+        dims[i] = (size_t)sizes[i];
+        empty |= (dims[i] == 0);
+    }
+    size_t total = 1;
+    for (int i = 0; !empty && i < N; ++i) {
+        if (total > max_count / dims[i]) {
+            return false;
+        }
+        total *= dims[i];
+    }
+    return true;
+}
+
+/// Copy the elements of the slab [r0, r0 + rows) of a grid into a row-major
+/// buffer, or return a pointer to them if the grid is row-major.
+template <int N, typename T, typename Layout, typename Allocator>
+const T* GatherSlab(
+    const grid<N, T, Layout, Allocator>& g,
+    size_t r0,
+    size_t rows,
+    std::vector<T>& buffer)
+{
+    if (std::is_same<Layout, row_major>::value) {
+        // row-major storage is laid out exactly as in the snapshot
+        return g.data() + r0 * (g.total_size() / g.size(0));
+    }
+
+    grid_index<N, T> start;
+    grid_index<N, T> end;
+    start(0) = r0;
+    end(0) = r0 + rows - 1;
+    for (int i = 1; i < N; ++i) {
+        end(i) = g.size(i) - 1;
+    }
+    buffer.assign(g.gbegin(start, end), g.gend(start, end));
+    return buffer.data();
+}
+
+/// Copy len elements of a row of the snapshot to the grid, starting at index
+/// i and advancing along the innermost dimension.
+template <int N, typename T, typename Layout, typename Allocator>
+void StoreRow(
+    grid<N, T, Layout, Allocator>& g,
+    grid_index<N, T> i,
+    const T* src,
+    size_t len,
+    std::true_type contiguous_rows)
+{
+    memcpy(&g(i), src, len * sizeof(T));
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+void StoreRow(
+    grid<N, T, Layout, Allocator>& g,
+    grid_index<N, T> i,
+    const T* src,
+    size_t len,
+    std::false_type contiguous_rows)
+{
+    for (size_t k = 0; k < len; ++k, ++i(N - 1)) {
+        g(i) = src[k];
+    }
+}
+
+/// Copy the part of the box [start, end] within the decoded slab
+/// [r0, r0 + rows) of a snapshot of size dims to g, whose origin corresponds
+/// to start.
+template <int N, typename T, typename Layout, typename Allocator>
+void StoreSlabRegion(
+    grid<N, T, Layout, Allocator>& g,
+    const T* slab,
+    const size_t* dims,
+    size_t r0,
+    size_t rows,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end)
+{
+    size_t strides[N];
+    strides[N - 1] = 1;
+    for (int i = N - 2; i >= 0; --i) {
+        strides[i] = strides[i + 1] * dims[i + 1];
+    }
+
+    grid_index<N, T> s = start;
+    grid_index<N, T> e = end;
+    s(0) = std::max<size_t>(start(0), r0);
+    e(0) = std::min<size_t>(end(0), r0 + rows - 1);
+
+    ForEachRun(s, e, N - 1, [&](const grid_index<N, T>& i, size_t len)
+    {
+        size_t off = (i(0) - r0) * strides[0];
+        grid_index<N, T> j;
+        for (int d = 0; d < N; ++d) {
+            if (d > 0) {
+                off += i(d) * strides[d];
+            }
+            j(d) = i(d) - start(d);
+        }
+        StoreRow(g, j, slab + off, len,
+                std::integral_constant<bool, Layout::contiguous_rows>());
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Serialization Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool write_grid(
+    std::ostream& os,
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_write_options& options)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "write_grid requires a trivially copyable element type");
+
+    const size_t total = g.total_size();
+    const size_t row_size = total ? total / g.size(0) : 0;
+    const size_t row_bytes = row_size * sizeof(T);
+
+    GridSnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, GridSnapshotMagic, sizeof(GridSnapshotMagic));
+    h.byte_order = GridSnapshotByteOrder;
+    h.version = GridSnapshotVersion;
+    h.num_dims = N;
+    h.element_kind = GridElementKind<T>::value;
+    h.element_size = sizeof(T);
+    h.slab_rows = row_bytes ? std::max<size_t>(1, options.chunk_size / row_bytes) : 1;
+
+    uint64_t sizes[N];
+    for (int i = 0; i < N; ++i) {
+        sizes[i] = total ? g.size(i) : 0;
+    }
+
+    os.write((const char*)&h, sizeof(h));
+    os.write((const char*)sizes, sizeof(sizes));
+
+    std::vector<T> buffer;
+    std::vector<char> encoded;
+    for (size_t r0 = 0; total && r0 < g.size(0); r0 += h.slab_rows) {
+        const size_t rows = std::min<size_t>(h.slab_rows, g.size(0) - r0);
+        const T* src = GatherSlab(g, r0, rows, buffer);
+        if (!WriteChunk(os, src, rows * row_size, options.compress, encoded)) {
+            return false;
+        }
+    }
+    return os.good();
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool read_grid(std::istream& is, grid<N, T, Layout, Allocator>& g)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "read_grid requires a trivially copyable element type");
+
+    GridSnapshotHeader h;
+    size_t dims[N];
+    if (!ReadSnapshotHeader<N, T>(is, h, dims)) {
+        return false;
+    }
+
+    size_t total = 1;
+    for (int i = 0; i < N; ++i) {
+        total *= dims[i];
+    }
+    if (total == 0) {
+        g.clear();
+        return true;
+    }
+
+    try {
+        ResizeDiscard(g, dims);
+    }
+    catch (const std::bad_alloc&) {
+        return false;
+    }
+
+    grid_index<N, T> start;
+    grid_index<N, T> end;
+    for (int i = 0; i < N; ++i) {
+        end(i) = dims[i] - 1;
+    }
+
+    const size_t row_size = total / dims[0];
+    const bool direct = std::is_same<Layout, row_major>::value;
+    std::vector<T> buffer;
+    std::vector<char> encoded;
+    for (size_t r0 = 0; r0 < dims[0]; r0 += h.slab_rows) {
+        const size_t rows = std::min<size_t>(h.slab_rows, dims[0] - r0);
+        GridChunkHeader ch;
+        if (!is.read((char*)&ch, sizeof(ch))) {
+            return false;
+        }
+
+        if (direct) {
+            // decode straight into the grid's storage
+            if (!ReadChunk(is, ch, g.data() + r0 * row_size, rows * row_size, encoded)) {
+                return false;
+            }
+        }
+        else {
+            buffer.resize(rows * row_size);
+            if (!ReadChunk(is, ch, buffer.data(), buffer.size(), encoded)) {
+                return false;
+            }
+            StoreSlabRegion(g, buffer.data(), dims, r0, rows, start, end);
+        }
+    }
+    return true;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool read_grid_region(
+    std::istream& is,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    grid<N, T, Layout, Allocator>& g)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "read_grid_region requires a trivially copyable element type");
+
+    GridSnapshotHeader h;
+    size_t dims[N];
+    if (!ReadSnapshotHeader<N, T>(is, h, dims)) {
+        return false;
+    }
+
+    size_t box[N];
+    size_t total = 1;
+    for (int i = 0; i < N; ++i) {
+        if (start(i) > end(i) || end(i) >= dims[i]) {
+            return false;
+        }
+        box[i] = end(i) - start(i) + 1;
+        total *= dims[i];
+    }
+
+    try {
+        ResizeDiscard(g, box);
+    }
+    catch (const std::bad_alloc&) {
+        return false;
+    }
+
+    const size_t row_size = total / dims[0];
+    std::vector<T> buffer;
+    std::vector<char> encoded;
+    for (size_t r0 = 0; r0 <= end(0); r0 += h.slab_rows) {
+        const size_t rows = std::min<size_t>(h.slab_rows, dims[0] - r0);
+        GridChunkHeader ch;
+        if (!is.read((char*)&ch, sizeof(ch))) {
+            return false;
+        }
+
+        if (r0 + rows <= start(0)) {
+            if (!SkipChunk<T>(is, ch, rows * row_size)) {
+                return false;
+            }
+            continue;
+        }
+
+        // the header's dimensions are only bounded by the address space, so
+        // check them against the chunk before sizing the buffer for it
+        if (!ValidChunkSizes(ch, rows * row_size * sizeof(T))) {
+            return false;
+        }
+        try {
+            buffer.resize(rows * row_size);
+        }
+        catch (const std::bad_alloc&) {
+            return false;
+        }
+        if (!ReadChunk(is, ch, buffer.data(), buffer.size(), encoded)) {
+            return false;
+        }
+        StoreSlabRegion(g, buffer.data(), dims, r0, rows, start, end);
+    }
+    return true;
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool save_grid(
+    const std::string& path,
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_write_options& options)
+{
+    std::ofstream ofs(path.c_str(), std::ios_base::binary);
+    return ofs && write_grid(ofs, g, options) && ofs.flush();
+}
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool load_grid(const std::string& path, grid<N, T, Layout, Allocator>& g)
+{
+    std::ifstream ifs(path.c_str(), std::ios_base::binary);
+    return ifs && read_grid(ifs, g);
+}
+
+} // namespace au
+
+#endif
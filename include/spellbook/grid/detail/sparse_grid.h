@@ -0,0 +1,420 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_sparse_grid_h
+#define au_detail_sparse_grid_h
+
+#include "../sparse_grid.h"
+
+// standard includes
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace au
+{
+
+inline uint64_t NextSparseGridId()
+{
+    static std::atomic<uint64_t> next_id(1);
+    return next_id++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// sparse_grid Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, size_t B>
+const typename sparse_grid<N, T, B>::size_type sparse_grid<N, T, B>::block_size;
+
+template <int N, typename T, size_t B>
+const typename sparse_grid<N, T, B>::size_type sparse_grid<N, T, B>::shift;
+
+template <int N, typename T, size_t B>
+const typename sparse_grid<N, T, B>::size_type sparse_grid<N, T, B>::mask;
+
+template <int N, typename T, size_t B>
+thread_local typename sparse_grid<N, T, B>::block_cache sparse_grid<N, T, B>::cache_ = { 0, 0, nullptr };
+
+template <int N, typename T, size_t B>
+sparse_grid<N, T, B>::sparse_grid() :
+    id_(NextSparseGridId()),
+    blocks_(),
+    background_()
+{
+    const size_type dims[N] = { };
+    set_dims(dims);
+}
+
+template <int N, typename T, size_t B>
+template <typename... SizeTypes>
+sparse_grid<N, T, B>::sparse_grid(SizeTypes... sizes) :
+    id_(NextSparseGridId()),
+    blocks_(),
+    background_()
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to sparse_grid");
+    const size_type dims[N] = { (size_type)sizes... };
+    set_dims(dims);
+}
+
+template <int N, typename T, size_t B>
+sparse_grid<N, T, B>::sparse_grid(const sparse_grid& other) :
+    id_(NextSparseGridId()),
+    blocks_(),
+    background_(other.background_)
+{
+    set_dims(other.dims_);
+    copy_blocks(other);
+}
+
+template <int N, typename T, size_t B>
+sparse_grid<N, T, B>& sparse_grid<N, T, B>::operator=(const sparse_grid& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        background_ = rhs.background_;
+        set_dims(rhs.dims_);
+        copy_blocks(rhs);
+    }
+    return *this;
+}
+
+template <int N, typename T, size_t B>
+sparse_grid<N, T, B>::sparse_grid(sparse_grid&& other) :
+    id_(NextSparseGridId()),
+    blocks_(std::move(other.blocks_)),
+    background_(std::move(other.background_))
+{
+    set_dims(other.dims_);
+    other.clear();
+}
+
+template <int N, typename T, size_t B>
+sparse_grid<N, T, B>& sparse_grid<N, T, B>::operator=(sparse_grid&& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        blocks_ = std::move(rhs.blocks_);
+        background_ = std::move(rhs.background_);
+        set_dims(rhs.dims_);
+        rhs.clear();
+    }
+    return *this;
+}
+
+template <int N, typename T, size_t B>
+template <typename... CoordTypes>
+auto sparse_grid<N, T, B>::operator()(CoordTypes... coords) -> reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    return find_or_create_block(block_key(c))[block_offset(c)];
+}
+
+template <int N, typename T, size_t B>
+template <typename... CoordTypes>
+auto sparse_grid<N, T, B>::operator()(CoordTypes... coords) const -> const_reference
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to operator()");
+    const size_type c[N] = { (size_type)coords... };
+    const T* block = find_block(block_key(c));
+    return block ? block[block_offset(c)] : background_;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::operator()(const index& i) -> reference
+{
+    return find_or_create_block(block_key(i.coords()))[block_offset(i.coords())];
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::operator()(const index& i) const -> const_reference
+{
+    const T* block = find_block(block_key(i.coords()));
+    return block ? block[block_offset(i.coords())] : background_;
+}
+
+template <int N, typename T, size_t B>
+template <typename... CoordTypes>
+bool sparse_grid<N, T, B>::within_bounds(CoordTypes... coords) const
+{
+    static_assert(sizeof...(coords) == N, "Invalid number of coordinates passed to within_bounds");
+    return CoordsInBounds(dims_, coords...);
+}
+
+template <int N, typename T, size_t B>
+bool sparse_grid<N, T, B>::is_allocated(const index& i) const
+{
+    return find_block(block_key(i.coords())) != nullptr;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::begin() -> iterator
+{
+    iterator it;
+    it.grid_ = this;
+    it.it_ = blocks_.begin();
+    if (it.it_ != blocks_.end()) {
+        it.enter_block();
+    }
+    return it;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::end() -> iterator
+{
+    iterator it;
+    it.grid_ = this;
+    it.it_ = blocks_.end();
+    return it;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::begin() const -> const_iterator
+{
+    return const_cast<sparse_grid*>(this)->begin();
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::end() const -> const_iterator
+{
+    return const_cast<sparse_grid*>(this)->end();
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::total_size() const -> size_type
+{
+    size_type s = 1;
+    for (int i = 0; i < N; ++i) {
+        s *= dims_[i];
+    }
+    return s;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::memory_usage() const -> size_type
+{
+    // each node of the hash table holds a key, a block pointer, and a next
+    // pointer (and, in common implementations, no cached hash for integer
+    // keys)
+    const size_type node_size =
+            sizeof(size_type) + sizeof(std::unique_ptr<T[]>) + sizeof(void*);
+    return sizeof(*this) +
+            blocks_.bucket_count() * sizeof(void*) +
+            blocks_.size() * (node_size + block_size * sizeof(T));
+}
+
+template <int N, typename T, size_t B>
+void sparse_grid<N, T, B>::clear()
+{
+    blocks_.clear();
+    id_ = NextSparseGridId();
+}
+
+template <int N, typename T, size_t B>
+template <typename... SizeTypes>
+void sparse_grid<N, T, B>::resize(SizeTypes... sizes)
+{
+    static_assert(sizeof...(sizes) == N, "Invalid number of sizes passed to resize");
+    clear();
+    const size_type dims[N] = { (size_type)sizes... };
+    set_dims(dims);
+}
+
+template <int N, typename T, size_t B>
+void sparse_grid<N, T, B>::set_dims(const size_type* dims)
+{
+    for (int i = 0; i < N; ++i) {
+        dims_[i] = dims[i];
+        block_counts_[i] = (dims[i] + mask) >> shift;
+    }
+    block_strides_[N - 1] = 1;
+    for (int i = N - 2; i >= 0; --i) {
+        block_strides_[i] = block_strides_[i + 1] * block_counts_[i + 1];
+    }
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::block_key(const size_type* c) const -> size_type
+{
+    size_type key = 0;
+    for (int i = 0; i < N; ++i) {
+        key += block_strides_[i] * (c[i] >> shift);
+    }
+    return key;
+}
+
+template <int N, typename T, size_t B>
+auto sparse_grid<N, T, B>::block_offset(const size_type* c) -> size_type
+{
+    size_type offset = 0;
+    for (int i = 0; i < N; ++i) {
+        offset = (offset << shift) | (c[i] & mask);
+    }
+    return offset;
+}
+
+template <int N, typename T, size_t B>
+T* sparse_grid<N, T, B>::find_block(size_type key) const
+{
+    block_cache& cache = cache_;
+    if (cache.owner == id_ && cache.key == key) {
+        return cache.block;
+    }
+
+    // missing blocks are cached too, since reads of empty space are the
+    // common case
+    typename block_map::const_iterator it = blocks_.find(key);
+    cache.owner = id_;
+    cache.key = key;
+    cache.block = it == blocks_.end() ? nullptr : it->second.get();
+    return cache.block;
+}
+
+template <int N, typename T, size_t B>
+T* sparse_grid<N, T, B>::find_or_create_block(size_type key)
+{
+    T* block = find_block(key);
+    if (block) {
+        return block;
+    }
+
+    std::unique_ptr<T[]> b(new T[block_size]);
+    std::fill(b.get(), b.get() + block_size, background_);
+    block = b.get();
+    blocks_.insert(std::make_pair(key, std::move(b)));
+
+    // invalidate cache entries that recorded this block as missing
+    id_ = NextSparseGridId();
+
+    block_cache& cache = cache_;
+    cache.owner = id_;
+    cache.key = key;
+    cache.block = block;
+    return block;
+}
+
+template <int N, typename T, size_t B>
+void sparse_grid<N, T, B>::copy_blocks(const sparse_grid& other)
+{
+    blocks_.reserve(other.blocks_.size());
+    for (typename block_map::const_iterator it = other.blocks_.begin(); it != other.blocks_.end(); ++it) {
+        std::unique_ptr<T[]> b(new T[block_size]);
+        std::copy(it->second.get(), it->second.get() + block_size, b.get());
+        blocks_.insert(std::make_pair(it->first, std::move(b)));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// sparse_grid_iterator Implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <int N, typename T, size_t B>
+sparse_grid_iterator<N, T, B>::sparse_grid_iterator() :
+    grid_(nullptr),
+    it_(),
+    block_(nullptr),
+    offset_(0),
+    origin_(),
+    curr_()
+{
+}
+
+template <int N, typename T, size_t B>
+sparse_grid_iterator<N, T, B>& sparse_grid_iterator<N, T, B>::operator++()
+{
+    if (!advance_in_block()) {
+        ++it_;
+        if (it_ != grid_->blocks_.end()) {
+            enter_block();
+        }
+        else {
+            block_ = nullptr;
+            offset_ = 0;
+        }
+    }
+    return *this;
+}
+
+template <int N, typename T, size_t B>
+sparse_grid_iterator<N, T, B> sparse_grid_iterator<N, T, B>::operator++(int)
+{
+    sparse_grid_iterator it(*this);
+    ++(*this);
+    return it;
+}
+
+template <int N, typename T, size_t B>
+bool sparse_grid_iterator<N, T, B>::operator==(const sparse_grid_iterator& other) const
+{
+    return grid_ == other.grid_ && it_ == other.it_ && offset_ == other.offset_;
+}
+
+template <int N, typename T, size_t B>
+bool sparse_grid_iterator<N, T, B>::operator!=(const sparse_grid_iterator& other) const
+{
+    return !(*this == other);
+}
+
+template <int N, typename T, size_t B>
+void sparse_grid_iterator<N, T, B>::enter_block()
+{
+    const size_type shift = sparse_grid<N, T, B>::shift;
+    size_type key = it_->first;
+    for (int i = 0; i < N; ++i) {
+        origin_(i) = (key / grid_->block_strides_[i]) << shift;
+        key %= grid_->block_strides_[i];
+    }
+    curr_ = origin_;
+    block_ = it_->second.get();
+    offset_ = 0;
+}
+
+// Step to the next element of the block that lies within the bounds of the
+// grid, skipping the padding of blocks on the upper boundary. Returns false
+// if there is no such element.
+template <int N, typename T, size_t B>
+bool sparse_grid_iterator<N, T, B>::advance_in_block()
+{
+    const size_type shift = sparse_grid<N, T, B>::shift;
+    for (int i = N - 1; i >= 0; --i) {
+        const size_type inner = curr_(i) - origin_(i);
+        const size_type step = (size_type)1 << ((N - 1 - i) * shift);
+        if (inner + 1 < B && curr_(i) + 1 < grid_->dims_[i]) {
+            ++curr_(i);
+            offset_ += step;
+            return true;
+        }
+        offset_ -= inner * step;
+        curr_(i) = origin_(i);
+    }
+    return false;
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_summed_area_table_h
+#define au_detail_summed_area_table_h
+
+#include "../summed_area_table.h"
+
+// standard includes
+#include <assert.h>
+#include <algorithm>
+
+namespace au
+{
+
+/// Replace every line of the row-major grid g along dimension dim, skipping
+/// the first element of the line, with its running sum. The grid is viewed as
+/// outer x n x inner elements, where the lines run along n, so that the
+/// running sums of inner adjacent lines are computed together with
+/// contiguous, vectorizable loops.
+template <int N, typename S>
+void PrefixSumPass(grid<N, S>& g, int dim, thread_pool& pool)
+{
+    const size_t n = g.size(dim);
+    const size_t inner = g.stride(dim);
+    const size_t outer = g.total_size() / (n * inner);
+
+    ParallelForRange(pool, outer * inner, [&](size_t first, size_t last)
+    {
+        while (first < last) {
+            const size_t o = first / inner;
+            const size_t j0 = first % inner;
+            const size_t j1 = std::min(inner, j0 + (last - first));
+            S* base = g.data() + o * n * inner;
+            for (size_t i = 1; i < n; ++i) {
+                S* curr = base + i * inner;
+                const S* prev = curr - inner;
+                for (size_t j = j0; j < j1; ++j) {
+                    curr[j] += prev[j];
+                }
+            }
+            first += j1 - j0;
+        }
+    });
+}
+
+template <int N, typename T, typename Sum>
+summed_area_table<N, T, Sum>::summed_area_table() :
+    table_()
+{
+}
+
+template <int N, typename T, typename Sum>
+template <typename Layout, typename Allocator>
+summed_area_table<N, T, Sum>::summed_area_table(
+    const grid<N, T, Layout, Allocator>& src,
+    thread_pool& pool)
+:
+    table_()
+{
+    assign(src, pool);
+}
+
+template <int N, typename T, typename Sum>
+Sum summed_area_table<N, T, Sum>::sum(const index& start, const index& end) const
+{
+    // inclusion-exclusion over the 2^N corners of the box, where bit d of
+    // corner selects the low side along dimension d
+    Sum total = Sum();
+    for (unsigned corner = 0; corner < (1u << N); ++corner) {
+        size_type offset = 0;
+        bool negate = false;
+        for (int d = 0; d < N; ++d) {
+            const bool low = (corner >> d) & 1;
+            offset += (low ? start(d) : end(d) + 1) * table_.stride(d);
+            negate ^= low;
+        }
+        const Sum v = table_.data()[offset];
+        total = negate ? total - v : total + v;
+    }
+    return total;
+}
+
+template <int N, typename T, typename Sum>
+template <typename Layout, typename Allocator>
+void summed_area_table<N, T, Sum>::assign(
+    const grid<N, T, Layout, Allocator>& src,
+    thread_pool& pool)
+{
+    size_type dims[N];
+    for (int d = 0; d < N; ++d) {
+        dims[d] = src.size(d) + 1;
+    }
+    ResizeDiscard(table_, dims);
+    std::fill(table_.data(), table_.data() + table_.total_size(), Sum());
+
+    // copy the source into the table, offset by one along every dimension
+    index start;
+    index end;
+    for (int d = 0; d < N; ++d) {
+        start(d) = 0;
+        end(d) = src.size(d) - 1;
+    }
+    ForEachRun(start, end, N - 1, [&](const index& row, size_type len)
+    {
+        index i = row;
+        size_type offset = 0;
+        for (int d = 0; d < N; ++d) {
+            offset += (row(d) + 1) * table_.stride(d);
+        }
+        Sum* dst = table_.data() + offset;
+        for (size_type k = 0; k < len; ++k, ++i(N - 1)) {
+            dst[k] = (Sum)src(i);
+        }
+    });
+
+    for (int d = 0; d < N; ++d) {
+        PrefixSumPass(table_, d, pool);
+    }
+}
+
+template <int N, typename T, typename Sum>
+template <typename Layout, typename Allocator>
+void summed_area_table<N, T, Sum>::update(
+    const grid<N, T, Layout, Allocator>& src,
+    const index& start,
+    const index& end,
+    thread_pool& pool)
+{
+    // every entry in the suffix box [start + 1, size] covers a changed
+    // element; when that is most of the table, a rebuild is as cheap and its
+    // passes vectorize better
+    size_type suffix = 1;
+    size_type total = 1;
+    for (int d = 0; d < N; ++d) {
+        suffix *= src.size(d) - start(d);
+        total *= src.size(d);
+    }
+    if (2 * suffix > total) {
+        assign(src, pool);
+        return;
+    }
+
+    size_type box[N];
+    size_type delta_dims[N];
+    for (int d = 0; d < N; ++d) {
+        box[d] = end(d) - start(d) + 1;
+        delta_dims[d] = box[d] + 1;
+    }
+
+    // the changes as a summed-area table of their own, padded like table_;
+    // the old source values are recovered from the table by
+    // inclusion-exclusion over the 2^N - 1 lower neighbors of each entry
+    size_type neighbor_offsets[1u << N];
+    bool neighbor_added[1u << N];
+    for (unsigned s = 1; s < (1u << N); ++s) {
+        neighbor_offsets[s] = 0;
+        neighbor_added[s] = false;
+        for (int d = 0; d < N; ++d) {
+            if ((s >> d) & 1) {
+                neighbor_offsets[s] += table_.stride(d);
+                neighbor_added[s] = !neighbor_added[s];
+            }
+        }
+    }
+
+    grid<N, Sum> delta;
+    ResizeDiscard(delta, delta_dims);
+    std::fill(delta.data(), delta.data() + delta.total_size(), Sum());
+    ForEachRun(start, end, N - 1, [&](const index& row, size_type len)
+    {
+        index i = row;
+        size_type t = 0;
+        size_type o = 0;
+        for (int d = 0; d < N; ++d) {
+            t += (row(d) + 1) * table_.stride(d);
+            o += (row(d) - start(d) + 1) * delta.stride(d);
+        }
+        const Sum* tp = table_.data();
+        for (size_type k = 0; k < len; ++k, ++i(N - 1), ++t) {
+            Sum old = tp[t];
+            for (unsigned s = 1; s < (1u << N); ++s) {
+                const Sum n = tp[t - neighbor_offsets[s]];
+                old = neighbor_added[s] ? old - n : old + n;
+            }
+            delta.data()[o + k] = (Sum)src(i) - old;
+        }
+    });
+    for (int d = 0; d < N; ++d) {
+        PrefixSumPass(delta, d, pool);
+    }
+
+    // table(c) += delta(min(c - start, box)), independently for each entry
+    index first;
+    index last;
+    for (int d = 0; d < N; ++d) {
+        first(d) = start(d) + 1;
+        last(d) = src.size(d);
+    }
+    ForEachSlab(first, last, pool, [&](size_t, const index& slab_start, const index& slab_end)
+    {
+        ForEachRun(slab_start, slab_end, N - 1, [&](const index& row, size_type len)
+        {
+            size_type t = 0;
+            size_type o = 0;
+            for (int d = 0; d < N; ++d) {
+                t += row(d) * table_.stride(d);
+                o += std::min<size_type>(row(d) - start(d), box[d]) * delta.stride(d);
+            }
+            Sum* tp = table_.data() + t;
+            const Sum* dp = delta.data() + o;
+
+            // entries within the changed box along the last dimension, then
+            // entries beyond it, which all see the full change; a run need
+            // not begin at start + 1 when slabs split the last dimension
+            const size_type skip = std::min<size_type>(row(N - 1) - start(N - 1), box[N - 1]);
+            const size_type within = std::min<size_type>(len, box[N - 1] - skip + 1);
+            for (size_type k = 0; k < within; ++k) {
+                tp[k] += dp[k];
+            }
+            const Sum full = dp[within - 1];
+            for (size_type k = within; k < len; ++k) {
+                tp[k] += full;
+            }
+        });
+    });
+}
+
+} // namespace au
+
+#endif
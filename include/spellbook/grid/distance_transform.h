@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_distance_transform_h
+#define au_distance_transform_h
+
+#include "grid.h"
+#include "parallel.h"
+
+namespace au
+{
+
+/// \name Euclidean distance transforms
+///
+/// Exact Euclidean distance transforms of a grid, measured in cells, computed
+/// in linear time with the separable lower-envelope algorithm of Felzenszwalb
+/// and Huttenlocher ("Distance Transforms of Sampled Functions", 2012). One
+/// pass is made per dimension, and the lines of each pass are distributed
+/// over a thread pool.
+///
+/// A cell is an obstacle if is_obstacle(value) is true; the overloads without
+/// a predicate treat every value other than T() as an obstacle, which matches
+/// the 0/1 cells of a Map. dst is resized to match src. Cells of a grid
+/// without obstacles are at infinite distance.
+///@{
+
+/// Set each cell of dst to the squared distance to the nearest obstacle.
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void squared_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void squared_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst);
+
+/// Set each cell of dst to the distance to the nearest obstacle.
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst);
+
+/// Set each free cell of dst to the distance to the nearest obstacle and each
+/// obstacle cell to the negated distance to the nearest free cell, so that
+/// cells on the boundary of an obstacle are at -1.
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void signed_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst,
+    Predicate is_obstacle,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void signed_distance_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, float, row_major, DstAllocator>& dst);
+///@}
+
+} // namespace au
+
+#include "detail/distance_transform.h"
+
+#endif
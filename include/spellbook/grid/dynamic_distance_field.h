@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_dynamic_distance_field_h
+#define au_dynamic_distance_field_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// A distance field over an N-dimensional occupancy grid that is repaired
+/// incrementally as obstacles are added and removed, using the dynamic
+/// brushfire algorithm of Lau, Sprunk, and Burgard ("Improved Updating of
+/// Euclidean Distance Maps and Voronoi Diagrams", IROS 2010).
+///
+/// Each cell stores its nearest obstacle cell. Changes are queued with
+/// set_obstacle() and clear_obstacle() and applied in a batch by update(),
+/// which lowers distances outward from new obstacles and raises (invalidates
+/// and then refills) the cells whose nearest obstacle was removed. The work
+/// done by update() is proportional to the number of cells whose nearest
+/// obstacle changes, not to the size of the grid.
+///
+/// Distances are in cells. As with the original algorithm, propagation over
+/// the (3^N - 1)-neighborhood may in rare configurations settle on an
+/// obstacle that is slightly farther than the nearest one; distance_transform
+/// gives exact results for a full rebuild.
+template <int N>
+class dynamic_distance_field
+{
+public:
+
+    typedef size_t                  size_type;
+    typedef grid_index<N, float>    index;
+
+    dynamic_distance_field();
+
+    /// Cells are addressed with 32-bit offsets and distances are stored
+    /// squared in 32 bits, so the grid must have fewer than 2^32 - 1 cells
+    /// and the squared distance between its farthest cells must be less than
+    /// max_squared_distance() (up to 46341 x 46341 in 2-D); larger sizes
+    /// throw std::length_error.
+    template <typename... SizeTypes>
+    dynamic_distance_field(SizeTypes... sizes);
+
+    /// \name Element access
+    ///@{
+
+    /// Return the distance to the nearest obstacle, as of the last update(),
+    /// or infinity if there are no obstacles.
+    float distance(const index& i) const;
+
+    /// Return the squared distance to the nearest obstacle, as of the last
+    /// update(), or max_squared_distance() if there are no obstacles.
+    uint32_t squared_distance(const index& i) const;
+
+    /// Return whether a cell is an obstacle, including changes not yet
+    /// applied by update().
+    bool is_obstacle(const index& i) const;
+
+    /// Return the nearest obstacle to a cell as of the last update(). Returns
+    /// false if there are no obstacles.
+    bool nearest_obstacle(const index& i, index& obstacle) const;
+
+    static uint32_t max_squared_distance() { return UINT32_MAX; }
+
+    template <typename... CoordTypes>
+    bool within_bounds(CoordTypes... coords) const { return cells_.within_bounds(coords...); }
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return cells_.size(dim); }
+    size_type total_size() const { return cells_.total_size(); }
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+
+    /// Rebuild the field from scratch from the cells of an occupancy grid for
+    /// which is_obstacle(value) is true, resizing the field to the size of
+    /// the occupancy grid under the same limits as the constructor.
+    template <typename T, typename Layout, typename Allocator, typename Predicate>
+    void assign(const grid<N, T, Layout, Allocator>& occupancy, Predicate is_obstacle);
+
+    void set_obstacle(const index& i);
+    void clear_obstacle(const index& i);
+
+    /// Apply all changes made since the last update. Returns the number of
+    /// cells processed.
+    size_type update();
+    ///@}
+
+private:
+
+    static const uint32_t no_obstacle = UINT32_MAX;
+
+    enum queue_state : uint8_t
+    {
+        not_queued,
+        lower_queued,
+        lower_processed,
+        raise_queued,
+        raise_processed
+    };
+
+    struct cell
+    {
+        uint32_t    obstacle;   // offset of the nearest obstacle cell
+        uint32_t    sqdist;
+        bool        raise;
+        queue_state state;
+
+        cell() :
+            obstacle(no_obstacle),
+            sqdist(UINT32_MAX),
+            raise(false),
+            state(not_queued)
+        { }
+    };
+
+    // (squared distance, cell offset), smallest distance first
+    typedef std::pair<uint32_t, uint32_t> queue_entry;
+    typedef std::priority_queue<
+            queue_entry,
+            std::vector<queue_entry>,
+            std::greater<queue_entry>> open_list;
+
+    grid<N, cell>               cells_;
+    open_list                   open_;
+    std::vector<ptrdiff_t>      neighbor_offsets_;
+    std::vector<int>            neighbor_steps_;    // N steps per neighbor
+
+    void resize(const size_type* dims);
+    void init();
+
+    uint32_t offset(const index& i) const;
+    void coords(uint32_t offset, int* c) const;
+
+    bool is_obstacle(uint32_t offset) const { return cells_.data()[offset].obstacle == offset; }
+
+    void raise(uint32_t s, const int* c);
+    void lower(uint32_t s, const int* c);
+};
+
+} // namespace au
+
+#include "detail/dynamic_distance_field.h"
+
+#endif
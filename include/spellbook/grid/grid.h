@@ -34,6 +34,9 @@
 #include <iostream>
 #include <type_traits>
 
+#include "allocator.h"
+#include "layout.h"
+
 namespace au
 {
 
@@ -41,23 +44,33 @@ namespace au
 // * N > 0
 // * size(i) != 0 for all i
 
-template <int N, typename T> class grid_iterator;
+template <int N, typename T, typename Layout = row_major, typename Allocator = aligned_allocator<>> class grid;
+template <int N, typename T, typename Layout = row_major, typename Allocator = aligned_allocator<>> class grid_iterator;
 template <int N, typename T> class grid_index;
 
-template <int N, typename T>
+/// \tparam Layout The storage layout policy (see layout.h). Element access and
+///     iteration behave the same for every layout; only the arrangement of
+///     elements in the buffer returned by data() differs.
+/// \tparam Allocator The storage allocation policy (see allocator.h), which
+///     controls the alignment of the buffer returned by data().
+template <int N, typename T, typename Layout, typename Allocator>
 class grid
 {
+    friend class grid_iterator<N, T, Layout, Allocator>;
+
 public:
 
-    typedef size_t                      size_type;
-    typedef T                           value_type;
-    typedef T&                          reference;
-    typedef const T&                    const_reference;
+    typedef size_t                                  size_type;
+    typedef T                                       value_type;
+    typedef T&                                      reference;
+    typedef const T&                                const_reference;
+    typedef Layout                                  layout_type;
+    typedef Allocator                               allocator_type;
 
-    typedef grid_iterator<N, T>         iterator;
-    typedef const grid_iterator<N, T>   const_iterator;
+    typedef grid_iterator<N, T, Layout, Allocator>             iterator;
+    typedef const grid_iterator<N, T, Layout, Allocator>       const_iterator;
 
-    typedef grid_index<N, T>            index;
+    typedef grid_index<N, T>                        index;
 
     grid();
 
@@ -73,6 +86,12 @@ public:
     ~grid();
 
     /// \name Element access
+    ///
+    /// operator() does not check its coordinates unless AU_GRID_DEBUG is
+    /// defined, in which case out-of-bounds accesses fail an assertion. at()
+    /// throws std::out_of_range for coordinates outside the grid, and find()
+    /// returns a null pointer for them. Coordinates may be of any arithmetic
+    /// type; negative coordinates are out of bounds.
     ///@{
     template <typename... CoordTypes>
     reference operator()(CoordTypes... coords);
@@ -92,10 +111,22 @@ public:
     reference at(const index& i);
     const_reference at(const index& i) const;
 
+    template <typename... CoordTypes>
+    T* find(CoordTypes... coords) noexcept;
+
+    template <typename... CoordTypes>
+    const T* find(CoordTypes... coords) const noexcept;
+
+    T* find(const index& i) noexcept;
+    const T* find(const index& i) const noexcept;
+
     T* data() { return data_; }
+    const T* data() const { return data_; }
 
     template <typename... CoordTypes>
-    bool within_bounds(CoordTypes... coords) const;
+    bool within_bounds(CoordTypes... coords) const noexcept;
+
+    bool within_bounds(const index& i) const noexcept;
     ///@}
 
     /// \name Iterators
@@ -115,6 +146,14 @@ public:
     ///@{
     size_type size(size_type dim) const;
     size_type total_size() const;
+
+    /// Return the number of elements in the storage buffer, which may exceed
+    /// total_size() for layouts that pad the dimensions.
+    size_type storage_size() const { return data_ ? layout_.storage_size() : 0; }
+
+    /// Return the distance between consecutive elements along a dimension.
+    /// Only available for row-major grids.
+    size_type stride(size_type dim) const { return layout_.stride(dim); }
     ///@}
 
     /// \name Modifiers
@@ -124,6 +163,13 @@ public:
     template <typename... SizeTypes>
     void resize(SizeTypes... sizes);
 
+    /// Resize the grid, discarding its contents, and leave the elements
+    /// uninitialized. The existing buffer is reused if it has the required
+    /// size. Only available for trivial element types; intended for grids that
+    /// are about to be overwritten completely.
+    template <typename... SizeTypes>
+    void resize_uninitialized(SizeTypes... sizes);
+
 //    void resize(const index& sizes);
 //    void resize(const index& sizes, const value_type& value);
 
@@ -132,11 +178,19 @@ public:
 
 private:
 
-    value_type* data_;
-    size_type   dims_[N];
+    typedef typename Layout::template mapping<N> mapping_type;
+
+    value_type*     data_;
+    size_type       dims_[N];
+    mapping_type    layout_;
 
     void copy(const grid& other);
 
+    void allocate(size_type count);
+    void deallocate();
+    void destroy_elements(std::true_type trivially_destructible);
+    void destroy_elements(std::false_type trivially_destructible);
+
     template <size_type DIM, typename SizeType, typename... SizeTypes> // TODO: how to declare DIM in a separate implementation?
     void set_sizes(size_type* dims, SizeType size, SizeTypes... sizes)
     {
@@ -152,29 +206,24 @@ private:
         dims[N-1] = size;
     }
 
-    size_type coord_to_index(const index& i);
+    size_type coord_to_index(const index& i) const;
 
     template <typename... CoordTypes>
-    size_type coord_to_index(CoordTypes... coords);
-
-    template <int DIM, typename... CoordTypes, typename Coord>
-    size_type coord_to_index_rec(size_type& agg, Coord coord, CoordTypes... coords);
-
-    template <int DIM, typename Coord>
-    size_type coord_to_index_rec(size_type& agg, Coord coord);
-
-    template <int DIM>
-    void assign_sizes(index& i);
+    size_type coord_to_index(CoordTypes... coords) const;
 
     template <int DIM, typename Coord, typename... CoordTypes>
-    bool within_bounds(Coord coord, CoordTypes... coords) const;
+    bool within_bounds(Coord coord, CoordTypes... coords) const noexcept;
 
     template <int DIM, typename Coord>
-    bool within_bounds(Coord coord) const;
+    bool within_bounds(Coord coord) const noexcept;
 
     index create_last_index() const;
 
+    bool is_contiguous(const index& start, const index& end) const;
+
     void copy_grid(grid& g);
+    void copy_grid(grid& g, std::true_type contiguous_rows);
+    void copy_grid(grid& g, std::false_type contiguous_rows);
 };
 
 template <int N, typename T>
@@ -192,6 +241,8 @@ public:
     size_type& operator()(size_type dim) { return coords_[dim]; }
     const size_type& operator()(size_type dim) const { return coords_[dim]; }
 
+    const size_type* coords() const { return coords_; }
+
     bool operator<(const grid_index& rhs) const {
         for (int i = 0; i < N; ++i) {
             if (coords_[i] < rhs.coords_[i]) {
@@ -233,25 +284,22 @@ private:
 template <int N, typename T>
 std::ostream& operator<<(std::ostream&, const grid_index<N, T>&);
 
-template <int N, typename T>
-class grid_iterator;
-
-template <int N, typename T>
-std::ostream& operator<<(std::ostream&, const grid_iterator<N, T>&);
+template <int N, typename T, typename Layout, typename Allocator>
+std::ostream& operator<<(std::ostream&, const grid_iterator<N, T, Layout, Allocator>&);
 
-template <int N, typename T>
+template <int N, typename T, typename Layout, typename Allocator>
 class grid_iterator : public std::iterator<
         std::bidirectional_iterator_tag,
-        typename grid<N, T>::value_type>
+        typename grid<N, T, Layout, Allocator>::value_type>
 {
-    friend class grid<N, T>;
-    friend std::ostream& operator<< <N, T>(std::ostream&, const grid_iterator<N, T>&);
+    friend class grid<N, T, Layout, Allocator>;
+    friend std::ostream& operator<< <N, T, Layout, Allocator>(std::ostream&, const grid_iterator<N, T, Layout, Allocator>&);
 
 public:
 
-    typedef typename grid<N, T>::size_type      size_type;
-    typedef typename grid<N, T>::value_type     value_type;
-    typedef typename grid<N, T>::index          index;
+    typedef typename grid<N, T, Layout, Allocator>::size_type      size_type;
+    typedef typename grid<N, T, Layout, Allocator>::value_type     value_type;
+    typedef typename grid<N, T, Layout, Allocator>::index          index;
 
     grid_iterator();
 
@@ -270,22 +318,69 @@ public:
     grid_iterator operator--(int);
     ///@}
 
-    const index& cindex() const { return curr_; }
-    size_type coord(size_type dim) const { return curr_(dim); }
+    const index& cindex() const;
+    size_type coord(size_type dim) const { return cindex()(dim); }
 
 public:
 
-    grid<N, T>* grid_;
+    grid<N, T, Layout, Allocator>* grid_;
     index begin_;
     index end_;
-    index curr_;
+    mutable index curr_;
     size_type inc_;     // index into curr_ to be (in/de)cremented next
 
+    // pointer to the current element; one past the last element of the range
+    // for the end iterator of a contiguous range and null for the end iterator
+    // of any other range
+    value_type* ptr_;
+
+    // true when the range covers the full extent of every dimension but the
+    // outermost of a row-major grid, in which case the range is a single
+    // contiguous span of memory and incrementing only advances ptr_ (curr_ is
+    // recovered on demand in cindex())
+    bool contiguous_;
+
     size_type size(size_type dim) const { return end_(dim) - begin_(dim) + 1; }
+
+    void recover_index(std::true_type contiguous_rows) const;
+    void recover_index(std::false_type contiguous_rows) const { }
 };
 
-//template <int N, typename T>
-//std::ostream& operator<<(std::ostream&, const grid_iterator<N, T>&);
+/// \name Row-wise algorithms
+///
+/// Operate on the inclusive box [start, end] of a grid one contiguous run of
+/// the innermost dimension at a time (runs that span whole rows are merged),
+/// so that the inner loops are over plain pointers and can be vectorized.
+/// for_each_row requires a layout with contiguous rows; fill and transform
+/// fall back to element-wise iteration for other layouts.
+///@{
+
+/// Call fn(first, last) for each contiguous run [first, last) of elements in
+/// the box [start, end].
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void for_each_row(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn);
+
+template <int N, typename T, typename Layout, typename Allocator>
+void fill(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    const T& value);
+
+/// Assign dst(i) = op(src(i)) for every index i in the box [start, end]. Both
+/// grids must contain the box.
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op);
+///@}
 
 } // namespace au
 
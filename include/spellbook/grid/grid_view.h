@@ -0,0 +1,182 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_grid_view_h
+#define au_grid_view_h
+
+#include <stddef.h>
+#include <iterator>
+#include <type_traits>
+
+#include "grid.h"
+
+namespace au
+{
+
+template <int N, typename T> class grid_view;
+template <int N, typename T> class grid_view_iterator;
+
+/// A non-owning N-dimensional view of elements in memory owned elsewhere,
+/// described by a base pointer, a size, and a (signed) element stride per
+/// dimension. Views may be taken of a row-major grid or wrapped around a
+/// foreign buffer, e.g. the data of a nav_msgs::OccupancyGrid, and narrowed
+/// to sub-boxes and lower-dimensional slices without copying any elements.
+///
+/// Use grid_view<N, const T> for read-only access. A view does not extend the
+/// lifetime of the memory it refers to, and resizing the underlying grid
+/// invalidates it.
+template <int N, typename T>
+class grid_view
+{
+public:
+
+    typedef size_t                                      size_type;
+    typedef ptrdiff_t                                   difference_type;
+    typedef typename std::remove_const<T>::type         value_type;
+    typedef T&                                          reference;
+    typedef grid_view_iterator<N, T>                    iterator;
+    typedef grid_index<N, value_type>                   index;
+
+    grid_view();
+
+    /// Wrap a buffer with explicit sizes and strides (in elements).
+    grid_view(T* data, const size_type* sizes, const difference_type* strides);
+
+    /// Wrap a dense row-major buffer; the last dimension varies fastest.
+    template <typename... SizeTypes>
+    grid_view(T* data, SizeTypes... sizes);
+
+    template <typename Allocator>
+    grid_view(grid<N, value_type, row_major, Allocator>& g);
+
+    template <typename Allocator>
+    grid_view(const grid<N, value_type, row_major, Allocator>& g);
+
+    /// Allow conversion from a mutable view to a read-only view.
+    template <typename U>
+    grid_view(const grid_view<N, U>& other,
+              typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = 0);
+
+    /// \name Element access
+    ///@{
+    template <typename... CoordTypes>
+    reference operator()(CoordTypes... coords) const;
+
+    reference operator()(const index& i) const;
+
+    T* data() const { return data_; }
+
+    template <typename... CoordTypes>
+    bool within_bounds(CoordTypes... coords) const;
+    ///@}
+
+    /// \name Iterators
+    ///
+    /// Visit every element of the view with the last coordinate varying
+    /// fastest, regardless of the order of the underlying storage.
+    ///@{
+    iterator begin() const;
+    iterator end() const;
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return dims_[dim]; }
+    difference_type stride(size_type dim) const { return strides_[dim]; }
+    size_type total_size() const;
+    bool empty() const { return total_size() == 0; }
+    ///@}
+
+    /// \name Views
+    ///@{
+
+    /// Return a view of the inclusive box [start, end] of this view.
+    grid_view window(const index& start, const index& end) const;
+
+    /// Return the (N-1)-dimensional view of the elements whose coordinate
+    /// along dimension dim is coord.
+    grid_view<N - 1, T> slice(size_type dim, size_type coord) const;
+    ///@}
+
+private:
+
+    template <int, typename> friend class grid_view;
+    friend class grid_view_iterator<N, T>;
+
+    T*              data_;
+    size_type       dims_[N];
+    difference_type strides_[N];
+
+    difference_type offset(const size_type* c) const;
+};
+
+template <int N, typename T>
+class grid_view_iterator : public std::iterator<
+        std::bidirectional_iterator_tag,
+        typename grid_view<N, T>::value_type>
+{
+    friend class grid_view<N, T>;
+
+public:
+
+    typedef typename grid_view<N, T>::size_type      size_type;
+    typedef typename grid_view<N, T>::index          index;
+
+    grid_view_iterator();
+
+    /// \name Iterator API
+    ///@{
+    grid_view_iterator& operator++();
+    grid_view_iterator operator++(int);
+
+    bool operator==(const grid_view_iterator& other) const;
+    bool operator!=(const grid_view_iterator& other) const;
+
+    T& operator*() const { return *ptr_; }
+    T* operator->() const { return ptr_; }
+
+    grid_view_iterator& operator--();
+    grid_view_iterator operator--(int);
+    ///@}
+
+    const index& cindex() const { return curr_; }
+    size_type coord(size_type dim) const { return curr_(dim); }
+
+private:
+
+    // a copy, so that iterators remain valid after a temporary view returned
+    // by window() or slice() is destroyed
+    grid_view<N, T> view_;
+    index curr_;
+    T* ptr_;
+    size_type pos_; // number of elements preceding the current element
+};
+
+} // namespace au
+
+#include "detail/grid_view.h"
+
+#endif
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_grid_kernels_h
+#define au_grid_kernels_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// \name Vectorized element-wise kernels
+///
+/// Kernels over 8-bit cells (int8_t, uint8_t, and char) use SSE2 or AVX2,
+/// whichever the processor supports, selected at runtime; other element types
+/// and other processors use scalar loops. The grid overloads operate on
+/// row-major grids, whose storage holds exactly the grid's elements, and
+/// resize the destination grid to match the source.
+///@{
+
+enum simd_isa
+{
+    simd_scalar,
+    simd_sse2,
+    simd_avx2
+};
+
+/// Return the most capable instruction set supported by the processor.
+simd_isa detected_simd_isa();
+
+/// Return the instruction set used by the kernels.
+simd_isa active_simd_isa();
+
+/// Limit the kernels to an instruction set, e.g. to compare implementations.
+/// Requests for instruction sets the processor lacks fall back to the
+/// detected one.
+void set_simd_isa(simd_isa isa);
+
+/// mask[i] = src[i] >= value ? 1 : 0
+void threshold(const uint8_t* src, size_t n, uint8_t value, uint8_t* mask);
+void threshold(const int8_t* src, size_t n, int8_t value, uint8_t* mask);
+
+/// dst[i] = op(a[i], b[i]); dst may alias a or b. add wraps on overflow and
+/// add_saturate clamps to the range of the element type.
+void elementwise_min(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst);
+void elementwise_min(const int8_t* a, const int8_t* b, size_t n, int8_t* dst);
+void elementwise_max(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst);
+void elementwise_max(const int8_t* a, const int8_t* b, size_t n, int8_t* dst);
+void add(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst);
+void add(const int8_t* a, const int8_t* b, size_t n, int8_t* dst);
+void add_saturate(const uint8_t* a, const uint8_t* b, size_t n, uint8_t* dst);
+void add_saturate(const int8_t* a, const int8_t* b, size_t n, int8_t* dst);
+
+/// Return the number of elements >= value.
+size_t count_at_least(const uint8_t* src, size_t n, uint8_t value);
+size_t count_at_least(const int8_t* src, size_t n, int8_t value);
+
+/// Return the number of nonzero bytes.
+size_t count_nonzero(const uint8_t* src, size_t n);
+
+/// Set bit i % 64 of bits[i / 64] iff src[i] is nonzero. bits must hold
+/// (n + 63) / 64 words; unused bits of the last word are cleared.
+void pack_bits(const uint8_t* src, size_t n, uint64_t* bits);
+
+template <int N, typename T, typename A, typename B>
+void threshold(
+    const grid<N, T, row_major, A>& src,
+    const T& value,
+    grid<N, uint8_t, row_major, B>& mask);
+
+template <int N, typename T, typename A, typename B, typename C>
+void elementwise_min(
+    const grid<N, T, row_major, A>& a,
+    const grid<N, T, row_major, B>& b,
+    grid<N, T, row_major, C>& dst);
+
+template <int N, typename T, typename A, typename B, typename C>
+void elementwise_max(
+    const grid<N, T, row_major, A>& a,
+    const grid<N, T, row_major, B>& b,
+    grid<N, T, row_major, C>& dst);
+
+template <int N, typename T, typename A, typename B, typename C>
+void add(
+    const grid<N, T, row_major, A>& a,
+    const grid<N, T, row_major, B>& b,
+    grid<N, T, row_major, C>& dst);
+
+template <int N, typename T, typename A, typename B, typename C>
+void add_saturate(
+    const grid<N, T, row_major, A>& a,
+    const grid<N, T, row_major, B>& b,
+    grid<N, T, row_major, C>& dst);
+
+template <int N, typename T, typename A>
+size_t count_at_least(const grid<N, T, row_major, A>& g, const T& value);
+
+template <int N, typename T, typename A, typename Predicate>
+size_t count_if(const grid<N, T, row_major, A>& g, Predicate pred);
+
+template <int N, typename T, typename A>
+size_t count_nonzero(const grid<N, T, row_major, A>& g);
+
+/// Pack the grid into one bit per cell, in storage order, set for nonzero
+/// cells.
+template <int N, typename T, typename A>
+void pack_bits(const grid<N, T, row_major, A>& g, std::vector<uint64_t>& bits);
+///@}
+
+} // namespace au
+
+#include "detail/kernels.h"
+
+#endif
@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_grid_layout_h
+#define au_grid_layout_h
+
+#include <stddef.h>
+
+namespace au
+{
+
+// Storage layout policies for grid. A layout maps N-dimensional coordinates
+// onto offsets into the grid's flat storage buffer. Each policy provides a
+// nested mapping<N> class template with the following interface:
+//
+//   void resize(const size_t* dims);        // recompute tables for new dims
+//   size_t storage_size() const;            // number of elements to allocate
+//   size_t offset(const size_t* c) const;   // storage offset of coordinates c
+//
+// and a contiguous_rows constant that is true iff consecutive coordinates
+// along the innermost dimension are adjacent in storage (which enables
+// pointer-walking iteration and row-wise bulk operations). The id and param
+// constants identify the layout in persistent formats.
+
+/// Row-major (C order) storage; the last coordinate varies fastest.
+struct row_major
+{
+    static const bool contiguous_rows = true;
+    static const unsigned id = 0;
+    static const unsigned param = 0;
+
+    template <int N> class mapping;
+};
+
+/// Storage in cubic bricks of B^N elements. Bricks are stored in row-major
+/// order and elements are stored in row-major order within each brick, so
+/// that neighbors along any dimension are usually within the same few cache
+/// lines. B must be a power of two. Dimensions are padded up to a multiple of
+/// B.
+template <size_t B = 8>
+struct tiled
+{
+    static_assert(B > 0 && !(B & (B - 1)), "Brick size must be a power of two");
+
+    static const bool contiguous_rows = false;
+    static const unsigned id = 1;
+    static const unsigned param = B;
+
+    template <int N> class mapping;
+};
+
+/// Z-order (Morton) storage. Coordinates are bit-interleaved within cubic
+/// bricks whose edge is the smallest power of two covering the smallest
+/// dimension, and those bricks are stored in row-major order. For grids whose
+/// dimensions are all the same power of two this is a pure Morton order; for
+/// anisotropic grids it avoids padding every dimension out to the largest.
+/// Computing an offset costs a bit-interleave per coordinate, so tiled is
+/// usually the better choice unless accesses are scattered across many bricks.
+struct morton
+{
+    static const bool contiguous_rows = false;
+    static const unsigned id = 2;
+    static const unsigned param = 0;
+
+    template <int N> class mapping;
+};
+
+/// Dot product of a coordinate array with a stride table, unrolled at compile
+/// time.
+template <int N, int DIM = 0>
+struct StrideDot
+{
+    size_t operator()(const size_t* strides, const size_t* c) const
+    {
+        return strides[DIM] * c[DIM] + StrideDot<N, DIM + 1>()(strides, c);
+    }
+};
+
+template <int N>
+struct StrideDot<N, N>
+{
+    size_t operator()(const size_t* strides, const size_t* c) const
+    {
+        return 0;
+    }
+};
+
+template <int N>
+class row_major::mapping
+{
+public:
+
+    void resize(const size_t* dims);
+
+    size_t storage_size() const { return size_; }
+
+    size_t offset(const size_t* c) const
+    {
+        return StrideDot<N>()(strides_, c);
+    }
+
+    size_t stride(size_t dim) const { return strides_[dim]; }
+
+private:
+
+    size_t strides_[N];
+    size_t size_;
+};
+
+// Shared bookkeeping for layouts that store a row-major grid of cubic bricks
+// of (1 << shift)^N elements each.
+template <int N>
+class brick_mapping
+{
+public:
+
+    size_t storage_size() const { return size_; }
+
+protected:
+
+    size_t shift_;
+    size_t mask_;
+    size_t brick_strides_[N];
+    size_t size_;
+
+    void resize(const size_t* dims, size_t shift);
+};
+
+template <size_t B>
+template <int N>
+class tiled<B>::mapping : public brick_mapping<N>
+{
+public:
+
+    void resize(const size_t* dims);
+
+    size_t offset(const size_t* c) const;
+};
+
+template <int N>
+class morton::mapping : public brick_mapping<N>
+{
+public:
+
+    void resize(const size_t* dims);
+
+    size_t offset(const size_t* c) const;
+};
+
+} // namespace au
+
+#include "detail/layout.h"
+
+#endif
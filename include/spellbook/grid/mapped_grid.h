@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_mapped_grid_h
+#define au_mapped_grid_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// On-disk header of a mapped grid file. Fields are stored in host byte order.
+/// The element data begins at data_offset, which is a multiple of the page
+/// size so that the data may be mapped directly, and is laid out exactly as
+/// the storage buffer of a grid with the recorded layout.
+struct mapped_grid_header
+{
+    static const uint32_t current_version = 1;
+    static const uint32_t max_dims = 8;
+
+    char        magic[8];       // "AUGRID\0\0"
+    uint32_t    version;
+    uint32_t    num_dims;
+    uint32_t    element_size;
+    uint32_t    layout_id;
+    uint32_t    layout_param;
+    uint32_t    reserved;
+    uint64_t    dims[max_dims];
+    uint64_t    data_offset;
+    uint64_t    data_size;
+};
+
+/// A read-only or copy-on-write grid backed by a memory-mapped file written by
+/// save_mapped_grid(). Opening a file only maps it; elements are loaded from
+/// disk lazily by the page fault handler as they are first touched, so the
+/// cost of open() does not depend on the size of the grid.
+///
+/// In copy_on_write mode elements may be modified; modified pages are private
+/// to the process and are never written back to the file. In read_only mode
+/// the pages are shared with the page cache and writing an element faults.
+template <int N, typename T, typename Layout = row_major>
+class mapped_grid
+{
+public:
+
+    static_assert(N <= (int)mapped_grid_header::max_dims, "Too many dimensions for mapped_grid");
+
+    typedef size_t              size_type;
+    typedef T                   value_type;
+    typedef T&                  reference;
+    typedef const T&            const_reference;
+    typedef Layout              layout_type;
+    typedef grid_index<N, T>    index;
+
+    enum mode_type
+    {
+        read_only,
+        copy_on_write
+    };
+
+    mapped_grid();
+
+    mapped_grid(mapped_grid&& other);
+    mapped_grid& operator=(mapped_grid&& rhs);
+
+    mapped_grid(const mapped_grid&) = delete;
+    mapped_grid& operator=(const mapped_grid&) = delete;
+
+    ~mapped_grid();
+
+    /// Map a grid file. Fails if the file cannot be mapped or its header does
+    /// not match N, sizeof(T), and Layout. Only the element size is recorded,
+    /// so element types of the same size are not distinguished.
+    bool open(const std::string& path, mode_type mode = read_only);
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    bool writable() const { return mode_ == copy_on_write; }
+
+    /// \name Element access
+    ///@{
+    template <typename... CoordTypes>
+    reference operator()(CoordTypes... coords);
+
+    template <typename... CoordTypes>
+    const_reference operator()(CoordTypes... coords) const;
+
+    reference operator()(const index& i);
+    const_reference operator()(const index& i) const;
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    template <typename... CoordTypes>
+    bool within_bounds(CoordTypes... coords) const;
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return dims_[dim]; }
+    size_type total_size() const;
+    size_type storage_size() const { return is_open() ? layout_.storage_size() : 0; }
+    ///@}
+
+private:
+
+    typedef typename Layout::template mapping<N> mapping_type;
+
+    void*           base_;
+    size_type       length_;
+    mode_type       mode_;
+    T*              data_;
+    size_type       dims_[N];
+    mapping_type    layout_;
+
+    void reset();
+};
+
+/// Write a grid to a file that can be mapped by mapped_grid. Returns false if
+/// the file could not be written.
+template <int N, typename T, typename Layout, typename Allocator>
+bool save_mapped_grid(
+    const std::string& path,
+    const grid<N, T, Layout, Allocator>& g);
+
+} // namespace au
+
+#include "detail/mapped_grid.h"
+
+#endif
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_metric_grid_h
+#define au_metric_grid_h
+
+#include <stddef.h>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// The placement of a grid in the world: the world coordinates of the
+/// minimum corner of cell 0 and the edge length of each cell. Cell c covers
+/// the world region [origin + c * resolution, origin + (c + 1) * resolution)
+/// along each dimension, and its center is at origin + (c + 0.5) * resolution.
+///
+/// The batched conversions operate on arrays of points whose coordinates
+/// are stride elements apart (e.g. 4 for padded xyz point cloud points) and
+/// have no per-point branches, so that the compiler can vectorize them.
+template <int N>
+class grid_frame
+{
+public:
+
+    grid_frame();
+    grid_frame(const double* origin, double resolution);
+
+    const double* origin() const { return origin_; }
+    double origin(int dim) const { return origin_[dim]; }
+    void set_origin(const double* origin);
+
+    double resolution() const { return resolution_; }
+    void set_resolution(double res);
+
+    /// Compute the coordinates of the cell containing a world point. A
+    /// coordinate that is NaN, infinite, or too far from the origin to be
+    /// represented maps to a cell that is outside every grid.
+    void world_to_grid(const double* p, ptrdiff_t* c) const;
+
+    /// Compute the world coordinates of the center of a cell.
+    void grid_to_world(const ptrdiff_t* c, double* p) const;
+
+    /// Convert count points to cells, storing N coordinates per cell.
+    template <typename Real>
+    void world_to_grid(const Real* points, size_t count, size_t stride, ptrdiff_t* cells) const;
+
+    /// Convert count cells, of N coordinates each, to the world coordinates
+    /// of their centers.
+    template <typename Real>
+    void grid_to_world(const ptrdiff_t* cells, size_t count, Real* points, size_t stride) const;
+
+private:
+
+    double origin_[N];
+    double resolution_;
+    double inv_resolution_;
+};
+
+/// A grid with a frame relating its cells to world coordinates.
+template <int N, typename T, typename Layout = row_major, typename Allocator = aligned_allocator<>>
+class metric_grid
+{
+public:
+
+    typedef grid<N, T, Layout, Allocator>   grid_type;
+    typedef grid_frame<N>                   frame_type;
+    typedef typename grid_type::index       index;
+    typedef size_t                          size_type;
+
+    metric_grid();
+
+    template <typename... SizeTypes>
+    metric_grid(const frame_type& frame, SizeTypes... sizes);
+
+    /// \name Element access
+    ///@{
+    grid_type& cells() { return grid_; }
+    const grid_type& cells() const { return grid_; }
+
+    /// Return the cell containing a world point, or null if the point is
+    /// outside the grid.
+    T* find(const double* p);
+    const T* find(const double* p) const;
+    ///@}
+
+    /// \name World coordinates
+    ///@{
+    const frame_type& frame() const { return frame_; }
+    void set_frame(const frame_type& frame) { frame_ = frame; }
+
+    double resolution() const { return frame_.resolution(); }
+
+    /// Compute the index of the cell containing a world point. Return false
+    /// if the point is outside the grid.
+    bool world_to_grid(const double* p, index& i) const;
+
+    /// Compute the world coordinates of the center of a cell.
+    void grid_to_world(const index& i, double* p) const;
+
+    /// Assign value to the cells containing each of count points, whose
+    /// coordinates are stride elements apart, and return the number of
+    /// points inside the grid.
+    template <typename Real>
+    size_type insert(const Real* points, size_type count, size_type stride, const T& value);
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return grid_.size(dim); }
+    size_type total_size() const { return grid_.total_size(); }
+    ///@}
+
+private:
+
+    grid_type   grid_;
+    frame_type  frame_;
+
+    bool to_index(const ptrdiff_t* c, index& i) const;
+};
+
+} // namespace au
+
+#include "detail/metric_grid.h"
+
+#endif
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_morphology_h
+#define au_morphology_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "distance_transform.h"
+#include "grid.h"
+#include "parallel.h"
+
+namespace au
+{
+
+/// \name Morphological filters
+///
+/// Grayscale dilation and erosion with box-shaped structuring elements, and
+/// binary inflation with disc- (or sphere-) shaped ones.
+///
+/// dilate() and erode() replace each cell with the maximum (minimum) of the
+/// box of half-widths radii[i] centered on it, clipped to the grid. They are
+/// separable and apply the van Herk/Gil-Werman algorithm along each
+/// dimension, which costs three comparisons per cell regardless of the
+/// radius; the lines of each pass are distributed over a thread pool. dst is
+/// resized to match src and may be the same grid.
+///
+/// inflate() marks the cells within radius (in cells) of an obstacle, where
+/// a cell is an obstacle if is_obstacle(value) is true (by default, any
+/// value other than T()). A disc is not separable, so inflation thresholds
+/// the exact Euclidean distance transform instead, which is also linear in
+/// the number of cells. inflate_region() updates an inflated grid after the
+/// cells of src in a box have changed, recomputing only the cells within
+/// radius of the box.
+///@{
+
+template <int N, typename T, typename Allocator, typename DstAllocator>
+void dilate(
+    const grid<N, T, row_major, Allocator>& src,
+    grid<N, T, row_major, DstAllocator>& dst,
+    const size_t* radii,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Allocator, typename DstAllocator>
+void erode(
+    const grid<N, T, row_major, Allocator>& src,
+    grid<N, T, row_major, DstAllocator>& dst,
+    const size_t* radii,
+    thread_pool& pool = default_thread_pool());
+
+/// Set each cell of dst to 1 if it is within radius of an obstacle and to 0
+/// otherwise.
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void inflate(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    Predicate is_obstacle,
+    thread_pool& pool = default_thread_pool());
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void inflate(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    thread_pool& pool = default_thread_pool());
+
+/// Update dst, the inflation of src, after the cells of src in the inclusive
+/// box [start, end] changed.
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator, typename Predicate>
+void inflate_region(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Predicate is_obstacle);
+
+template <int N, typename T, typename Layout, typename Allocator, typename DstAllocator>
+void inflate_region(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, uint8_t, row_major, DstAllocator>& dst,
+    double radius,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end);
+///@}
+
+} // namespace au
+
+#include "detail/morphology.h"
+
+#endif
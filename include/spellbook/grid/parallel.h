@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_grid_parallel_h
+#define au_grid_parallel_h
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// A fixed-size pool of worker threads that runs fork-join loops. The calling
+/// thread participates in each loop, so a pool of size n starts n - 1
+/// workers. Loops submitted concurrently from different threads are run one
+/// at a time; a loop submitted from inside a loop body runs serially on the
+/// calling thread.
+class thread_pool
+{
+public:
+
+    /// \param num_threads The total number of threads, including the caller,
+    ///     that execute each loop. Defaults to the hardware concurrency.
+    explicit thread_pool(size_t num_threads = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    /// Call fn(i) for each i in [0, count) and return once all calls have
+    /// returned. If any call throws, one of the exceptions is rethrown after
+    /// the loop completes.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_mutex_;   // serializes concurrent parallel_for calls
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    unsigned long long generation_;
+    size_t busy_;               // workers currently running tasks
+
+    const std::function<void(size_t)>* job_;
+    size_t job_count_;
+    std::atomic<size_t> next_;
+    std::exception_ptr error_;
+
+    void worker_loop();
+    void run_tasks(const std::function<void(size_t)>* job, size_t count);
+};
+
+/// Return a process-wide pool sized to the hardware concurrency.
+thread_pool& default_thread_pool();
+
+/// \name Parallel algorithms
+///
+/// Split the inclusive box [start, end] into slabs along the outermost
+/// dimension and process the slabs on a thread pool. Elements are visited in
+/// row-major order within each slab; the order across slabs is unspecified.
+///@{
+
+/// Call fn(i, g(i)) for each index i in the box, where i is a grid_index.
+/// Calls for distinct elements may run concurrently.
+template <int N, typename T, typename Layout, typename Allocator, typename Function>
+void parallel_for_each(
+    grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    Function fn,
+    thread_pool& pool = default_thread_pool());
+
+/// Assign dst(i) = op(src(i)) for every index i in the box, as transform().
+template <int N, typename T, typename U, typename Layout, typename Allocator, typename DstAllocator, typename UnaryOperation>
+void parallel_transform(
+    const grid<N, T, Layout, Allocator>& src,
+    grid<N, U, Layout, DstAllocator>& dst,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    UnaryOperation op,
+    thread_pool& pool = default_thread_pool());
+
+/// Combine every element in the box with op, which must be associative and
+/// commutative. Each slab is folded from identity as acc = op(acc, g(i)) and
+/// the per-slab results are then folded from identity with op, so identity
+/// must be an identity element of op (e.g. 0 for a sum).
+template <int N, typename T, typename Layout, typename Allocator, typename R, typename BinaryOperation>
+R parallel_reduce(
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    R identity,
+    BinaryOperation op,
+    thread_pool& pool = default_thread_pool());
+///@}
+
+} // namespace au
+
+#include "detail/parallel.h"
+
+#endif
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_pyramid_h
+#define au_pyramid_h
+
+#include <stddef.h>
+#include <functional>
+#include <vector>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// A stack of successively coarser copies of a grid, in which each cell of
+/// level k + 1 holds the greatest, under Compare, of the (up to) 2^N cells of
+/// level k that it covers. With the default Compare each level is a 2x
+/// max-pooled copy of the one below; with std::greater it is min-pooled.
+/// Level 0 is the full-resolution base grid and the last level is a single
+/// cell.
+///
+/// Box queries start at the coarsest level and descend only into cells that
+/// straddle the box boundary and could still change the answer, so they
+/// touch a number of cells proportional to the box's surface rather than its
+/// volume, and any_at_least() can stop at the first coarse cell that answers
+/// it.
+///
+/// After modifying the base grid, call update() with the modified box (or
+/// rebuild()) before querying.
+template <int N, typename T, typename Compare = std::less<T>>
+class grid_pyramid
+{
+public:
+
+    typedef size_t          size_type;
+    typedef grid<N, T>      grid_type;
+    typedef grid_index<N, T> index;
+
+    grid_pyramid();
+
+    template <typename... SizeTypes>
+    grid_pyramid(SizeTypes... sizes);
+
+    explicit grid_pyramid(const grid_type& base, const Compare& comp = Compare());
+
+    /// \name Levels
+    ///@{
+    grid_type& base() { return levels_[0]; }
+    const grid_type& base() const { return levels_[0]; }
+
+    const grid_type& level(size_type k) const { return levels_[k]; }
+    size_type num_levels() const { return levels_.size(); }
+    ///@}
+
+    /// \name Queries
+    ///
+    /// Boxes are inclusive and in base-level coordinates.
+    ///@{
+
+    /// Return the greatest value, under Compare, in the box [start, end].
+    T reduce(const index& start, const index& end) const;
+
+    /// Return whether any cell in the box [start, end] is not less than
+    /// value under Compare (with the default Compare, whether any cell is
+    /// >= value; with std::greater, whether any cell is <= value).
+    bool any_at_least(const index& start, const index& end, const T& value) const;
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+
+    /// Replace the base grid and rebuild the coarser levels.
+    void assign(const grid_type& base);
+
+    /// Resize the base grid, discarding its contents, and rebuild.
+    template <typename... SizeTypes>
+    void resize(SizeTypes... sizes);
+
+    /// Recompute the coarser levels over the base-level box [start, end].
+    void update(const index& start, const index& end);
+
+    /// Recompute every coarser level.
+    void rebuild();
+    ///@}
+
+private:
+
+    std::vector<grid_type>  levels_;
+    Compare                 comp_;
+
+    void allocate_levels();
+
+    // recompute the cells of level k in the box [start, end] from level k - 1
+    void pool(size_type k, const index& start, const index& end);
+
+    // the parts of the queries below the coarsest level; c is a cell of
+    // level k, and found tells whether best holds a value yet
+    void reduce(size_type k, const size_type* c, const index& start, const index& end, T& best, bool& found) const;
+    bool any_at_least(size_type k, const size_type* c, const index& start, const index& end, const T& value) const;
+};
+
+/// Pyramids whose levels are max-pooled and min-pooled, respectively.
+template <int N, typename T>
+using max_pyramid = grid_pyramid<N, T, std::less<T>>;
+
+template <int N, typename T>
+using min_pyramid = grid_pyramid<N, T, std::greater<T>>;
+
+} // namespace au
+
+#include "detail/pyramid.h"
+
+#endif
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_rolling_grid_h
+#define au_rolling_grid_h
+
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+#include "grid.h"
+
+namespace au
+{
+
+/// Whether every type in Ts is arithmetic. Constrains the coordinate-list
+/// overloads so that a coordinate array selects the pointer overloads
+/// instead of being taken as a single coordinate.
+template <typename... Ts>
+struct AllArithmetic;
+
+template <>
+struct AllArithmetic<> : std::true_type { };
+
+template <typename T, typename... Ts>
+struct AllArithmetic<T, Ts...> :
+    std::integral_constant<bool, std::is_arithmetic<T>::value && AllArithmetic<Ts...>::value>
+{ };
+
+/// A fixed-size window onto an unbounded N-dimensional grid, stored as a ring
+/// buffer, for local maps that follow a moving robot.
+///
+/// Cells are addressed by signed global coordinates, which stay attached to
+/// the same place in the world as the window moves. The window covers the
+/// cells [origin(i), origin(i) + size(i)) along each dimension. Shifting the
+/// window moves the start of the ring buffer along each dimension instead of
+/// moving any elements, so a shift costs time proportional to the number of
+/// cells that enter the window, which are reset to the background value and
+/// reported as boxes so the caller can refill only those.
+///
+/// The cell with global coordinates c covers the world region
+/// [c * resolution, (c + 1) * resolution) along each dimension.
+template <int N, typename T, typename Allocator = aligned_allocator<>>
+class rolling_grid
+{
+public:
+
+    typedef size_t      size_type;
+    typedef T           value_type;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+
+    typedef grid<N, T, row_major, Allocator> storage_type;
+
+    /// An inclusive box of global cell coordinates.
+    struct box
+    {
+        ptrdiff_t min[N];
+        ptrdiff_t max[N];
+    };
+
+    rolling_grid();
+
+    template <typename... SizeTypes>
+    rolling_grid(SizeTypes... sizes);
+
+    /// \name Element access
+    ///
+    /// Coordinates are global cell coordinates within the window.
+    ///@{
+    template <typename... CoordTypes>
+    typename std::enable_if<AllArithmetic<CoordTypes...>::value, reference>::type
+    operator()(CoordTypes... coords);
+
+    template <typename... CoordTypes>
+    typename std::enable_if<AllArithmetic<CoordTypes...>::value, const_reference>::type
+    operator()(CoordTypes... coords) const;
+
+    reference operator()(const ptrdiff_t* c) { return storage_.data()[storage_offset(c)]; }
+    const_reference operator()(const ptrdiff_t* c) const { return storage_.data()[storage_offset(c)]; }
+
+    template <typename... CoordTypes>
+    typename std::enable_if<AllArithmetic<CoordTypes...>::value, bool>::type
+    within_bounds(CoordTypes... coords) const;
+
+    bool within_bounds(const ptrdiff_t* c) const;
+
+    /// Return the underlying ring buffer, whose element at storage
+    /// coordinates s holds the cell whose global coordinates are congruent to
+    /// s modulo the window size.
+    const storage_type& storage() const { return storage_; }
+
+    const T& background() const { return background_; }
+    void set_background(const T& value) { background_ = value; }
+    ///@}
+
+    /// \name World coordinates
+    ///@{
+    double resolution() const { return resolution_; }
+    void set_resolution(double res) { resolution_ = res; }
+
+    /// Return the global coordinates of the cell containing a world point.
+    void world_to_cell(const double* p, ptrdiff_t* c) const;
+
+    /// Return the world coordinates of the center of a cell.
+    void cell_to_world(const ptrdiff_t* c, double* p) const;
+    ///@}
+
+    /// \name Window
+    ///@{
+    size_type size(size_type dim) const { return storage_.size(dim); }
+    size_type total_size() const { return storage_.total_size(); }
+
+    ptrdiff_t origin(size_type dim) const { return origin_[dim]; }
+
+    /// Move the window by delta cells along each dimension. Cells that enter
+    /// the window are set to the background value and, if invalidated is not
+    /// null, appended to it as disjoint boxes.
+    void shift(const ptrdiff_t* delta, std::vector<box>* invalidated = nullptr);
+
+    /// Move the window so that its first cell is at origin.
+    void shift_to(const ptrdiff_t* origin, std::vector<box>* invalidated = nullptr);
+
+    /// Move the window so that the cell containing a world point is at
+    /// offset size(i) / 2 from the window origin along each dimension.
+    void recenter(const double* p, std::vector<box>* invalidated = nullptr);
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+    void clear();
+
+    /// Resize the window, leaving its origin unchanged, and set every cell to
+    /// the background value.
+    template <typename... SizeTypes>
+    void resize(SizeTypes... sizes);
+
+    void assign(const T& value) { storage_.assign(value); }
+    ///@}
+
+private:
+
+    storage_type    storage_;
+    ptrdiff_t       origin_[N];
+
+    // storage coordinates of the cell at the window origin
+    size_type       head_[N];
+
+    T               background_;
+    double          resolution_;
+
+    size_type storage_offset(const ptrdiff_t* c) const;
+
+    void fill_box(const box& b);
+};
+
+} // namespace au
+
+#include "detail/rolling_grid.h"
+
+#endif
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_grid_serialization_h
+#define au_grid_serialization_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iosfwd>
+#include <string>
+
+#include "grid.h"
+
+namespace au
+{
+
+// Binary snapshot format for grids. A snapshot is a header recording the
+// dimensions and element type followed by a sequence of chunks, each holding
+// the elements of a slab of consecutive rows along the outermost dimension in
+// row-major order, so that snapshots do not depend on the storage layout of
+// the grid that wrote them. Each chunk carries a CRC-32 of its elements and is
+// stored either verbatim or run-length encoded, whichever is smaller. Values
+// are stored in host byte order; readers reject snapshots written with a
+// different byte order.
+//
+// Reading a row-major grid decodes each chunk directly into the grid's
+// storage, so loading is limited by the bandwidth of the stream rather than
+// by per-element calls.
+
+struct grid_write_options
+{
+    /// Run-length encode chunks that get smaller by doing so.
+    bool compress;
+
+    /// Approximate number of bytes of element data per chunk. Smaller chunks
+    /// make partial reads of small regions cheaper.
+    size_t chunk_size;
+
+    grid_write_options() : compress(true), chunk_size(1 << 20) { }
+};
+
+/// Write a snapshot of a grid to a stream. Returns false if the stream fails.
+template <int N, typename T, typename Layout, typename Allocator>
+bool write_grid(
+    std::ostream& os,
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_write_options& options = grid_write_options());
+
+/// Read a snapshot into a grid, resizing it to the snapshot's dimensions.
+/// Returns false if the stream fails, the snapshot does not hold elements of
+/// type T with N dimensions, or a chunk is corrupt.
+template <int N, typename T, typename Layout, typename Allocator>
+bool read_grid(std::istream& is, grid<N, T, Layout, Allocator>& g);
+
+/// Read the inclusive box [start, end] of a snapshot into a grid, resizing it
+/// to the size of the box. Chunks that do not overlap the box are skipped
+/// without being decoded.
+template <int N, typename T, typename Layout, typename Allocator>
+bool read_grid_region(
+    std::istream& is,
+    const grid_index<N, T>& start,
+    const grid_index<N, T>& end,
+    grid<N, T, Layout, Allocator>& g);
+
+/// \name File convenience wrappers
+///@{
+template <int N, typename T, typename Layout, typename Allocator>
+bool save_grid(
+    const std::string& path,
+    const grid<N, T, Layout, Allocator>& g,
+    const grid_write_options& options = grid_write_options());
+
+template <int N, typename T, typename Layout, typename Allocator>
+bool load_grid(const std::string& path, grid<N, T, Layout, Allocator>& g);
+///@}
+
+} // namespace au
+
+#include "detail/serialization.h"
+
+#endif
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_sparse_grid_h
+#define au_sparse_grid_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+
+#include "grid.h"
+
+namespace au
+{
+
+template <int N, typename T, size_t B = 8> class sparse_grid;
+template <int N, typename T, size_t B = 8> class sparse_grid_iterator;
+
+/// A bounded N-dimensional grid that stores its elements in dense cubic
+/// blocks of B^N elements, allocated on demand and looked up in a hash table
+/// keyed by block coordinate. Elements in unallocated blocks read as the
+/// background value, so memory use is proportional to the number of blocks
+/// that have been written rather than to the volume of the grid.
+///
+/// Non-const element access allocates the containing block if necessary;
+/// const element access never allocates. Each thread keeps a cache of the
+/// last block it accessed, so runs of accesses within a block skip the hash
+/// lookup. Concurrent const access is safe, as are concurrent writes to
+/// elements of already-allocated blocks, but allocating blocks requires
+/// external synchronization.
+///
+/// \tparam B The block edge length; must be a power of two.
+template <int N, typename T, size_t B>
+class sparse_grid
+{
+    friend class sparse_grid_iterator<N, T, B>;
+
+public:
+
+    static_assert(B > 0 && !(B & (B - 1)), "Block size must be a power of two");
+
+    typedef size_t                              size_type;
+    typedef T                                   value_type;
+    typedef T&                                  reference;
+    typedef const T&                            const_reference;
+
+    typedef sparse_grid_iterator<N, T, B>       iterator;
+    typedef const sparse_grid_iterator<N, T, B> const_iterator;
+
+    typedef grid_index<N, T>                    index;
+
+    /// The number of elements in each block.
+    static const size_type block_size = (size_type)1 << (N * BrickShift<B>::value);
+
+    sparse_grid();
+
+    template <typename... SizeTypes>
+    sparse_grid(SizeTypes... sizes);
+
+    sparse_grid(const sparse_grid& other);
+    sparse_grid& operator=(const sparse_grid& rhs);
+
+    sparse_grid(sparse_grid&& other);
+    sparse_grid& operator=(sparse_grid&& rhs);
+
+    /// \name Element access
+    ///@{
+    template <typename... CoordTypes>
+    reference operator()(CoordTypes... coords);
+
+    template <typename... CoordTypes>
+    const_reference operator()(CoordTypes... coords) const;
+
+    reference operator()(const index& i);
+    const_reference operator()(const index& i) const;
+
+    template <typename... CoordTypes>
+    bool within_bounds(CoordTypes... coords) const;
+
+    /// Return whether the block containing an element has been allocated.
+    bool is_allocated(const index& i) const;
+
+    const T& background() const { return background_; }
+    void set_background(const T& value) { background_ = value; }
+    ///@}
+
+    /// \name Iterators
+    ///
+    /// Visit every element of every allocated block, in no particular order.
+    ///@{
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    ///@}
+
+    /// \name Capacity
+    ///@{
+    size_type size(size_type dim) const { return dims_[dim]; }
+    size_type total_size() const;
+
+    size_type num_blocks() const { return blocks_.size(); }
+
+    /// Return the approximate number of bytes used by the grid, including the
+    /// allocated blocks and the hash table.
+    size_type memory_usage() const;
+    ///@}
+
+    /// \name Modifiers
+    ///@{
+
+    /// Free all blocks; every element reads as the background value.
+    void clear();
+
+    /// Resize the grid and free all blocks.
+    template <typename... SizeTypes>
+    void resize(SizeTypes... sizes);
+    ///@}
+
+private:
+
+    typedef std::unordered_map<size_type, std::unique_ptr<T[]>> block_map;
+
+    // the last block accessed by the current thread (null if the block is not
+    // allocated); valid only while the owning grid has id owner
+    struct block_cache
+    {
+        uint64_t    owner;
+        size_type   key;
+        T*          block;
+    };
+
+    static thread_local block_cache cache_;
+
+    static const size_type shift = BrickShift<B>::value;
+    static const size_type mask = B - 1;
+
+    // unique across all sparse grids and renewed whenever blocks are
+    // allocated, freed, or change owner, so stale cache entries never match
+    uint64_t    id_;
+
+    size_type   dims_[N];
+    size_type   block_counts_[N];
+    size_type   block_strides_[N];
+    block_map   blocks_;
+    T           background_;
+
+    void set_dims(const size_type* dims);
+
+    size_type block_key(const size_type* c) const;
+    static size_type block_offset(const size_type* c);
+
+    T* find_block(size_type key) const;
+    T* find_or_create_block(size_type key);
+
+    void copy_blocks(const sparse_grid& other);
+};
+
+template <int N, typename T, size_t B>
+class sparse_grid_iterator : public std::iterator<std::forward_iterator_tag, T>
+{
+    friend class sparse_grid<N, T, B>;
+
+public:
+
+    typedef typename sparse_grid<N, T, B>::size_type    size_type;
+    typedef typename sparse_grid<N, T, B>::index        index;
+
+    sparse_grid_iterator();
+
+    /// \name Iterator API
+    ///@{
+    sparse_grid_iterator& operator++();
+    sparse_grid_iterator operator++(int);
+
+    bool operator==(const sparse_grid_iterator& other) const;
+    bool operator!=(const sparse_grid_iterator& other) const;
+
+    T& operator*() const { return block_[offset_]; }
+    T* operator->() const { return block_ + offset_; }
+    ///@}
+
+    const index& cindex() const { return curr_; }
+    size_type coord(size_type dim) const { return curr_(dim); }
+
+private:
+
+    typedef typename sparse_grid<N, T, B>::block_map::iterator block_iterator;
+
+    sparse_grid<N, T, B>* grid_;
+    block_iterator it_;
+    T* block_;
+    size_type offset_;  // offset of the current element within the block
+    index origin_;      // coordinates of the first element of the block
+    index curr_;
+
+    void enter_block();
+    bool advance_in_block();
+};
+
+} // namespace au
+
+#include "detail/sparse_grid.h"
+
+#endif
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_summed_area_table_h
+#define au_summed_area_table_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#include "grid.h"
+#include "parallel.h"
+
+namespace au
+{
+
+/// The accumulator type used for sums of T: double for floating-point types
+/// and 64-bit integers of the same signedness otherwise.
+template <typename T>
+struct default_sum_type
+{
+    typedef typename std::conditional<
+            std::is_floating_point<T>::value,
+            double,
+            typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type>::type type;
+};
+
+/// An N-dimensional summed-area table (integral image) of a grid, which
+/// answers the sum of the source elements in any box in constant time, with
+/// 2^N table lookups.
+///
+/// The table has one more element than the source along each dimension;
+/// table(c) holds the sum of the source elements in the box [0, c - 1], so
+/// that boxes touching the low edges need no special cases. Unsigned sums
+/// wrap on overflow, but box sums are still exact as long as the sum of the
+/// box itself fits. For the maximum over a box, see grid_pyramid.
+template <int N, typename T, typename Sum = typename default_sum_type<T>::type>
+class summed_area_table
+{
+public:
+
+    typedef size_t              size_type;
+    typedef Sum                 sum_type;
+    typedef grid_index<N, T>    index;
+    typedef grid<N, Sum>        table_type;
+
+    summed_area_table();
+
+    template <typename Layout, typename Allocator>
+    explicit summed_area_table(
+        const grid<N, T, Layout, Allocator>& src,
+        thread_pool& pool = default_thread_pool());
+
+    /// Return the sum of the source elements in the inclusive box
+    /// [start, end].
+    Sum sum(const index& start, const index& end) const;
+
+    /// Rebuild the table from a grid, with one pass per dimension, each
+    /// split across the threads of pool.
+    template <typename Layout, typename Allocator>
+    void assign(
+        const grid<N, T, Layout, Allocator>& src,
+        thread_pool& pool = default_thread_pool());
+
+    /// Update the table after the elements of src in the box [start, end]
+    /// changed. Every table entry at or beyond start along every dimension
+    /// covers a changed element, so the cost is proportional to that suffix
+    /// box, which is cheapest for changes near the high corner of the grid.
+    /// The changes are summed once, in time proportional to [start, end], and
+    /// then added to the suffix box on the threads of pool. When the suffix
+    /// box is more than half of the table, the table is rebuilt with assign()
+    /// instead.
+    template <typename Layout, typename Allocator>
+    void update(
+        const grid<N, T, Layout, Allocator>& src,
+        const index& start,
+        const index& end,
+        thread_pool& pool = default_thread_pool());
+
+    size_type size(size_type dim) const { return table_.size(dim) - 1; }
+
+    const table_type& table() const { return table_; }
+
+private:
+
+    table_type table_;
+};
+
+} // namespace au
+
+#include "detail/summed_area_table.h"
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef au_dary_heap_h
+#define au_dary_heap_h
+
+#include <cstddef>
+#include <functional>
+
+#include "intrusive_heap.h"
+
+namespace au {
+
+/// @brief A mutable d-ary heap of caller-owned elements with inline keys.
+///
+/// Like intrusive_heap, elements derive from heap_element and are referenced
+/// by pointer, and no allocation happens once reserve() has been called for
+/// the maximum size. Unlike intrusive_heap, each element's key is stored in
+/// the heap next to its pointer, so comparisons never dereference elements,
+/// and the storage is laid out so that the Arity children of a node are
+/// adjacent and start on a 64-byte boundary. With 8-byte keys and Arity = 4,
+/// choosing the smallest child in pop() reads exactly one cache line, and the
+/// tree is half as deep as a binary heap's.
+///
+/// Arity = 4 is the default: in test/heap_bench.cpp it is the fastest in
+/// grid A* and Dijkstra searches and on large heaps, although the open lists
+/// of grid searches stay small enough that the arities differ by only a few
+/// percent there. Arity = 2 gives a binary heap with the same layout.
+template <typename T, typename Key, typename Compare = std::less<Key>, int Arity = 4>
+class dary_heap
+{
+public:
+
+    static_assert(Arity >= 2, "Arity must be at least 2");
+
+    typedef T value_type;
+    typedef Key key_type;
+    typedef Compare compare;
+    typedef std::size_t size_type;
+
+    struct entry
+    {
+        Key key;
+        T* elem;
+    };
+
+    typedef const entry* const_iterator;
+
+    static const int arity = Arity;
+
+    explicit dary_heap(const compare& comp = compare());
+
+    dary_heap(const dary_heap&) = delete;
+    dary_heap& operator=(const dary_heap&) = delete;
+
+    dary_heap(dary_heap&& other);
+    dary_heap& operator=(dary_heap&& rhs);
+
+    ~dary_heap();
+
+    /// @{ Access
+    T* min() const;
+    T* top() const { return min(); }
+    const Key& min_key() const;
+    const Key& key(const T* e) const;
+    /// @}
+
+    /// @{ Iterators
+    const_iterator begin() const;
+    const_iterator end() const;
+    /// @}
+
+    /// @{ Capacity
+    bool empty() const;
+    size_type size() const;
+    void reserve(size_type new_cap);
+    /// @}
+
+    /// @{ Modifiers
+    void clear();
+    void push(T* e, const Key& key);
+    void pop();
+    bool contains(const T* e) const;
+    void update(T* e, const Key& key);
+    void increase(T* e, const Key& key);
+    void decrease(T* e, const Key& key);
+    void erase(T* e);
+    void swap(dary_heap& other);
+    /// @}
+
+private:
+
+    // The root is stored at index Arity - 1, which makes the children of the
+    // node at index i occupy [Arity * (i - Arity + 2), +Arity), a multiple of
+    // Arity. Index 0 is never used, so a heap index of 0 means "not in a heap".
+    static const size_type root = Arity - 1;
+
+    entry* m_data;
+    size_type m_end;
+    size_type m_capacity;
+    Compare m_comp;
+
+    static size_type first_child(size_type i) { return Arity * (i - Arity + 2); }
+    static size_type parent(size_type i) { return i / Arity + Arity - 2; }
+
+    void grow(size_type new_capacity);
+    void place(size_type i, const entry& x);
+    void percolate_down(size_type pivot, entry x);
+    void percolate_up(size_type pivot, entry x);
+};
+
+template <typename T, typename Key, typename Compare, int Arity>
+void swap(dary_heap<T, Key, Compare, Arity>& lhs, dary_heap<T, Key, Compare, Arity>& rhs);
+
+} // namespace au
+
+#include "detail/dary_heap.h"
+
+#endif
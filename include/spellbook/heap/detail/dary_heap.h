@@ -0,0 +1,287 @@
+#ifndef au_detail_dary_heap_h
+#define au_detail_dary_heap_h
+
+#include "../dary_heap.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <spellbook/memory/aligned_allocator.h>
+
+namespace au {
+
+template <typename T, typename Key, typename Compare, int Arity>
+dary_heap<T, Key, Compare, Arity>::dary_heap(const compare& comp) :
+    m_data(nullptr),
+    m_end(root),
+    m_capacity(0),
+    m_comp(comp)
+{
+    static_assert(std::is_trivially_copyable<Key>::value, "dary_heap keys must be trivially copyable");
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+dary_heap<T, Key, Compare, Arity>::dary_heap(dary_heap&& other) :
+    m_data(other.m_data),
+    m_end(other.m_end),
+    m_capacity(other.m_capacity),
+    m_comp(std::move(other.m_comp))
+{
+    other.m_data = nullptr;
+    other.m_end = root;
+    other.m_capacity = 0;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+dary_heap<T, Key, Compare, Arity>&
+dary_heap<T, Key, Compare, Arity>::operator=(dary_heap&& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        aligned_allocator<>::deallocate(m_data, m_capacity * sizeof(entry));
+        m_data = rhs.m_data;
+        m_end = rhs.m_end;
+        m_capacity = rhs.m_capacity;
+        m_comp = std::move(rhs.m_comp);
+        rhs.m_data = nullptr;
+        rhs.m_end = root;
+        rhs.m_capacity = 0;
+    }
+    return *this;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+dary_heap<T, Key, Compare, Arity>::~dary_heap()
+{
+    clear();
+    aligned_allocator<>::deallocate(m_data, m_capacity * sizeof(entry));
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+T* dary_heap<T, Key, Compare, Arity>::min() const
+{
+    assert(!empty());
+    return m_data[root].elem;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+const Key& dary_heap<T, Key, Compare, Arity>::min_key() const
+{
+    assert(!empty());
+    return m_data[root].key;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+const Key& dary_heap<T, Key, Compare, Arity>::key(const T* e) const
+{
+    assert(contains(e));
+    return m_data[e->m_heap_index].key;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+auto dary_heap<T, Key, Compare, Arity>::begin() const -> const_iterator
+{
+    return m_data + root;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+auto dary_heap<T, Key, Compare, Arity>::end() const -> const_iterator
+{
+    return m_data + m_end;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+bool dary_heap<T, Key, Compare, Arity>::empty() const
+{
+    return m_end == root;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+auto dary_heap<T, Key, Compare, Arity>::size() const -> size_type
+{
+    return m_end - root;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::reserve(size_type new_cap)
+{
+    if (new_cap + root > m_capacity) {
+        grow(new_cap + root);
+    }
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::clear()
+{
+    for (size_type i = root; i < m_end; ++i) {
+        m_data[i].elem->m_heap_index = 0;
+    }
+    m_end = root;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::push(T* e, const Key& key)
+{
+    assert(e && e->m_heap_index == 0);
+    if (m_end >= m_capacity) {
+        grow(std::max<size_type>(2 * m_capacity, root + 64));
+    }
+    entry x = { key, e };
+    percolate_up(m_end++, x);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::pop()
+{
+    assert(!empty());
+    m_data[root].elem->m_heap_index = 0;
+    --m_end;
+    if (!empty()) {
+        percolate_down(root, m_data[m_end]);
+    }
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+bool dary_heap<T, Key, Compare, Arity>::contains(const T* e) const
+{
+    const size_type i = e->m_heap_index;
+    return i >= root && i < m_end && m_data[i].elem == e;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::update(T* e, const Key& key)
+{
+    assert(contains(e));
+    const size_type i = e->m_heap_index;
+    entry x = { key, e };
+    if (i != root && m_comp(key, m_data[parent(i)].key)) {
+        percolate_up(i, x);
+    }
+    else {
+        percolate_down(i, x);
+    }
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::increase(T* e, const Key& key)
+{
+    assert(contains(e));
+    entry x = { key, e };
+    percolate_down(e->m_heap_index, x);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::decrease(T* e, const Key& key)
+{
+    assert(contains(e));
+    entry x = { key, e };
+    percolate_up(e->m_heap_index, x);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::erase(T* e)
+{
+    assert(contains(e));
+    const size_type i = e->m_heap_index;
+    e->m_heap_index = 0;
+    --m_end;
+    if (i != m_end) {
+        const entry last = m_data[m_end];
+        if (i != root && m_comp(last.key, m_data[parent(i)].key)) {
+            percolate_up(i, last);
+        }
+        else {
+            percolate_down(i, last);
+        }
+    }
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::swap(dary_heap& other)
+{
+    using std::swap;
+    swap(m_data, other.m_data);
+    swap(m_end, other.m_end);
+    swap(m_capacity, other.m_capacity);
+    swap(m_comp, other.m_comp);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::grow(size_type new_capacity)
+{
+    entry* data = (entry*)aligned_allocator<>::allocate(new_capacity * sizeof(entry));
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    std::copy(m_data + root, m_data + m_end, data + root);
+    aligned_allocator<>::deallocate(m_data, m_capacity * sizeof(entry));
+    m_data = data;
+    m_capacity = new_capacity;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::place(size_type i, const entry& x)
+{
+    m_data[i] = x;
+    x.elem->m_heap_index = i;
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::percolate_down(size_type pivot, entry x)
+{
+    for (;;) {
+        const size_type first = first_child(pivot);
+        if (first >= m_end) {
+            break;
+        }
+
+        // smallest child; a full group has a fixed trip count
+        size_type best = first;
+        if (first + Arity <= m_end) {
+            for (int k = 1; k < Arity; ++k) {
+                best = m_comp(m_data[first + k].key, m_data[best].key) ? first + k : best;
+            }
+        }
+        else {
+            for (size_type c = first + 1; c < m_end; ++c) {
+                if (m_comp(m_data[c].key, m_data[best].key)) {
+                    best = c;
+                }
+            }
+        }
+
+        if (!m_comp(m_data[best].key, x.key)) {
+            break;
+        }
+        place(pivot, m_data[best]);
+        pivot = best;
+    }
+    place(pivot, x);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void dary_heap<T, Key, Compare, Arity>::percolate_up(size_type pivot, entry x)
+{
+    while (pivot != root) {
+        const size_type p = parent(pivot);
+        if (!m_comp(x.key, m_data[p].key)) {
+            break;
+        }
+        place(pivot, m_data[p]);
+        pivot = p;
+    }
+    place(pivot, x);
+}
+
+template <typename T, typename Key, typename Compare, int Arity>
+void swap(dary_heap<T, Key, Compare, Arity>& lhs, dary_heap<T, Key, Compare, Arity>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+} // namespace au
+
+#endif
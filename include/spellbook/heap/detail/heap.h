@@ -25,12 +25,24 @@ static inline bool ispow2(std::size_t val)
     return !(val & (val - 1));
 }
 
+template <typename T, typename Compare>
+const typename heap<T, Compare>::size_type heap<T, Compare>::bulk_block_size;
+
 template <typename T, typename Compare>
 heap<T, Compare>::heap(const Compare& comp, const std::vector<value_type>& elements) :
-    m_elements(),
+    m_elements(1),
+    m_comp(comp)
+{
+    assign(elements.begin(), elements.end());
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+heap<T, Compare>::heap(InputIt first, InputIt last, const Compare& comp) :
+    m_elements(1),
     m_comp(comp)
 {
-    make_heap(elements);
+    assign(first, last);
 }
 
 template <typename T, typename Compare>
@@ -89,7 +101,7 @@ void heap<T, Compare>::clear()
         std::shared_ptr<element_type>& elem = m_elements[i];
         pos(*elem) = 0;
     }
-    this->make_heap({});
+    m_elements.resize(1);
 }
 
 template <typename T, typename Compare>
@@ -111,10 +123,10 @@ void heap<T, Compare>::pop()
 {
     // todo: inverse percolate up for cache performance?
     std::shared_ptr<element_type> tmp = m_elements[1];
-    pos(*tmp) = 0;
 
     m_elements[1] = m_elements.back();
     pos(*m_elements[1]) = 1;
+    pos(*tmp) = 0; // after the move, in case tmp was the last element
 
     m_elements.pop_back();
     percolate_down(1);
@@ -190,13 +202,20 @@ void heap<T, Compare>::erase(const handle_type& handle)
 {
     // todo: see pop()
     if (handle.elem_) {
-        size_type pos = pos(*handle.elem_);
-        std::shared_ptr<element_type>& top = m_elements[pos];
-        m_elements[pos] = m_elements.back();
-        pos(*m_elements[pos]) = pos;
+        size_type p = pos(*handle.elem_);
+        std::shared_ptr<element_type> top = m_elements[p];
+        m_elements[p] = m_elements.back();
+        pos(*m_elements[p]) = p;
         pos(*top) = 0;
         m_elements.pop_back();
-        percolate_down(pos);
+        if (is_internal(p)) {
+            if (p != 1 && m_comp(value(*m_elements[p]), value(*m_elements[parent(p)]))) {
+                percolate_up(p);
+            }
+            else {
+                percolate_down(p);
+            }
+        }
     }
 }
 
@@ -210,7 +229,7 @@ void heap<T, Compare>::percolate_down(size_type pivot)
     size_type left = left_child(pivot);
     size_type right = right_child(pivot);
     size_type start = pivot;
-    std::shared_ptr<element_type> tmp = m_elements[start];
+    std::shared_ptr<element_type> tmp = std::move(m_elements[start]);
     while (is_internal(left)) {
         size_type s = right;
         if (is_external(right) || m_comp(value(*m_elements[left]), value(*m_elements[right]))) {
@@ -218,7 +237,7 @@ void heap<T, Compare>::percolate_down(size_type pivot)
         }
 
         if (m_comp(value(*m_elements[s]), value(*tmp))) {
-            m_elements[pivot] = m_elements[s];
+            m_elements[pivot] = std::move(m_elements[s]);
             pos(*m_elements[pivot]) = pivot;
             pivot = s;
         }
@@ -228,70 +247,98 @@ void heap<T, Compare>::percolate_down(size_type pivot)
         left = left_child(pivot);
         right = right_child(pivot);
     }
-    m_elements[pivot] = tmp;
+    m_elements[pivot] = std::move(tmp);
     pos(*m_elements[pivot]) = pivot;
 }
 
 template <typename T, typename Compare>
 void heap<T, Compare>::percolate_up(size_type pivot)
 {
-    std::shared_ptr<element_type> tmp = m_elements[pivot];
+    std::shared_ptr<element_type> tmp = std::move(m_elements[pivot]);
     while (pivot != 1) {
         size_type p = parent(pivot);
         if (m_comp(value(*m_elements[p]), value(*tmp))) {
             break;
         }
         else {
-            m_elements[pivot] = m_elements[p];
+            m_elements[pivot] = std::move(m_elements[p]);
             pos(*m_elements[pivot]) = pivot;
             pivot = p;
         }
     }
-    m_elements[pivot] = tmp;
+    m_elements[pivot] = std::move(tmp);
     pos(*m_elements[pivot]) = pivot;
 }
 
 template <typename T, typename Compare>
-void heap<T, Compare>::make_heap(const std::vector<value_type>& elements)
+template <typename InputIt>
+void heap<T, Compare>::assign(InputIt first, InputIt last)
 {
-    m_elements.resize(elements.size() + 1);
-    make_heap(elements, 1, 0, elements.size());
+    clear();
+    append(first, last);
+    make_heap();
 }
 
 template <typename T, typename Compare>
-typename heap<T, Compare>::size_type heap<T, Compare>::height() const
+template <typename InputIt>
+void heap<T, Compare>::push_range(InputIt first, InputIt last)
 {
-    return m_elements.size() < 2 ? 0 : (ilog2(m_elements.size()) + (ispow2(m_elements.size())) ? 0 : 1);
+    const size_type n = size();
+    append(first, last);
+    const size_type k = size() - n;
+
+    // k pushes cost about k log(n + k) comparisons, a rebuild about 2(n + k)
+    if (k * ilog2(n + k + 1) > 2 * (n + k)) {
+        make_heap();
+    }
+    else {
+        for (size_type i = n + 1; i < m_elements.size(); ++i) {
+            percolate_up(i);
+        }
+    }
 }
 
 template <typename T, typename Compare>
-void heap<T, Compare>::make_heap(
-    const std::vector<value_type>& elements,
-    size_type root,
-    size_type start,
-    size_type end)
+template <typename OutputIt>
+OutputIt heap<T, Compare>::pop_n(size_type k, OutputIt out)
 {
-    if ((end - start) > 0) {
-        m_elements[root].reset(new element_type(elements[start], root));
-        size_type left = left_child(root);
-        size_type right = right_child(root);
+    k = std::min(k, size());
+    for (size_type i = 0; i < k; ++i) {
+        *out++ = value(*m_elements[1]);
+        pop();
+    }
+    return out;
+}
 
-        size_type n = end - start;
-        if (n == 1) {
-            return;
+/// Append the values in [first, last) without restoring the heap property.
+/// Their elements are allocated bulk_block_size at a time, and each element
+/// shares its block through an aliasing shared_ptr. A block is freed when the
+/// last of its elements, and the last handle to one, is gone, so bounding the
+/// block size bounds the memory a long-lived element or handle can retain.
+template <typename T, typename Compare>
+template <typename InputIt>
+void heap<T, Compare>::append(InputIt first, InputIt last)
+{
+    typedef std::vector<element_type> block_type;
+    std::shared_ptr<block_type> block;
+    for (; first != last; ++first) {
+        if (!block || block->size() == bulk_block_size) {
+            // reserved so that the elements never move
+            block = std::make_shared<block_type>();
+            block->reserve(bulk_block_size);
         }
+        block->emplace_back(*first, m_elements.size());
+        m_elements.push_back(std::shared_ptr<element_type>(block, &block->back()));
+    }
+}
 
-        size_type f = ilog2(n) - 1;
-        size_type f2 = ipow2(f);
-        size_type l = f2 - 1 + std::min(n - 2 * f2 + 1, f2);
-        size_type r = n - 1 - l;
-
-        size_type new_start = start + 1;
-        size_type mid = new_start + l;
-
-        make_heap(elements, left, new_start, mid);
-        make_heap(elements, right, mid, end);
-        percolate_down(root);
+/// Floyd's bottom-up construction: percolate down every internal node,
+/// deepest first, in O(n) time.
+template <typename T, typename Compare>
+void heap<T, Compare>::make_heap()
+{
+    for (size_type i = size() / 2; i >= 1; --i) {
+        percolate_down(i);
     }
 }
 
@@ -0,0 +1,263 @@
+#ifndef au_detail_intrusive_heap_h
+#define au_detail_intrusive_heap_h
+
+#include "../intrusive_heap.h"
+
+#include <assert.h>
+#include <utility>
+
+namespace au {
+
+template <typename T, typename Compare>
+intrusive_heap<T, Compare>::intrusive_heap(const compare& comp) :
+    m_data(1, nullptr),
+    m_comp(comp)
+{
+}
+
+template <typename T, typename Compare>
+template <typename InputIt>
+intrusive_heap<T, Compare>::intrusive_heap(InputIt first, InputIt last, const compare& comp) :
+    m_data(1, nullptr),
+    m_comp(comp)
+{
+    for (; first != last; ++first) {
+        T* e = *first;
+        e->m_heap_index = m_data.size();
+        m_data.push_back(e);
+    }
+    make();
+}
+
+template <typename T, typename Compare>
+intrusive_heap<T, Compare>::intrusive_heap(intrusive_heap&& other) :
+    m_data(std::move(other.m_data)),
+    m_comp(std::move(other.m_comp))
+{
+    other.m_data.assign(1, nullptr);
+}
+
+template <typename T, typename Compare>
+intrusive_heap<T, Compare>&
+intrusive_heap<T, Compare>::operator=(intrusive_heap&& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        m_data = std::move(rhs.m_data);
+        m_comp = std::move(rhs.m_comp);
+        rhs.m_data.assign(1, nullptr);
+    }
+    return *this;
+}
+
+template <typename T, typename Compare>
+intrusive_heap<T, Compare>::~intrusive_heap()
+{
+    clear();
+}
+
+template <typename T, typename Compare>
+T* intrusive_heap<T, Compare>::min() const
+{
+    assert(!empty());
+    return m_data[1];
+}
+
+template <typename T, typename Compare>
+typename intrusive_heap<T, Compare>::const_iterator
+intrusive_heap<T, Compare>::begin() const
+{
+    return m_data.begin() + 1;
+}
+
+template <typename T, typename Compare>
+typename intrusive_heap<T, Compare>::const_iterator
+intrusive_heap<T, Compare>::end() const
+{
+    return m_data.end();
+}
+
+template <typename T, typename Compare>
+bool intrusive_heap<T, Compare>::empty() const
+{
+    return m_data.size() == 1;
+}
+
+template <typename T, typename Compare>
+typename intrusive_heap<T, Compare>::size_type
+intrusive_heap<T, Compare>::size() const
+{
+    return m_data.size() - 1;
+}
+
+template <typename T, typename Compare>
+typename intrusive_heap<T, Compare>::size_type
+intrusive_heap<T, Compare>::max_size() const
+{
+    return m_data.max_size() - 1;
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::reserve(size_type new_cap)
+{
+    m_data.reserve(new_cap + 1);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::clear()
+{
+    for (size_type i = 1; i < m_data.size(); ++i) {
+        m_data[i]->m_heap_index = 0;
+    }
+    m_data.resize(1);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::push(T* e)
+{
+    assert(e && e->m_heap_index == 0);
+    e->m_heap_index = m_data.size();
+    m_data.push_back(e);
+    percolate_up(m_data.size() - 1);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::pop()
+{
+    assert(!empty());
+    m_data[1]->m_heap_index = 0;
+    T* last = m_data.back();
+    m_data.pop_back();
+    if (!empty()) {
+        m_data[1] = last;
+        last->m_heap_index = 1;
+        percolate_down(1);
+    }
+}
+
+template <typename T, typename Compare>
+bool intrusive_heap<T, Compare>::contains(const T* e) const
+{
+    return e->m_heap_index != 0 &&
+            e->m_heap_index < m_data.size() &&
+            m_data[e->m_heap_index] == e;
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::update(T* e)
+{
+    assert(contains(e));
+    const size_type i = e->m_heap_index;
+    if (i != 1 && m_comp(*e, *m_data[parent(i)])) {
+        percolate_up(i);
+    }
+    else {
+        percolate_down(i);
+    }
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::increase(T* e)
+{
+    assert(contains(e));
+    percolate_down(e->m_heap_index);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::decrease(T* e)
+{
+    assert(contains(e));
+    percolate_up(e->m_heap_index);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::erase(T* e)
+{
+    assert(contains(e));
+    const size_type i = e->m_heap_index;
+    e->m_heap_index = 0;
+    T* last = m_data.back();
+    m_data.pop_back();
+    if (last != e) {
+        m_data[i] = last;
+        last->m_heap_index = i;
+        update(last);
+    }
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::make()
+{
+    for (size_type i = size() / 2; i >= 1; --i) {
+        percolate_down(i);
+    }
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::swap(intrusive_heap& other)
+{
+    using std::swap;
+    m_data.swap(other.m_data);
+    swap(m_comp, other.m_comp);
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::percolate_down(size_type pivot)
+{
+    const size_type n = m_data.size();
+    T* tmp = m_data[pivot];
+    size_type child = left_child(pivot);
+    while (child < n) {
+        // pick the smaller child
+        if (child + 1 < n && m_comp(*m_data[child + 1], *m_data[child])) {
+            ++child;
+        }
+        if (!m_comp(*m_data[child], *tmp)) {
+            break;
+        }
+        m_data[pivot] = m_data[child];
+        m_data[pivot]->m_heap_index = pivot;
+        pivot = child;
+        child = left_child(pivot);
+    }
+    m_data[pivot] = tmp;
+    tmp->m_heap_index = pivot;
+}
+
+template <typename T, typename Compare>
+void intrusive_heap<T, Compare>::percolate_up(size_type pivot)
+{
+    T* tmp = m_data[pivot];
+    while (pivot != 1) {
+        const size_type p = parent(pivot);
+        if (!m_comp(*tmp, *m_data[p])) {
+            break;
+        }
+        m_data[pivot] = m_data[p];
+        m_data[pivot]->m_heap_index = pivot;
+        pivot = p;
+    }
+    m_data[pivot] = tmp;
+    tmp->m_heap_index = pivot;
+}
+
+template <typename T, typename Compare>
+bool intrusive_heap<T, Compare>::check_heap() const
+{
+    for (size_type i = 2; i < m_data.size(); ++i) {
+        if (m_comp(*m_data[i], *m_data[parent(i)]) || m_data[i]->m_heap_index != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Compare>
+void swap(intrusive_heap<T, Compare>& lhs, intrusive_heap<T, Compare>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+} // namespace au
+
+#endif
@@ -0,0 +1,354 @@
+#ifndef au_detail_pairing_heap_h
+#define au_detail_pairing_heap_h
+
+#include "../pairing_heap.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace au {
+
+template <typename T, typename Compare>
+pairing_heap<T, Compare>::pairing_heap(const compare& comp) :
+    m_root(nullptr),
+    m_size(0),
+    m_comp(comp),
+    m_chunks(),
+    m_free(nullptr),
+    m_capacity(0)
+{
+}
+
+template <typename T, typename Compare>
+pairing_heap<T, Compare>::pairing_heap(pairing_heap&& other) :
+    m_root(other.m_root),
+    m_size(other.m_size),
+    m_comp(std::move(other.m_comp)),
+    m_chunks(std::move(other.m_chunks)),
+    m_free(other.m_free),
+    m_capacity(other.m_capacity)
+{
+    other.m_root = nullptr;
+    other.m_size = 0;
+    other.m_chunks.clear();
+    other.m_free = nullptr;
+    other.m_capacity = 0;
+}
+
+template <typename T, typename Compare>
+pairing_heap<T, Compare>& pairing_heap<T, Compare>::operator=(pairing_heap&& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        m_chunks.clear();
+        m_free = nullptr;
+        m_capacity = 0;
+        swap(rhs);
+    }
+    return *this;
+}
+
+template <typename T, typename Compare>
+pairing_heap<T, Compare>::~pairing_heap()
+{
+    clear();
+}
+
+template <typename T, typename Compare>
+const typename pairing_heap<T, Compare>::value_type&
+pairing_heap<T, Compare>::min() const
+{
+    assert(m_root);
+    return m_root->value();
+}
+
+template <typename T, typename Compare>
+bool pairing_heap<T, Compare>::empty() const
+{
+    return m_size == 0;
+}
+
+template <typename T, typename Compare>
+typename pairing_heap<T, Compare>::size_type
+pairing_heap<T, Compare>::size() const
+{
+    return m_size;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::reserve(size_type new_cap)
+{
+    if (new_cap > m_capacity) {
+        grow(new_cap - m_capacity);
+    }
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::clear()
+{
+    // Destroy the tree, viewed as a binary tree of (child, next) links,
+    // without a stack: rotate left children up until there are none, then
+    // free the node and continue with its sibling.
+    node* n = m_root;
+    while (n) {
+        node* c = n->m_child;
+        if (c) {
+            n->m_child = c->m_next;
+            c->m_next = n;
+            n = c;
+        }
+        else {
+            node* next = n->m_next;
+            deallocate(n);
+            n = next;
+        }
+    }
+    m_root = nullptr;
+    m_size = 0;
+}
+
+template <typename T, typename Compare>
+typename pairing_heap<T, Compare>::handle_type
+pairing_heap<T, Compare>::push(const value_type& value)
+{
+    node* n = allocate();
+    new (&n->m_storage) T(value);
+    m_root = m_root ? link(m_root, n) : n;
+    ++m_size;
+
+    handle_type handle;
+    handle.m_node = n;
+    handle.m_gen = n->m_gen;
+    return handle;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::pop()
+{
+    assert(m_root);
+    node* n = m_root;
+    m_root = combine_siblings(n->m_child);
+    deallocate(n);
+    --m_size;
+}
+
+template <typename T, typename Compare>
+bool pairing_heap<T, Compare>::contains(const handle_type& handle) const
+{
+    return handle.m_node && handle.m_node->m_gen == handle.m_gen;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::update(const handle_type& handle, const value_type& v)
+{
+    if (m_comp(v, handle.m_node->value())) {
+        decrease(handle, v);
+    }
+    else {
+        increase(handle, v);
+    }
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::increase(const handle_type& handle, const value_type& v)
+{
+    node* n = handle.m_node;
+    assert(contains(handle));
+    n->value() = v;
+    if (!n->m_child) {
+        return; // a leaf cannot be out of order with its children
+    }
+    remove(n);
+    m_root = m_root ? link(m_root, n) : n;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::decrease(const handle_type& handle, const value_type& v)
+{
+    node* n = handle.m_node;
+    assert(contains(handle));
+    n->value() = v;
+    if (n != m_root) {
+        cut(n);
+        m_root = link(m_root, n);
+    }
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::erase(const handle_type& handle)
+{
+    if (contains(handle)) {
+        node* n = handle.m_node;
+        remove(n);
+        deallocate(n);
+        --m_size;
+    }
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::swap(pairing_heap& other)
+{
+    std::swap(m_root, other.m_root);
+    std::swap(m_size, other.m_size);
+    std::swap(m_comp, other.m_comp);
+    m_chunks.swap(other.m_chunks);
+    std::swap(m_free, other.m_free);
+    std::swap(m_capacity, other.m_capacity);
+}
+
+template <typename T, typename Compare>
+typename pairing_heap<T, Compare>::node* pairing_heap<T, Compare>::allocate()
+{
+    if (!m_free) {
+        grow(std::max<size_type>(m_capacity, 64));
+    }
+    node* n = m_free;
+    m_free = n->m_next;
+    n->m_child = nullptr;
+    n->m_next = nullptr;
+    n->m_prev = nullptr;
+    return n;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::deallocate(node* n)
+{
+    n->value().~T();
+    ++n->m_gen; // invalidate outstanding handles
+    n->m_next = m_free;
+    m_free = n;
+}
+
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::grow(size_type count)
+{
+    std::unique_ptr<node[]> chunk(new node[count]);
+    for (size_type i = 0; i < count; ++i) {
+        chunk[i].m_gen = 0;
+        chunk[i].m_next = (i + 1 < count) ? &chunk[i + 1] : m_free;
+    }
+    m_free = &chunk[0];
+    m_chunks.push_back(std::move(chunk));
+    m_capacity += count;
+}
+
+/// Make the greater of two roots the first child of the lesser and return the
+/// lesser. The sibling links of the returned root are left to the caller.
+template <typename T, typename Compare>
+typename pairing_heap<T, Compare>::node*
+pairing_heap<T, Compare>::link(node* a, node* b)
+{
+    if (m_comp(b->value(), a->value())) {
+        std::swap(a, b);
+    }
+    b->m_prev = a;
+    b->m_next = a->m_child;
+    if (a->m_child) {
+        a->m_child->m_prev = b;
+    }
+    a->m_child = b;
+    return a;
+}
+
+/// Merge a list of siblings into one tree with the standard two passes: link
+/// adjacent pairs left to right, then link the results right to left.
+template <typename T, typename Compare>
+typename pairing_heap<T, Compare>::node*
+pairing_heap<T, Compare>::combine_siblings(node* first)
+{
+    if (!first) {
+        return nullptr;
+    }
+
+    // first pass; the linked pairs are pushed onto a stack through m_next, so
+    // the second pass visits them right to left
+    node* pairs = nullptr;
+    while (first) {
+        node* a = first;
+        node* b = a->m_next;
+        if (!b) {
+            a->m_next = pairs;
+            pairs = a;
+            break;
+        }
+        first = b->m_next;
+        node* r = link(a, b);
+        r->m_next = pairs;
+        pairs = r;
+    }
+
+    node* root = pairs;
+    pairs = pairs->m_next;
+    while (pairs) {
+        node* next = pairs->m_next;
+        root = link(root, pairs);
+        pairs = next;
+    }
+    root->m_next = nullptr;
+    root->m_prev = nullptr;
+    return root;
+}
+
+/// Detach a non-root node, with its subtree, from its parent's child list.
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::cut(node* n)
+{
+    if (n->m_prev->m_child == n) {
+        n->m_prev->m_child = n->m_next;
+    }
+    else {
+        n->m_prev->m_next = n->m_next;
+    }
+    if (n->m_next) {
+        n->m_next->m_prev = n->m_prev;
+    }
+    n->m_next = nullptr;
+    n->m_prev = nullptr;
+}
+
+/// Remove a node from the tree, merging its children back in, and leave it
+/// detached with no children.
+template <typename T, typename Compare>
+void pairing_heap<T, Compare>::remove(node* n)
+{
+    node* children = combine_siblings(n->m_child);
+    n->m_child = nullptr;
+    if (n == m_root) {
+        m_root = children;
+    }
+    else {
+        cut(n);
+        if (children) {
+            m_root = link(m_root, children);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// pairing_heap::handle_type implementation
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename Compare>
+pairing_heap<T, Compare>::handle_type::handle_type() :
+    m_node(nullptr),
+    m_gen(0)
+{ }
+
+template <typename T, typename Compare>
+const typename pairing_heap<T, Compare>::value_type&
+pairing_heap<T, Compare>::handle_type::operator*() const
+{ return m_node->value(); }
+
+template <typename T, typename Compare>
+bool pairing_heap<T, Compare>::handle_type::valid() const
+{ return m_node != nullptr; }
+
+template <typename T, typename Compare>
+void swap(pairing_heap<T, Compare>& lhs, pairing_heap<T, Compare>& rhs)
+{ lhs.swap(rhs); }
+
+} // namespace au
+
+#endif
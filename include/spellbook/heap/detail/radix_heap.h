@@ -0,0 +1,239 @@
+#ifndef au_detail_radix_heap_h
+#define au_detail_radix_heap_h
+
+#include "../radix_heap.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <utility>
+
+namespace au {
+
+/// Return the index of the highest set bit of a nonzero value.
+inline int HighestBit(uint64_t v)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+#else
+    int b = 0;
+    while (v >>= 1) {
+        ++b;
+    }
+    return b;
+#endif
+}
+
+template <typename T, typename Key>
+radix_heap<T, Key>::radix_heap() :
+    m_last(0),
+    m_size(0)
+{
+}
+
+template <typename T, typename Key>
+radix_heap<T, Key>::radix_heap(radix_heap&& other) :
+    m_last(other.m_last),
+    m_size(other.m_size)
+{
+    for (int b = 0; b < num_buckets; ++b) {
+        m_buckets[b].swap(other.m_buckets[b]);
+    }
+    other.m_size = 0;
+}
+
+template <typename T, typename Key>
+radix_heap<T, Key>& radix_heap<T, Key>::operator=(radix_heap&& rhs)
+{
+    if (this != &rhs) {
+        clear();
+        swap(rhs);
+    }
+    return *this;
+}
+
+template <typename T, typename Key>
+radix_heap<T, Key>::~radix_heap()
+{
+    clear();
+}
+
+template <typename T, typename Key>
+T* radix_heap<T, Key>::min() const
+{
+    assert(!empty());
+    if (m_buckets[0].empty()) {
+        refill();
+    }
+    return m_buckets[0].back().elem;
+}
+
+template <typename T, typename Key>
+const Key& radix_heap<T, Key>::min_key() const
+{
+    assert(!empty());
+    if (m_buckets[0].empty()) {
+        refill();
+    }
+    return m_last;
+}
+
+template <typename T, typename Key>
+const Key& radix_heap<T, Key>::key(const T* e) const
+{
+    assert(contains(e));
+    const size_type i = e->m_heap_index;
+    return m_buckets[bucket_index(i)][bucket_pos(i)].key;
+}
+
+template <typename T, typename Key>
+bool radix_heap<T, Key>::empty() const
+{
+    return m_size == 0;
+}
+
+template <typename T, typename Key>
+auto radix_heap<T, Key>::size() const -> size_type
+{
+    return m_size;
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::reserve(size_type n)
+{
+    m_buckets[0].reserve(n);
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::clear()
+{
+    for (int b = 0; b < num_buckets; ++b) {
+        for (size_type i = 0; i < m_buckets[b].size(); ++i) {
+            m_buckets[b][i].elem->m_heap_index = 0;
+        }
+        m_buckets[b].clear();
+    }
+    m_last = 0;
+    m_size = 0;
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::push(T* e, const Key& key)
+{
+    assert(e && e->m_heap_index == 0);
+    assert(key >= m_last);
+    entry x = { key, e };
+    insert(x);
+    ++m_size;
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::pop()
+{
+    assert(!empty());
+    if (m_buckets[0].empty()) {
+        refill();
+    }
+    m_buckets[0].back().elem->m_heap_index = 0;
+    m_buckets[0].pop_back();
+    --m_size;
+}
+
+template <typename T, typename Key>
+bool radix_heap<T, Key>::contains(const T* e) const
+{
+    const size_type i = e->m_heap_index;
+    if (i == 0) {
+        return false;
+    }
+    const std::vector<entry>& bucket = m_buckets[bucket_index(i)];
+    const size_type pos = bucket_pos(i);
+    return pos < bucket.size() && bucket[pos].elem == e;
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::update(T* e, const Key& key)
+{
+    assert(contains(e) && key >= m_last);
+    remove(e);
+    entry x = { key, e };
+    insert(x);
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::erase(T* e)
+{
+    assert(contains(e));
+    remove(e);
+    e->m_heap_index = 0;
+    --m_size;
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::swap(radix_heap& other)
+{
+    for (int b = 0; b < num_buckets; ++b) {
+        m_buckets[b].swap(other.m_buckets[b]);
+    }
+    std::swap(m_last, other.m_last);
+    std::swap(m_size, other.m_size);
+}
+
+template <typename T, typename Key>
+int radix_heap<T, Key>::bucket_of(Key key) const
+{
+    return key == m_last ? 0 : 1 + HighestBit((uint64_t)(key ^ m_last));
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::insert(const entry& x) const
+{
+    const int b = bucket_of(x.key);
+    x.elem->m_heap_index = encode(b, m_buckets[b].size());
+    m_buckets[b].push_back(x);
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::remove(T* e)
+{
+    const size_type i = e->m_heap_index;
+    std::vector<entry>& bucket = m_buckets[bucket_index(i)];
+    const size_type pos = bucket_pos(i);
+    if (pos + 1 != bucket.size()) {
+        bucket[pos] = bucket.back();
+        bucket[pos].elem->m_heap_index = i;
+    }
+    bucket.pop_back();
+}
+
+template <typename T, typename Key>
+void radix_heap<T, Key>::refill() const
+{
+    int b = 1;
+    while (m_buckets[b].empty()) {
+        ++b;
+    }
+
+    // the new minimum differs from the old one in bit b - 1, and every other
+    // element of bucket b agrees with it above that bit, so they all move to
+    // lower buckets
+    std::vector<entry>& bucket = m_buckets[b];
+    Key min_key = bucket[0].key;
+    for (size_type i = 1; i < bucket.size(); ++i) {
+        min_key = bucket[i].key < min_key ? bucket[i].key : min_key;
+    }
+    m_last = min_key;
+    for (size_type i = 0; i < bucket.size(); ++i) {
+        insert(bucket[i]);
+    }
+    bucket.clear();
+}
+
+template <typename T, typename Key>
+void swap(radix_heap<T, Key>& lhs, radix_heap<T, Key>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+} // namespace au
+
+#endif
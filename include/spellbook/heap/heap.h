@@ -23,6 +23,9 @@ public:
 
     typedef int key_type;
 
+    /// The number of elements allocated together by assign() and push_range()
+    static const size_type bulk_block_size = 64;
+
 private:
 
     typedef std::pair<value_type, size_type> element_type; // todo: remove size_type in favor of pointer arithmetic?
@@ -62,6 +65,9 @@ public:
     };
 
     explicit heap(const compare& comp = compare(), const container_type& elements = container_type());
+
+    template <typename InputIt>
+    heap(InputIt first, InputIt last, const compare& comp = compare());
     heap(const heap& other);
     heap& operator=(const heap& rhs);
 
@@ -93,6 +99,28 @@ public:
     void decrease(const handle_type& handle, const value_type& v);
     void erase(const handle_type& handle);
     void swap(heap& other);
+
+    /// Replace the contents with the values in [first, last), in O(n) time.
+    ///
+    /// Elements inserted by assign() and push_range() are allocated in blocks
+    /// of bulk_block_size elements rather than one at a time. A block's memory
+    /// is released only after all of its elements have left the heap and all
+    /// handles to them have been destroyed.
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);
+
+    /// Insert the values in [first, last), allocated in blocks as by
+    /// assign(). Large batches are appended and the whole heap rebuilt
+    /// bottom-up, which is cheaper than percolating each value up when the
+    /// batch is comparable in size to the heap. Handles to the new elements
+    /// can be obtained by iterating the heap.
+    template <typename InputIt>
+    void push_range(InputIt first, InputIt last);
+
+    /// Remove the k smallest elements (or all, if there are fewer) and write
+    /// their values to out in order.
+    template <typename OutputIt>
+    OutputIt pop_n(size_type k, OutputIt out);
     /// @}
 
 private:
@@ -107,15 +135,15 @@ private:
     bool is_external(size_type index) const { return index >= m_elements.size(); }
     void percolate_down(size_type pivot);
     void percolate_up(size_type pivot);
-    void make_heap(const std::vector<value_type>& elements);
-    void make_heap(const std::vector<value_type>& elements, size_type root, size_type start, size_type end);
+    template <typename InputIt>
+    void append(InputIt first, InputIt last);
+    void make_heap();
 
     inline value_type& value(element_type& ele) const { return ele.first; }
     inline size_type& pos(element_type& ele) const { return ele.second; }
 
     bool check_heap() const;
     bool check_heap(size_type curr) const;
-    size_type height() const;
 };
 
 template <typename T, typename Compare = std::less<T>>
@@ -0,0 +1,115 @@
+#ifndef au_intrusive_heap_h
+#define au_intrusive_heap_h
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace au {
+
+/// @brief Base class for elements of an intrusive_heap, which stores the
+///        element's position in the heap.
+///
+/// The position is 0 while the element is not in a heap. An element may be
+/// in at most one heap at a time.
+struct heap_element
+{
+    heap_element() : m_heap_index(0) { }
+
+    std::size_t heap_index() const { return m_heap_index; }
+
+private:
+
+    std::size_t m_heap_index;
+
+    template <typename T, typename Compare> friend class intrusive_heap;
+    template <typename T, typename Key, typename Compare, int Arity> friend class dary_heap;
+    template <typename T, typename Key> friend class radix_heap;
+};
+
+/// @brief A mutable binary heap of pointers to caller-owned elements.
+///
+/// Unlike heap, which allocates a reference-counted node for every pushed
+/// value, intrusive_heap stores plain pointers and records each element's
+/// position in the element itself, so lookups by element are free and no
+/// allocation happens once reserve() has been called for the maximum size.
+/// T must derive from heap_element; Compare orders the elements themselves,
+/// so an element's priority is changed by modifying it and then calling
+/// update(), increase() or decrease().
+template <typename T, typename Compare = std::less<T>>
+class intrusive_heap
+{
+public:
+
+    typedef T value_type;
+    typedef Compare compare;
+    typedef std::vector<T*> container_type;
+    typedef typename container_type::size_type size_type;
+    typedef typename container_type::const_iterator const_iterator;
+
+    explicit intrusive_heap(const compare& comp = compare());
+
+    template <typename InputIt>
+    intrusive_heap(InputIt first, InputIt last, const compare& comp = compare());
+
+    intrusive_heap(const intrusive_heap&) = delete;
+    intrusive_heap& operator=(const intrusive_heap&) = delete;
+
+    intrusive_heap(intrusive_heap&& other);
+    intrusive_heap& operator=(intrusive_heap&& rhs);
+
+    ~intrusive_heap();
+
+    /// @{ Access
+    T* min() const;
+    T* top() const { return min(); }
+    /// @}
+
+    /// @{ Iterators
+    const_iterator begin() const;
+    const_iterator end() const;
+    /// @}
+
+    /// @{ Capacity
+    bool empty() const;
+    size_type size() const;
+    size_type max_size() const;
+    void reserve(size_type new_cap);
+    /// @}
+
+    /// @{ Modifiers
+    void clear();
+    void push(T* e);
+    void pop();
+    bool contains(const T* e) const;
+    void update(T* e);
+    void increase(T* e);
+    void decrease(T* e);
+    void erase(T* e);
+    void make();
+    void swap(intrusive_heap& other);
+    /// @}
+
+private:
+
+    // m_data[0] is unused, so that the children of i are 2i and 2i + 1
+    container_type m_data;
+    Compare m_comp;
+
+    size_type left_child(size_type i) const { return i << 1; }
+    size_type parent(size_type i) const { return i >> 1; }
+
+    void percolate_down(size_type pivot);
+    void percolate_up(size_type pivot);
+
+    bool check_heap() const;
+};
+
+template <typename T, typename Compare>
+void swap(intrusive_heap<T, Compare>& lhs, intrusive_heap<T, Compare>& rhs);
+
+} // namespace au
+
+#include "detail/intrusive_heap.h"
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef au_pairing_heap_h
+#define au_pairing_heap_h
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace au {
+
+/// @brief A mutable pairing heap with the handle-based interface of au::heap.
+///
+/// push() and decrease() take O(1) time; decrease() cuts the node out of its
+/// parent's child list and links it with the root, touching no other nodes.
+/// pop(), increase(), and erase() take O(log n) amortized time, using the
+/// two-pass pairing of the node's children.
+///
+/// Nodes come from a pool owned by the heap: they are carved out of chunks
+/// that grow geometrically, and freed nodes are recycled through a free list,
+/// so once reserve() has been called for the maximum size, no operation
+/// allocates. Chunks are released only when the heap is destroyed.
+///
+/// Because nodes are recycled, a handle stays valid only while its element is
+/// in the heap; contains() detects stale handles by comparing a generation
+/// count stored in the handle with one stored in the node. Handles must not
+/// be used after the heap that issued them is destroyed.
+///
+/// Recommendation: prefer pairing_heap over au::heap wherever values and
+/// handles are wanted. In test/heap_bench.cpp it is about 1.4x faster with 1
+/// to 64 decreases per pop, the D* Lite / LPA* replanning mix, and 1.7x to
+/// 2.5x faster in grid Dijkstra and maze A*. When the elements can derive from
+/// heap_element, intrusive_heap and dary_heap are faster still for pop-heavy
+/// searches like A*, because pop()'s pairing passes chase pointers across the
+/// pool while their sift-down reads contiguous memory.
+template <typename T, typename Compare = std::less<T>>
+class pairing_heap
+{
+    struct node;
+
+public:
+
+    typedef T value_type;
+    typedef Compare compare;
+    typedef std::size_t size_type;
+
+    struct handle_type
+    {
+        handle_type();
+        const value_type& operator*() const;
+        bool valid() const;
+
+    private:
+
+        friend class pairing_heap;
+        node* m_node;
+        size_type m_gen;
+    };
+
+    explicit pairing_heap(const compare& comp = compare());
+
+    pairing_heap(const pairing_heap&) = delete;
+    pairing_heap& operator=(const pairing_heap&) = delete;
+
+    pairing_heap(pairing_heap&& other);
+    pairing_heap& operator=(pairing_heap&& rhs);
+
+    ~pairing_heap();
+
+    /// @{ Access
+    const value_type& min() const;
+    const value_type& top() const { return min(); }
+    /// @}
+
+    /// @{ Capacity
+    bool empty() const;
+    size_type size() const;
+    void reserve(size_type new_cap);
+    /// @}
+
+    /// @{ Modifiers
+    void clear();
+    handle_type push(const value_type& value);
+    void pop();
+    bool contains(const handle_type& handle) const;
+    void update(const handle_type& handle, const value_type& v);
+    void increase(const handle_type& handle, const value_type& v);
+    void decrease(const handle_type& handle, const value_type& v);
+    void erase(const handle_type& handle);
+    void swap(pairing_heap& other);
+    /// @}
+
+private:
+
+    // Children form a doubly-linked list through m_next and m_prev; the first
+    // child's m_prev points to its parent. Free nodes are linked by m_next.
+    struct node
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+        node* m_child;
+        node* m_next;
+        node* m_prev;
+        size_type m_gen;
+
+        T& value() { return *reinterpret_cast<T*>(&m_storage); }
+        const T& value() const { return *reinterpret_cast<const T*>(&m_storage); }
+    };
+
+    node* m_root;
+    size_type m_size;
+    Compare m_comp;
+
+    std::vector<std::unique_ptr<node[]>> m_chunks;
+    node* m_free;
+    size_type m_capacity;
+
+    node* allocate();
+    void deallocate(node* n);
+    void grow(size_type count);
+
+    node* link(node* a, node* b);
+    node* combine_siblings(node* first);
+    void cut(node* n);
+    void remove(node* n);
+};
+
+template <typename T, typename Compare>
+void swap(pairing_heap<T, Compare>& lhs, pairing_heap<T, Compare>& rhs);
+
+} // namespace au
+
+#include "detail/pairing_heap.h"
+
+#endif
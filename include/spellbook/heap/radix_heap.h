@@ -0,0 +1,141 @@
+#ifndef au_radix_heap_h
+#define au_radix_heap_h
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "dary_heap.h"
+#include "intrusive_heap.h"
+
+namespace au {
+
+/// @brief A monotone priority queue of caller-owned elements with unsigned
+///        integer keys.
+///
+/// A radix heap keeps its elements in one bucket per bit of the key, by the
+/// highest bit in which their key differs from the last minimum key; finding
+/// the minimum only redistributes a bucket when the lowest one runs out, so
+/// each element moves at most once per bit, and push, pop and every priority
+/// change take amortized O(1) time for keys of fixed width. This beats a
+/// comparison heap for searches with integer edge costs and a consistent
+/// heuristic.
+///
+/// The queue is monotone: a pushed or updated key must not be less than the
+/// last key returned by min_key() or top() since the last clear(), which
+/// holds for the keys of Dijkstra's algorithm and of A* with a consistent
+/// heuristic. The interface matches dary_heap;
+/// elements derive from heap_element. Buckets keep their storage across
+/// pop() and clear(), so a reused queue stops allocating once it has reached
+/// its largest size.
+template <typename T, typename Key>
+class radix_heap
+{
+public:
+
+    static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+            "radix_heap requires an unsigned integer key");
+
+    typedef T value_type;
+    typedef Key key_type;
+    typedef std::size_t size_type;
+
+    struct entry
+    {
+        Key key;
+        T* elem;
+    };
+
+    radix_heap();
+
+    radix_heap(const radix_heap&) = delete;
+    radix_heap& operator=(const radix_heap&) = delete;
+
+    radix_heap(radix_heap&& other);
+    radix_heap& operator=(radix_heap&& rhs);
+
+    ~radix_heap();
+
+    /// @{ Access
+    T* min() const;
+    T* top() const { return min(); }
+    const Key& min_key() const;
+    const Key& key(const T* e) const;
+    /// @}
+
+    /// @{ Capacity
+    bool empty() const;
+    size_type size() const;
+
+    /// Reserve space for n elements with the minimum key; the other buckets
+    /// grow on demand.
+    void reserve(size_type n);
+    /// @}
+
+    /// @{ Modifiers
+    void clear();
+    void push(T* e, const Key& key);
+    void pop();
+    bool contains(const T* e) const;
+    void update(T* e, const Key& key);
+    void increase(T* e, const Key& key) { update(e, key); }
+    void decrease(T* e, const Key& key) { update(e, key); }
+    void erase(T* e);
+    void swap(radix_heap& other);
+    /// @}
+
+private:
+
+    static const int num_buckets = std::numeric_limits<Key>::digits + 1;
+
+    // bucket 0 holds the elements whose key equals m_last; bucket b > 0 holds
+    // the elements whose key first differs from m_last in bit b - 1. The
+    // buckets are redistributed lazily, when the minimum is requested and
+    // bucket 0 is empty, so that keys between the last minimum and the
+    // current one may still be pushed.
+    mutable std::vector<entry> m_buckets[num_buckets];
+    mutable Key m_last;
+    size_type m_size;
+
+    int bucket_of(Key key) const;
+
+    // an element's heap index encodes its bucket and its position in it
+    static size_type encode(int b, size_type pos) { return pos * num_buckets + b + 1; }
+    static int bucket_index(size_type i) { return (int)((i - 1) % num_buckets); }
+    static size_type bucket_pos(size_type i) { return (i - 1) / num_buckets; }
+
+    void insert(const entry& x) const;
+    void remove(T* e);
+    void refill() const;
+};
+
+template <typename T, typename Key>
+void swap(radix_heap<T, Key>& lhs, radix_heap<T, Key>& rhs);
+
+/// @brief Select the fastest mutable heap for monotone keys of type Key:
+///        radix_heap for unsigned integers and dary_heap otherwise.
+///
+/// Both offer push(e, key), pop(), top(), min_key(), contains(e),
+/// update/increase/decrease(e, key), erase(e), clear() and reserve(n), so
+/// a search can be written once against monotone_heap<T, Key>::type.
+template <typename T, typename Key, typename Enable = void>
+struct monotone_heap
+{
+    typedef dary_heap<T, Key> type;
+};
+
+template <typename T, typename Key>
+struct monotone_heap<T, Key, typename std::enable_if<
+        std::is_integral<Key>::value &&
+        std::is_unsigned<Key>::value &&
+        !std::is_same<Key, bool>::value>::type>
+{
+    typedef radix_heap<T, Key> type;
+};
+
+} // namespace au
+
+#include "detail/radix_heap.h"
+
+#endif
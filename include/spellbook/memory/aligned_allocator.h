@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_aligned_allocator_h
+#define au_aligned_allocator_h
+
+#include <stddef.h>
+
+namespace au
+{
+
+/// Allocates storage aligned to Alignment bytes (a power of two no smaller
+/// than sizeof(void*)). With the default 64-byte alignment every allocation
+/// begins on a cache line, as does every row of a grid whose size in bytes is
+/// a multiple of 64.
+///
+/// If HugePages is true, allocations of at least one huge page are aligned to
+/// the huge page size and the kernel is advised to back them with transparent
+/// huge pages, which reduces TLB misses for scattered accesses into large
+/// arrays. The advice is ignored on systems that do not support it.
+template <size_t Alignment = 64, bool HugePages = false>
+struct aligned_allocator
+{
+    static_assert(Alignment >= sizeof(void*) && !(Alignment & (Alignment - 1)),
+            "Alignment must be a power of two no smaller than a pointer");
+
+    static const size_t alignment = Alignment;
+
+    static void* allocate(size_t num_bytes);
+    static void deallocate(void* p, size_t num_bytes);
+};
+
+} // namespace au
+
+#include "detail/aligned_allocator.h"
+
+#endif
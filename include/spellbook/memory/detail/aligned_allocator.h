@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2014, Andrew Dornbush All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+// this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef au_detail_aligned_allocator_h
+#define au_detail_aligned_allocator_h
+
+#include "../aligned_allocator.h"
+
+// standard includes
+#include <stdlib.h>
+
+// system includes
+#include <sys/mman.h>
+
+namespace au
+{
+
+static const size_t HugePageSize = 2 * 1024 * 1024;
+
+template <size_t Alignment, bool HugePages>
+void* aligned_allocator<Alignment, HugePages>::allocate(size_t num_bytes)
+{
+    if (num_bytes == 0) {
+        num_bytes = 1;
+    }
+
+    size_t align = Alignment;
+    if (HugePages && num_bytes >= HugePageSize && align < HugePageSize) {
+        align = HugePageSize;
+    }
+
+    void* p = nullptr;
+    if (posix_memalign(&p, align, num_bytes) != 0) {
+        return nullptr;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (HugePages && num_bytes >= HugePageSize) {
+        // best effort; failure leaves the memory backed by regular pages
+        madvise(p, num_bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    return p;
+}
+
+template <size_t Alignment, bool HugePages>
+void aligned_allocator<Alignment, HugePages>::deallocate(void* p, size_t num_bytes)
+{
+    free(p);
+}
+
+} // namespace au
+
+#endif
@@ -5,6 +5,8 @@
 #include <octomap_ros/conversions.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <spellbook/geometry_msgs/geometry_msgs.h>
+#include <spellbook/grid/grid_view.h>
+#include <spellbook/grid/metric_grid.h>
 #include <spellbook/stringifier/stringifier.h>
 #include <spellbook/moveit_msgs/moveit_msgs.h>
 #include <spellbook/msg_utils/msg_utils.h>
@@ -109,13 +111,21 @@ CostmapExtruder::extrude_to_collision_map(
     const std::uint32_t height = grid.info.height;
     const float res = grid.info.resolution;
 
+    // view the row-major cell data in place, indexed by (x, y)
+    const size_t sizes[2] = { width, height };
+    const ptrdiff_t strides[2] = { 1, (ptrdiff_t)width };
+    au::grid_view<2, const std::int8_t> cells(grid.data.data(), sizes, strides);
+
+    const double origin[2] = { grid.info.origin.position.x, grid.info.origin.position.y };
+    const au::grid_frame<2> frame(origin, res);
+
     int num_occupied_cells = 0;
     for (int x = 0; x < width; ++x) {
         for (int y = 0; y < height; ++y) {
             // only add occuped cells to the collision map
             bool obstacle =
-                (grid.data[y * width + x] >= obs_threshold_) ||
-                (unknown_obstacles_ && grid.data[y * width + x] < 0);
+                (cells(x, y) >= obs_threshold_) ||
+                (unknown_obstacles_ && cells(x, y) < 0);
 
             if (!obstacle) {
                 continue;
@@ -123,8 +133,11 @@ CostmapExtruder::extrude_to_collision_map(
 
             ++num_occupied_cells;
 
-            double map_x = grid.info.origin.position.x + x * res + 0.5 * res;
-            double map_y = grid.info.origin.position.y + y * res + 0.5 * res;
+            const ptrdiff_t cell[2] = { x, y };
+            double map_pos[2];
+            frame.grid_to_world(cell, map_pos);
+            const double map_x = map_pos[0];
+            const double map_y = map_pos[1];
             for (double z = 0.0; z <= extrusion; z += res) {
                 const double& map_z = z + 0.5 * res;
 
@@ -0,0 +1,210 @@
+// standard includes
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+// system includes
+#include <spellbook/grid/distance_transform.h>
+#include <spellbook/grid/dynamic_distance_field.h>
+#include <spellbook/grid/grid.h>
+#include <spellbook/mapgen/MapGenerator.h>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock clock_type;
+
+double ElapsedMs(const clock_type::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void Report(const char* name, double ms, std::uint64_t checksum)
+{
+    std::cout << "  " << name << ": " << ms << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+// Scattered rectangular obstacles covering a few percent of the map
+void GenerateObstacles(Map& map, int count)
+{
+    std::mt19937 rng(0);
+    for (int i = 0; i < count; ++i) {
+        const size_t x0 = rng() % map.size(0);
+        const size_t y0 = rng() % map.size(1);
+        const size_t w = 1 + rng() % 16;
+        const size_t h = 1 + rng() % 16;
+        for (size_t x = x0; x < std::min(x0 + w, map.size(0)); ++x) {
+            for (size_t y = y0; y < std::min(y0 + h, map.size(1)); ++y) {
+                map(x, y) = 1;
+            }
+        }
+    }
+}
+
+// The multi-source breadth-first search used downstream: each cell records
+// the obstacle it was reached from and the Euclidean distance to it, which is
+// fast but only approximate.
+void BrushfireBFS(const Map& map, au::grid<2, float>& dist)
+{
+    const size_t w = map.size(0);
+    const size_t h = map.size(1);
+    dist.resize(w, h);
+    au::grid<2, std::uint32_t> source(w, h);
+
+    std::deque<std::uint32_t> q;
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            if (map(x, y)) {
+                dist(x, y) = 0.0f;
+                source(x, y) = (std::uint32_t)(x * h + y);
+                q.push_back((std::uint32_t)(x * h + y));
+            }
+            else {
+                dist(x, y) = std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+
+    while (!q.empty()) {
+        const std::uint32_t c = q.front();
+        q.pop_front();
+        const int cx = c / h;
+        const int cy = c % h;
+        const std::uint32_t s = source(cx, cy);
+        const int sx = s / h;
+        const int sy = s % h;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                const int nx = cx + dx;
+                const int ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= (int)w || ny >= (int)h) {
+                    continue;
+                }
+                const float d = std::sqrt((float)((nx - sx) * (nx - sx) + (ny - sy) * (ny - sy)));
+                if (d < dist(nx, ny)) {
+                    dist(nx, ny) = d;
+                    source(nx, ny) = s;
+                    q.push_back((std::uint32_t)(nx * h + ny));
+                }
+            }
+        }
+    }
+}
+
+void BenchmarkDistanceTransform2D(size_t w, size_t h)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Distance Transform 2D (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    Map map(w, h);
+    GenerateObstacles(map, (int)(w * h / 2000));
+
+    au::grid<2, float> bfs;
+    auto start = clock_type::now();
+    BrushfireBFS(map, bfs);
+    Report("brushfire BFS", ElapsedMs(start), (std::uint64_t)bfs(w / 2, h / 2));
+
+    au::grid<2, float> edt;
+    start = clock_type::now();
+    au::distance_transform(map, edt);
+    Report("distance_transform", ElapsedMs(start), (std::uint64_t)edt(w / 2, h / 2));
+
+    start = clock_type::now();
+    au::signed_distance_transform(map, edt);
+    Report("signed_distance_transform", ElapsedMs(start), (std::uint64_t)edt(w / 2, h / 2));
+
+    size_t errors = 0;
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            if (bfs(x, y) > std::max(edt(x, y), 0.0f) + 1e-3f) {
+                ++errors;
+            }
+        }
+    }
+    std::cout << "  cells where BFS overestimates: " << errors << std::endl;
+}
+
+void BenchmarkDistanceTransform3D(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Distance Transform 3D (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<3, std::uint8_t> g(w, h, d);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < w * h * d / 1000; ++i) {
+        g(rng() % w, rng() % h, rng() % d) = 1;
+    }
+
+    au::grid<3, float> dist;
+    auto start = clock_type::now();
+    au::squared_distance_transform(g, dist);
+    Report("squared_distance_transform", ElapsedMs(start), (std::uint64_t)dist(w / 2, h / 2, d / 2));
+}
+
+// Replay random batches of obstacle insertions and removals, updating the
+// field incrementally after each batch, and compare against a full rebuild
+void BenchmarkDynamicDistanceField(size_t w, size_t h, size_t d, size_t batch_size)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Dynamic Distance Field (" << w << " x " << h << " x " << d << ", " << batch_size << " edits per batch)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    typedef au::grid_index<3, float> index;
+
+    au::grid<3, std::uint8_t> occupancy(w, h, d);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < w * h * d / 1000; ++i) {
+        occupancy(rng() % w, rng() % h, rng() % d) = 1;
+    }
+
+    au::dynamic_distance_field<3> field(w, h, d);
+    auto start = clock_type::now();
+    field.assign(occupancy, [](std::uint8_t v) { return v != 0; });
+    Report("initial brushfire", ElapsedMs(start), (std::uint64_t)field.distance(index(w / 2, h / 2, d / 2)));
+
+    const size_t num_batches = 20;
+    std::vector<index> edits(num_batches * batch_size);
+    for (size_t i = 0; i < edits.size(); ++i) {
+        edits[i] = index(rng() % w, rng() % h, rng() % d);
+    }
+
+    size_t processed = 0;
+    start = clock_type::now();
+    for (size_t b = 0; b < num_batches; ++b) {
+        for (size_t e = b * batch_size; e < (b + 1) * batch_size; ++e) {
+            const index& i = edits[e];
+            if (field.is_obstacle(i)) {
+                field.clear_obstacle(i);
+            }
+            else {
+                field.set_obstacle(i);
+            }
+        }
+        processed += field.update();
+    }
+    const double incremental = ElapsedMs(start) / num_batches;
+    Report("incremental update (per batch)", incremental, processed / num_batches);
+
+    au::grid<3, float> dist;
+    start = clock_type::now();
+    au::squared_distance_transform(occupancy, dist);
+    Report("full distance_transform rebuild", ElapsedMs(start), (std::uint64_t)dist(w / 2, h / 2, d / 2));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkDistanceTransform2D(2048, 2048);
+    BenchmarkDistanceTransform3D(256, 256, 128);
+    BenchmarkDynamicDistanceField(256, 256, 64, 10);
+    BenchmarkDynamicDistanceField(256, 256, 64, 100);
+    BenchmarkDynamicDistanceField(256, 256, 64, 1000);
+    return 0;
+}
@@ -0,0 +1,1192 @@
+// standard includes
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// system includes
+#include <spellbook/grid/bitgrid.h>
+#include <spellbook/grid/connected_components.h>
+#include <spellbook/grid/grid.h>
+#include <spellbook/grid/kernels.h>
+#include <spellbook/grid/mapped_grid.h>
+#include <spellbook/grid/metric_grid.h>
+#include <spellbook/grid/morphology.h>
+#include <spellbook/grid/parallel.h>
+#include <spellbook/grid/pyramid.h>
+#include <spellbook/grid/rolling_grid.h>
+#include <spellbook/grid/serialization.h>
+#include <spellbook/grid/sparse_grid.h>
+#include <spellbook/grid/summed_area_table.h>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock clock_type;
+
+double ElapsedMs(const clock_type::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void Report(const char* name, double ms, std::uint64_t checksum)
+{
+    std::cout << "  " << name << ": " << ms << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+// The offset computation grid used before the stride table was introduced:
+// the running product of the dimensions is rebuilt from scratch on every
+// access.
+template <int N>
+size_t LegacyOffset(const size_t* dims, const size_t* coords)
+{
+    size_t agg = 1;
+    size_t s = coords[N - 1];
+    for (int d = N - 2; d >= 0; --d) {
+        agg *= dims[d + 1];
+        s += agg * coords[d];
+    }
+    return s;
+}
+
+void BenchmarkAccess2D(size_t w, size_t h, size_t random_accesses)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Access 2D (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<2, std::uint32_t> g(w, h);
+    g.assign(1);
+    const size_t dims[2] = { w, h };
+
+    std::mt19937 rng(0);
+    std::vector<size_t> xs(random_accesses), ys(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = rng() % w;
+        ys[i] = rng() % h;
+    }
+
+    std::uint64_t sum = 0;
+    auto start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            const size_t c[2] = { x, y };
+            sum += g.data()[LegacyOffset<2>(dims, c)];
+        }
+    }
+    Report("sequential (legacy offsets)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            sum += g(x, y);
+        }
+    }
+    Report("sequential (stride table)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        const size_t c[2] = { xs[i], ys[i] };
+        sum += g.data()[LegacyOffset<2>(dims, c)];
+    }
+    Report("random (legacy offsets)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += g(xs[i], ys[i]);
+    }
+    Report("random (stride table)", ElapsedMs(start), sum);
+}
+
+void BenchmarkAccess3D(size_t w, size_t h, size_t d, size_t random_accesses)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Access 3D (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<3, std::uint32_t> g(w, h, d);
+    g.assign(1);
+    const size_t dims[3] = { w, h, d };
+
+    std::mt19937 rng(0);
+    std::vector<size_t> xs(random_accesses), ys(random_accesses), zs(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = rng() % w;
+        ys[i] = rng() % h;
+        zs[i] = rng() % d;
+    }
+
+    std::uint64_t sum = 0;
+    auto start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t z = 0; z < d; ++z) {
+                const size_t c[3] = { x, y, z };
+                sum += g.data()[LegacyOffset<3>(dims, c)];
+            }
+        }
+    }
+    Report("sequential (legacy offsets)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t z = 0; z < d; ++z) {
+                sum += g(x, y, z);
+            }
+        }
+    }
+    Report("sequential (stride table)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        const size_t c[3] = { xs[i], ys[i], zs[i] };
+        sum += g.data()[LegacyOffset<3>(dims, c)];
+    }
+    Report("random (legacy offsets)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += g(xs[i], ys[i], zs[i]);
+    }
+    Report("random (stride table)", ElapsedMs(start), sum);
+}
+
+void BenchmarkCheckedAccess(size_t w, size_t h, size_t random_accesses)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Checked access 2D (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<2, std::uint32_t> g(w, h);
+    g.assign(1);
+
+    // signed coordinates, about a fifth of which fall outside the grid
+    std::mt19937 rng(0);
+    const int mx = (int)w / 10;
+    const int my = (int)h / 10;
+    std::vector<int> xs(random_accesses), ys(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = (int)(rng() % (w + 2 * mx)) - mx;
+        ys[i] = (int)(rng() % (h + 2 * my)) - my;
+    }
+
+    std::uint64_t sum = 0;
+    auto start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        if (xs[i] >= 0 && xs[i] < (int)w && ys[i] >= 0 && ys[i] < (int)h) {
+            sum += g(xs[i], ys[i]);
+        }
+    }
+    Report("manual check + operator()", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        if (g.within_bounds(xs[i], ys[i])) {
+            sum += g(xs[i], ys[i]);
+        }
+    }
+    Report("within_bounds + operator()", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        if (const std::uint32_t* p = g.find(xs[i], ys[i])) {
+            sum += *p;
+        }
+    }
+    Report("find", ElapsedMs(start), sum);
+
+    // in-bounds accesses only, to compare against unchecked access
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = rng() % w;
+        ys[i] = rng() % h;
+    }
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += g(xs[i], ys[i]);
+    }
+    Report("in bounds: operator()", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        if (const std::uint32_t* p = g.find(xs[i], ys[i])) {
+            sum += *p;
+        }
+    }
+    Report("in bounds: find", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += g.at(xs[i], ys[i]);
+    }
+    Report("in bounds: at", ElapsedMs(start), sum);
+}
+
+void BenchmarkIteration(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Iteration 3D (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    typedef au::grid<3, std::uint32_t> grid_type;
+    grid_type g(w, h, d);
+
+    auto start = clock_type::now();
+    std::fill(g.begin(), g.end(), 1);
+    Report("std::fill (full extent iterator)", ElapsedMs(start), g(0, 0, 0));
+
+    std::uint64_t sum = 0;
+    start = clock_type::now();
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        sum += *it;
+    }
+    Report("iterator sum (full extent)", ElapsedMs(start), sum);
+
+    grid_type::index bmin(w / 4, h / 4, d / 4);
+    grid_type::index bmax(3 * w / 4, 3 * h / 4, 3 * d / 4);
+
+    start = clock_type::now();
+    std::fill(g.gbegin(bmin, bmax), g.gend(bmin, bmax), 2);
+    Report("std::fill (sub-box iterator)", ElapsedMs(start), g(w / 2, h / 2, d / 2));
+
+    start = clock_type::now();
+    au::fill(g, bmin, bmax, 3u);
+    Report("au::fill (sub-box rows)", ElapsedMs(start), g(w / 2, h / 2, d / 2));
+
+    sum = 0;
+    start = clock_type::now();
+    for (auto it = g.gbegin(bmin, bmax); it != g.gend(bmin, bmax); ++it) {
+        sum += *it;
+    }
+    Report("iterator sum (sub-box)", ElapsedMs(start), sum);
+
+    start = clock_type::now();
+    g.resize(w + 1, h + 1, d + 1);
+    Report("resize (row-wise copy)", ElapsedMs(start), g(w / 2, h / 2, d / 2));
+}
+
+template <typename Layout>
+std::uint64_t NeighborSum6(const au::grid<3, std::uint8_t, Layout>& g, size_t x, size_t y, size_t z)
+{
+    return g(x - 1, y, z) + g(x + 1, y, z) +
+           g(x, y - 1, z) + g(x, y + 1, z) +
+           g(x, y, z - 1) + g(x, y, z + 1);
+}
+
+template <typename Layout>
+std::uint64_t NeighborSum26(const au::grid<3, std::uint8_t, Layout>& g, size_t x, size_t y, size_t z)
+{
+    std::uint64_t sum = 0;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                if (dx | dy | dz) {
+                    sum += g(x + dx, y + dy, z + dz);
+                }
+            }
+        }
+    }
+    return sum;
+}
+
+template <typename Layout>
+void BenchmarkNeighbors(const char* name, size_t w, size_t h, size_t d, size_t random_queries)
+{
+    std::cout << "  [" << name << "]" << std::endl;
+
+    au::grid<3, std::uint8_t, Layout> g(w, h, d);
+    g.assign(1);
+
+    std::uint64_t sum = 0;
+    auto start = clock_type::now();
+    for (size_t x = 1; x < w - 1; ++x) {
+        for (size_t y = 1; y < h - 1; ++y) {
+            for (size_t z = 1; z < d - 1; ++z) {
+                sum += NeighborSum6(g, x, y, z);
+            }
+        }
+    }
+    Report("6-connected sweep", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t x = 1; x < w - 1; ++x) {
+        for (size_t y = 1; y < h - 1; ++y) {
+            for (size_t z = 1; z < d - 1; ++z) {
+                sum += NeighborSum26(g, x, y, z);
+            }
+        }
+    }
+    Report("26-connected sweep", ElapsedMs(start), sum);
+
+    // random queries model the access pattern of a graph search, where
+    // consecutive expansions are spatially close but not in storage order
+    std::mt19937 rng(0);
+    std::vector<size_t> qs(3 * random_queries);
+    size_t x = w / 2, y = h / 2, z = d / 2;
+    for (size_t i = 0; i < random_queries; ++i) {
+        x = std::min(w - 2, std::max<size_t>(1, x + (rng() % 9) - 4));
+        y = std::min(h - 2, std::max<size_t>(1, y + (rng() % 9) - 4));
+        z = std::min(d - 2, std::max<size_t>(1, z + (rng() % 9) - 4));
+        qs[3 * i + 0] = x;
+        qs[3 * i + 1] = y;
+        qs[3 * i + 2] = z;
+    }
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_queries; ++i) {
+        sum += NeighborSum26(g, qs[3 * i], qs[3 * i + 1], qs[3 * i + 2]);
+    }
+    Report("26-connected random walk", ElapsedMs(start), sum);
+}
+
+void BenchmarkLayouts(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Layouts 3D (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    const size_t random_queries = 1 << 22;
+    BenchmarkNeighbors<au::row_major>("row_major", w, h, d, random_queries);
+    BenchmarkNeighbors<au::tiled<8>>("tiled<8>", w, h, d, random_queries);
+    BenchmarkNeighbors<au::morton>("morton", w, h, d, random_queries);
+}
+
+template <typename Allocator>
+void BenchmarkRandomAccessWith(const char* name, size_t w, size_t h, size_t d, size_t random_accesses)
+{
+    au::grid<3, float, au::row_major, Allocator> g;
+    g.resize_uninitialized(w, h, d);
+    std::fill(g.data(), g.data() + g.total_size(), 1.0f);
+
+    std::mt19937 rng(0);
+    std::vector<size_t> offsets(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        offsets[i] = rng() % g.total_size();
+    }
+
+    double sum = 0.0;
+    auto start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += g.data()[offsets[i]];
+    }
+    Report(name, ElapsedMs(start), (std::uint64_t)sum);
+}
+
+void BenchmarkAllocation(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Allocation 3D (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    {
+        auto start = clock_type::now();
+        au::grid<3, float> g(w, h, d);
+        Report("resize (value-initialized)", ElapsedMs(start), (std::uint64_t)g(0, 0, 0));
+    }
+    {
+        auto start = clock_type::now();
+        au::grid<3, float> g;
+        g.resize_uninitialized(w, h, d);
+        Report("resize_uninitialized", ElapsedMs(start), (std::uint64_t)g.total_size());
+    }
+    {
+        au::grid<3, float> g;
+        g.resize_uninitialized(w, h, d);
+        auto start = clock_type::now();
+        g.resize_uninitialized(d, h, w);
+        Report("resize_uninitialized (same size, reused)", ElapsedMs(start), (std::uint64_t)g.total_size());
+    }
+
+    const size_t random_accesses = 1 << 23;
+    BenchmarkRandomAccessWith<au::aligned_allocator<>>(
+            "random access (regular pages)", w, h, d, random_accesses);
+    BenchmarkRandomAccessWith<au::aligned_allocator<64, true>>(
+            "random access (huge pages)", w, h, d, random_accesses);
+}
+
+void BenchmarkMappedLoad(size_t w, size_t h, size_t d, size_t random_accesses)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Mapped Load (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    const char* path = "/tmp/grid_bench.augrid";
+    {
+        au::grid<3, float> g(w, h, d);
+        g.assign(1.0f);
+        au::save_mapped_grid(path, g);
+    }
+
+    std::mt19937 rng(0);
+    std::vector<size_t> xs(random_accesses), ys(random_accesses), zs(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = rng() % w;
+        ys[i] = rng() % h;
+        zs[i] = rng() % d;
+    }
+
+    // the file is most likely in the page cache, so this measures the cost of
+    // copying versus mapping rather than disk throughput
+    double sum = 0.0;
+    auto start = clock_type::now();
+    {
+        au::grid<3, float> g;
+        g.resize_uninitialized(w, h, d);
+        FILE* f = fopen(path, "rb");
+        fseek(f, 4096, SEEK_SET);
+        size_t n = fread(g.data(), sizeof(float), g.storage_size(), f);
+        fclose(f);
+        for (size_t i = 0; i < random_accesses; ++i) {
+            sum += g(xs[i], ys[i], zs[i]);
+        }
+        sum += n;
+    }
+    Report("fread + random queries", ElapsedMs(start), (std::uint64_t)sum);
+
+    sum = 0.0;
+    start = clock_type::now();
+    {
+        au::mapped_grid<3, float> m;
+        m.open(path);
+        for (size_t i = 0; i < random_accesses; ++i) {
+            sum += m(xs[i], ys[i], zs[i]);
+        }
+    }
+    Report("mmap + random queries", ElapsedMs(start), (std::uint64_t)sum);
+
+    unlink(path);
+}
+
+// A building-like scene: a floor and a wall every 64 cells along x and y
+template <typename Grid>
+void FillWalls(Grid& g, size_t w, size_t h, size_t d)
+{
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            const bool wall = x % 64 == 0 || y % 64 == 0;
+            for (size_t z = 0; z < (wall ? d : 1); ++z) {
+                g(x, y, z) = 1;
+            }
+        }
+    }
+}
+
+void BenchmarkSparse(size_t w, size_t h, size_t d, size_t random_accesses)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Sparse (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    std::mt19937 rng(0);
+    std::vector<size_t> xs(random_accesses), ys(random_accesses), zs(random_accesses);
+    for (size_t i = 0; i < random_accesses; ++i) {
+        xs[i] = rng() % w;
+        ys[i] = rng() % h;
+        zs[i] = rng() % d;
+    }
+
+    au::grid<3, std::uint8_t> dense(w, h, d);
+    au::sparse_grid<3, std::uint8_t> sparse(w, h, d);
+
+    auto start = clock_type::now();
+    FillWalls(dense, w, h, d);
+    Report("dense fill walls", ElapsedMs(start), dense.storage_size());
+
+    start = clock_type::now();
+    FillWalls(sparse, w, h, d);
+    Report("sparse fill walls", ElapsedMs(start), sparse.num_blocks());
+
+    std::cout << "  dense memory: " << dense.storage_size() / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "  sparse memory: " << sparse.memory_usage() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    const au::sparse_grid<3, std::uint8_t>& csparse = sparse;
+
+    std::uint64_t sum = 0;
+    start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t z = 0; z < d; ++z) {
+                sum += dense(x, y, z);
+            }
+        }
+    }
+    Report("dense sequential reads", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            for (size_t z = 0; z < d; ++z) {
+                sum += csparse(x, y, z);
+            }
+        }
+    }
+    Report("sparse sequential reads", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += dense(xs[i], ys[i], zs[i]);
+    }
+    Report("dense random reads", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_accesses; ++i) {
+        sum += csparse(xs[i], ys[i], zs[i]);
+    }
+    Report("sparse random reads", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (auto it = dense.begin(); it != dense.end(); ++it) {
+        sum += *it;
+    }
+    Report("dense iteration (all cells)", ElapsedMs(start), sum);
+
+    sum = 0;
+    start = clock_type::now();
+    for (auto it = sparse.begin(); it != sparse.end(); ++it) {
+        sum += *it;
+    }
+    Report("sparse iteration (allocated blocks)", ElapsedMs(start), sum);
+}
+
+void BenchmarkParallel(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Parallel (" << w << " x " << h << " x " << d << ", " << au::default_thread_pool().size() << " threads)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<3, float> g(w, h, d);
+    const au::grid_index<3, float> first(0, 0, 0);
+    const au::grid_index<3, float> last(w - 1, h - 1, d - 1);
+
+    // distance of each cell to the center, as a stand-in for per-cell work
+    // such as inflation or distance-field updates
+    auto dist = [&](const au::grid_index<3, float>& i, float& v)
+    {
+        const float dx = (float)i(0) - 0.5f * w;
+        const float dy = (float)i(1) - 0.5f * h;
+        const float dz = (float)i(2) - 0.5f * d;
+        v = std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+
+    au::thread_pool serial(1);
+
+    auto start = clock_type::now();
+    au::parallel_for_each(g, first, last, dist, serial);
+    Report("for_each (1 thread)", ElapsedMs(start), (std::uint64_t)g(0, 0, 0));
+
+    start = clock_type::now();
+    au::parallel_for_each(g, first, last, dist);
+    Report("parallel_for_each", ElapsedMs(start), (std::uint64_t)g(0, 0, 0));
+
+    auto sum = [](double a, double b) { return a + b; };
+
+    start = clock_type::now();
+    double total = au::parallel_reduce(g, first, last, 0.0, sum, serial);
+    Report("reduce (1 thread)", ElapsedMs(start), (std::uint64_t)total);
+
+    start = clock_type::now();
+    total = au::parallel_reduce(g, first, last, 0.0, sum);
+    Report("parallel_reduce", ElapsedMs(start), (std::uint64_t)total);
+
+    au::grid<3, float> t(w, h, d);
+    auto inflate = [](float v) { return std::exp(-0.1f * v); };
+
+    start = clock_type::now();
+    au::transform(g, t, first, last, inflate);
+    Report("transform", ElapsedMs(start), (std::uint64_t)(1000 * t(w / 2, h / 2, d / 2)));
+
+    start = clock_type::now();
+    au::parallel_transform(g, t, first, last, inflate);
+    Report("parallel_transform", ElapsedMs(start), (std::uint64_t)(1000 * t(w / 2, h / 2, d / 2)));
+}
+
+void BenchmarkSerialization(size_t w, size_t h, size_t d)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Serialization (" << w << " x " << h << " x " << d << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    const char* path = "/tmp/grid_bench.augrids";
+    const double mb = w * h * d / (1024.0 * 1024.0);
+
+    au::grid<3, std::uint8_t> g(w, h, d);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < w * h * d / 1000; ++i) {
+        const size_t x = rng() % w;
+        const size_t y = rng() % h;
+        for (size_t z = 0; z < d; ++z) {
+            g(x, y, z) = 1;
+        }
+    }
+
+    // the per-element stream I/O that grids were persisted with before
+    auto start = clock_type::now();
+    {
+        std::ofstream ofs(path, std::ios_base::binary);
+        for (auto it = g.begin(); it != g.end(); ++it) {
+            ofs << (int)*it << ' ';
+        }
+    }
+    Report("per-element text save", ElapsedMs(start), (std::uint64_t)mb);
+
+    start = clock_type::now();
+    {
+        std::ifstream ifs(path, std::ios_base::binary);
+        int v;
+        for (auto it = g.begin(); it != g.end() && ifs >> v; ++it) {
+            *it = (std::uint8_t)v;
+        }
+    }
+    Report("per-element text load", ElapsedMs(start), (std::uint64_t)mb);
+
+    au::grid_write_options raw;
+    raw.compress = false;
+
+    start = clock_type::now();
+    au::save_grid(path, g, raw);
+    Report("save_grid (raw)", ElapsedMs(start), (std::uint64_t)mb);
+
+    au::grid<3, std::uint8_t> r;
+    start = clock_type::now();
+    au::load_grid(path, r);
+    Report("load_grid (raw)", ElapsedMs(start), r(w / 2, h / 2, d / 2));
+
+    start = clock_type::now();
+    au::save_grid(path, g);
+    Report("save_grid (rle)", ElapsedMs(start), (std::uint64_t)mb);
+
+    std::ifstream size_check(path, std::ios_base::binary | std::ios_base::ate);
+    std::cout << "  compressed size: " << size_check.tellg() / (1024.0 * 1024.0) << " MB of " << mb << " MB" << std::endl;
+
+    start = clock_type::now();
+    au::load_grid(path, r);
+    Report("load_grid (rle)", ElapsedMs(start), r(w / 2, h / 2, d / 2));
+
+    au::grid<3, std::uint8_t> region;
+    start = clock_type::now();
+    std::ifstream ifs(path, std::ios_base::binary);
+    au::read_grid_region(ifs,
+            au::grid_index<3, std::uint8_t>(w / 2, 0, 0),
+            au::grid_index<3, std::uint8_t>(w / 2 + 15, h - 1, d - 1),
+            region);
+    Report("read_grid_region (16 rows)", ElapsedMs(start), region.total_size());
+
+    unlink(path);
+}
+
+void BenchmarkKernels(size_t w, size_t h, int reps)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Kernels (" << w << " x " << h << " int8, " << reps << " reps)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<2, std::int8_t> a(w, h);
+    au::grid<2, std::int8_t> b(w, h);
+    std::mt19937 rng(0);
+    for (auto it = a.begin(); it != a.end(); ++it) {
+        *it = (std::int8_t)rng();
+    }
+    for (auto it = b.begin(); it != b.end(); ++it) {
+        *it = (std::int8_t)rng();
+    }
+
+    au::grid<2, std::uint8_t> mask(w, h);
+    au::grid<2, std::int8_t> dst(w, h);
+
+    // element-wise loops through the grid's iterators
+    auto start = clock_type::now();
+    for (int r = 0; r < reps; ++r) {
+        auto mit = mask.begin();
+        for (auto it = a.begin(); it != a.end(); ++it, ++mit) {
+            *mit = *it >= 10;
+        }
+    }
+    Report("threshold (iterators)", ElapsedMs(start), mask(w / 2, h / 2));
+
+    start = clock_type::now();
+    for (int r = 0; r < reps; ++r) {
+        auto bit = b.begin();
+        auto dit = dst.begin();
+        for (auto it = a.begin(); it != a.end(); ++it, ++bit, ++dit) {
+            *dit = (std::int8_t)std::max(-128, std::min(127, *it + *bit));
+        }
+    }
+    Report("add_saturate (iterators)", ElapsedMs(start), (std::uint8_t)dst(w / 2, h / 2));
+
+    const au::simd_isa isas[] = { au::simd_scalar, au::simd_sse2, au::simd_avx2 };
+    const char* names[] = { "scalar", "sse2", "avx2" };
+    for (int i = 0; i < 3; ++i) {
+        au::set_simd_isa(isas[i]);
+        if (au::active_simd_isa() != isas[i]) {
+            continue;
+        }
+        std::cout << "  [" << names[i] << "]" << std::endl;
+
+        start = clock_type::now();
+        for (int r = 0; r < reps; ++r) {
+            au::threshold(a, (std::int8_t)10, mask);
+        }
+        Report("threshold", ElapsedMs(start), mask(w / 2, h / 2));
+
+        start = clock_type::now();
+        for (int r = 0; r < reps; ++r) {
+            au::elementwise_max(a, b, dst);
+        }
+        Report("elementwise_max", ElapsedMs(start), (std::uint8_t)dst(w / 2, h / 2));
+
+        start = clock_type::now();
+        for (int r = 0; r < reps; ++r) {
+            au::add_saturate(a, b, dst);
+        }
+        Report("add_saturate", ElapsedMs(start), (std::uint8_t)dst(w / 2, h / 2));
+
+        std::uint64_t count = 0;
+        start = clock_type::now();
+        for (int r = 0; r < reps; ++r) {
+            count += au::count_at_least(a, (std::int8_t)10);
+        }
+        Report("count_at_least", ElapsedMs(start), count);
+
+        std::vector<std::uint64_t> bits;
+        start = clock_type::now();
+        for (int r = 0; r < reps; ++r) {
+            au::pack_bits(mask, bits);
+        }
+        Report("pack_bits", ElapsedMs(start), bits[bits.size() / 2]);
+    }
+    au::set_simd_isa(au::simd_avx2);
+}
+
+void BenchmarkBitgrid(size_t w, size_t h, size_t d, size_t random_queries)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Bitgrid (" << w << " x " << h << " x " << d << ", " << random_queries << " queries)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<3, char> g(w, h, d);
+    std::mt19937 rng(0);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = rng() % 16 == 0;
+    }
+
+    au::bitgrid<3> b;
+    auto start = clock_type::now();
+    b.assign(g);
+    Report("assign from grid<3, char>", ElapsedMs(start), b.count());
+
+    std::cout << "  memory: " << g.total_size() / (1024.0 * 1024.0) << " MB (char) vs "
+            << b.memory_usage() / (1024.0 * 1024.0) << " MB (bits)" << std::endl;
+
+    std::vector<size_t> queries(3 * random_queries);
+    for (size_t i = 0; i < random_queries; ++i) {
+        queries[3 * i + 0] = rng() % w;
+        queries[3 * i + 1] = rng() % h;
+        queries[3 * i + 2] = rng() % d;
+    }
+
+    std::uint64_t hits = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_queries; ++i) {
+        hits += g(queries[3 * i], queries[3 * i + 1], queries[3 * i + 2]) != 0;
+    }
+    Report("random collision checks (char)", ElapsedMs(start), hits);
+
+    hits = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < random_queries; ++i) {
+        hits += b(queries[3 * i], queries[3 * i + 1], queries[3 * i + 2]);
+    }
+    Report("random collision checks (bits)", ElapsedMs(start), hits);
+
+    start = clock_type::now();
+    hits = std::count(g.begin(), g.end(), 1);
+    Report("count occupied (char)", ElapsedMs(start), hits);
+
+    start = clock_type::now();
+    hits = b.count();
+    Report("count occupied (bits)", ElapsedMs(start), hits);
+
+    au::bitgrid<3> c = b;
+    start = clock_type::now();
+    c |= b;
+    c.flip();
+    Report("union and complement (bits)", ElapsedMs(start), c.count());
+}
+
+void BenchmarkRollingGrid(size_t w, size_t h, int steps)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Rolling window (" << w << " x " << h << ", " << steps << " one-cell moves)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    // recenter by allocating a new grid and copying the overlap, as local
+    // maps were moved before
+    au::grid<2, std::int8_t> g(w, h);
+    auto start = clock_type::now();
+    for (int s = 0; s < steps; ++s) {
+        au::grid<2, std::int8_t> moved(w, h);
+        for (size_t x = 0; x + 1 < w; ++x) {
+            for (size_t y = 0; y + 1 < h; ++y) {
+                moved(x, y) = g(x + 1, y + 1);
+            }
+        }
+        for (size_t y = 0; y < h; ++y) {
+            moved(w - 1, y) = (std::int8_t)s;
+        }
+        for (size_t x = 0; x < w; ++x) {
+            moved(x, h - 1) = (std::int8_t)s;
+        }
+        g = std::move(moved);
+    }
+    Report("copy into shifted grid", ElapsedMs(start), (std::uint8_t)g(w / 2, h / 2));
+
+    au::rolling_grid<2, std::int8_t> r(w, h);
+    std::vector<au::rolling_grid<2, std::int8_t>::box> invalidated;
+    const ptrdiff_t delta[2] = { 1, 1 };
+    start = clock_type::now();
+    for (int s = 0; s < steps; ++s) {
+        invalidated.clear();
+        r.shift(delta, &invalidated);
+        for (const auto& b : invalidated) {
+            for (ptrdiff_t x = b.min[0]; x <= b.max[0]; ++x) {
+                for (ptrdiff_t y = b.min[1]; y <= b.max[1]; ++y) {
+                    r(x, y) = (std::int8_t)s;
+                }
+            }
+        }
+    }
+    Report("rolling_grid::shift + refill", ElapsedMs(start),
+            (std::uint8_t)r(r.origin(0) + w / 2, r.origin(1) + h / 2));
+}
+
+void BenchmarkMetricGrid(size_t w, size_t h, size_t d, size_t num_points)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Point insertion (" << w << " x " << h << " x " << d << ", " << num_points << " points)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    // padded xyz points, some outside the grid
+    const double res = 0.02;
+    std::vector<float> cloud(4 * num_points);
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> coord(-0.5f, 1.1f * w * res);
+    for (size_t i = 0; i < num_points; ++i) {
+        cloud[4 * i + 0] = coord(rng);
+        cloud[4 * i + 1] = coord(rng);
+        cloud[4 * i + 2] = coord(rng) * d / w;
+        cloud[4 * i + 3] = 1.0f;
+    }
+
+    const double origin[3] = { -0.25, -0.25, -0.25 };
+
+    // per-point arithmetic and bounds checks, as callers have written it
+    au::grid<3, std::uint8_t> g(w, h, d);
+    std::uint64_t inserted = 0;
+    auto start = clock_type::now();
+    for (size_t i = 0; i < num_points; ++i) {
+        const int x = (int)std::floor((cloud[4 * i + 0] - origin[0]) / res);
+        const int y = (int)std::floor((cloud[4 * i + 1] - origin[1]) / res);
+        const int z = (int)std::floor((cloud[4 * i + 2] - origin[2]) / res);
+        if (x >= 0 && x < (int)w && y >= 0 && y < (int)h && z >= 0 && z < (int)d) {
+            g(x, y, z) = 1;
+            ++inserted;
+        }
+    }
+    Report("per-point floor and bounds checks", ElapsedMs(start), inserted);
+
+    au::metric_grid<3, std::uint8_t> m(au::grid_frame<3>(origin, res), w, h, d);
+    start = clock_type::now();
+    inserted = m.insert(cloud.data(), num_points, 4, 1);
+    Report("metric_grid::insert", ElapsedMs(start), inserted);
+
+    std::vector<ptrdiff_t> cells(3 * num_points);
+    start = clock_type::now();
+    m.frame().world_to_grid(cloud.data(), num_points, 4, cells.data());
+    Report("grid_frame::world_to_grid (batch)", ElapsedMs(start), (std::uint64_t)cells[3 * (num_points / 2)]);
+}
+
+void BenchmarkPyramid(size_t w, size_t h, size_t box, size_t num_queries)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Pyramid box queries (" << w << " x " << h << ", " << box << " x " << box << " boxes)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<2, std::uint8_t> g(w, h);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < w * h / 20000; ++i) {
+        g(rng() % w, rng() % h) = 1;
+    }
+
+    std::vector<au::grid_index<2, std::uint8_t>> starts(num_queries);
+    for (size_t i = 0; i < num_queries; ++i) {
+        starts[i] = au::grid_index<2, std::uint8_t>(rng() % (w - box), rng() % (h - box));
+    }
+
+    std::uint64_t hits = 0;
+    auto start = clock_type::now();
+    for (size_t i = 0; i < num_queries; ++i) {
+        const au::grid_index<2, std::uint8_t>& s = starts[i];
+        bool hit = false;
+        for (size_t x = s(0); x < s(0) + box && !hit; ++x) {
+            for (size_t y = s(1); y < s(1) + box; ++y) {
+                if (g(x, y)) {
+                    hit = true;
+                    break;
+                }
+            }
+        }
+        hits += hit;
+    }
+    Report("scan for occupied cell", ElapsedMs(start), hits);
+
+    start = clock_type::now();
+    au::max_pyramid<2, std::uint8_t> p(g);
+    Report("build pyramid", ElapsedMs(start), p.num_levels());
+
+    hits = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < num_queries; ++i) {
+        const au::grid_index<2, std::uint8_t>& s = starts[i];
+        const au::grid_index<2, std::uint8_t> e(s(0) + box - 1, s(1) + box - 1);
+        hits += p.any_at_least(s, e, 1);
+    }
+    Report("pyramid any_at_least", ElapsedMs(start), hits);
+
+    start = clock_type::now();
+    for (size_t i = 0; i < 1000; ++i) {
+        const au::grid_index<2, std::uint8_t> s(rng() % (w - 8), rng() % (h - 8));
+        const au::grid_index<2, std::uint8_t> e(s(0) + 7, s(1) + 7);
+        for (size_t x = s(0); x <= e(0); ++x) {
+            for (size_t y = s(1); y <= e(1); ++y) {
+                p.base()(x, y) = 1;
+            }
+        }
+        p.update(s, e);
+    }
+    Report("1000 8x8 updates", ElapsedMs(start), p.level(p.num_levels() - 1)(0, 0));
+}
+
+void BenchmarkSummedAreaTable(size_t w, size_t h, size_t bw, size_t bh, size_t num_queries)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Summed-area table (" << w << " x " << h << ", " << bw << " x " << bh << " boxes)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    au::grid<2, std::uint8_t> g(w, h);
+    std::mt19937 rng(0);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = rng() % 254;
+    }
+
+    typedef au::grid_index<2, std::uint8_t> index;
+    std::vector<index> starts(num_queries);
+    for (size_t i = 0; i < num_queries; ++i) {
+        starts[i] = index(rng() % (w - bw), rng() % (h - bh));
+    }
+
+    std::uint64_t total = 0;
+    auto start = clock_type::now();
+    for (size_t i = 0; i < num_queries; ++i) {
+        const index e(starts[i](0) + bw - 1, starts[i](1) + bh - 1);
+        for (auto it = g.gbegin(starts[i], e); it != g.gend(starts[i], e); ++it) {
+            total += *it;
+        }
+    }
+    Report("gbegin/gend box sums", ElapsedMs(start), total);
+
+    au::thread_pool serial(1);
+    start = clock_type::now();
+    au::summed_area_table<2, std::uint8_t> sat(g, serial);
+    Report("build (1 thread)", ElapsedMs(start), sat.sum(index(0, 0), index(w - 1, h - 1)));
+
+    start = clock_type::now();
+    sat.assign(g);
+    Report("build (default pool)", ElapsedMs(start), sat.sum(index(0, 0), index(w - 1, h - 1)));
+
+    total = 0;
+    start = clock_type::now();
+    for (size_t i = 0; i < num_queries; ++i) {
+        const index e(starts[i](0) + bw - 1, starts[i](1) + bh - 1);
+        total += sat.sum(starts[i], e);
+    }
+    Report("summed-area table box sums", ElapsedMs(start), total);
+
+    start = clock_type::now();
+    g(w - 64, h - 64) = 255;
+    sat.update(g, index(w - 64, h - 64), index(w - 64, h - 64));
+    Report("update near the high corner", ElapsedMs(start), sat.sum(index(0, 0), index(w - 1, h - 1)));
+}
+
+void BenchmarkConnectedComponents(size_t w, size_t h)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Connected components (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    // random blobs
+    au::grid<2, char> g(w, h);
+    std::mt19937 rng(0);
+    for (size_t b = 0; b < w * h / 400; ++b) {
+        const size_t cx = rng() % w;
+        const size_t cy = rng() % h;
+        const size_t r = 1 + rng() % 8;
+        for (size_t x = cx > r ? cx - r : 0; x < std::min(w, cx + r); ++x) {
+            for (size_t y = cy > r ? cy - r : 0; y < std::min(h, cy + r); ++y) {
+                g(x, y) = 1;
+            }
+        }
+    }
+
+    // depth-first flood fill from each unlabeled cell, with an explicit stack
+    au::grid<2, std::uint32_t> labels(w, h);
+    std::uint32_t count = 0;
+    auto start = clock_type::now();
+    std::vector<std::pair<size_t, size_t>> stack;
+    for (size_t x = 0; x < w; ++x) {
+        for (size_t y = 0; y < h; ++y) {
+            if (!g(x, y) || labels(x, y)) {
+                continue;
+            }
+            ++count;
+            labels(x, y) = count;
+            stack.push_back(std::make_pair(x, y));
+            while (!stack.empty()) {
+                const std::pair<size_t, size_t> c = stack.back();
+                stack.pop_back();
+                const int dx[4] = { -1, 1, 0, 0 };
+                const int dy[4] = { 0, 0, -1, 1 };
+                for (int n = 0; n < 4; ++n) {
+                    const size_t nx = c.first + dx[n];
+                    const size_t ny = c.second + dy[n];
+                    if (nx < w && ny < h && g(nx, ny) && !labels(nx, ny)) {
+                        labels(nx, ny) = count;
+                        stack.push_back(std::make_pair(nx, ny));
+                    }
+                }
+            }
+        }
+    }
+    Report("flood fill", ElapsedMs(start), count);
+
+    au::thread_pool serial(1);
+    start = clock_type::now();
+    count = au::label_components(g, labels, [](char c) { return c != 0; }, au::connect_faces, serial);
+    Report("label_components (1 thread)", ElapsedMs(start), count);
+
+    start = clock_type::now();
+    count = au::label_components(g, labels, au::connect_faces);
+    Report("label_components (default pool)", ElapsedMs(start), count);
+
+    std::vector<au::component_stats<2>> stats;
+    start = clock_type::now();
+    au::component_statistics(labels, count, stats);
+    Report("component_statistics", ElapsedMs(start), stats.size());
+}
+
+void BenchmarkMorphology(size_t w, size_t h)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Morphology (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    // sparse obstacles, as in a costmap
+    au::grid<2, std::uint8_t> g(w, h);
+    std::mt19937 rng(0);
+    for (size_t n = 0; n < w * h / 100; ++n) {
+        g(rng() % w, rng() % h) = 255;
+    }
+
+    const int radii[] = { 2, 8, 32 };
+    for (int r : radii) {
+        std::cout << "radius " << r << std::endl;
+
+        // stamp a disc around each obstacle
+        au::grid<2, std::uint8_t> stamped(w, h);
+        auto start = clock_type::now();
+        for (size_t x = 0; x < w; ++x) {
+            for (size_t y = 0; y < h; ++y) {
+                if (!g(x, y)) {
+                    continue;
+                }
+                for (int dx = -r; dx <= r; ++dx) {
+                    for (int dy = -r; dy <= r; ++dy) {
+                        const size_t nx = x + dx;
+                        const size_t ny = y + dy;
+                        if (dx * dx + dy * dy <= r * r && nx < w && ny < h) {
+                            stamped(nx, ny) = 1;
+                        }
+                    }
+                }
+            }
+        }
+        Report("  disc stamping", ElapsedMs(start), std::count(stamped.begin(), stamped.end(), 1));
+
+        au::grid<2, std::uint8_t> inflated;
+        start = clock_type::now();
+        au::inflate(g, inflated, r);
+        Report("  inflate", ElapsedMs(start), std::count(inflated.begin(), inflated.end(), 1));
+
+        const size_t box[2] = { (size_t)r, (size_t)r };
+        au::grid<2, std::uint8_t> dilated;
+        start = clock_type::now();
+        au::dilate(g, dilated, box);
+        Report("  dilate (box)", ElapsedMs(start), std::count(dilated.begin(), dilated.end(), 255));
+
+        const size_t ux = w / 2;
+        const size_t uy = h / 2;
+        g(ux, uy) = 255;
+        start = clock_type::now();
+        au::inflate_region(g, inflated, r,
+                au::grid_index<2, std::uint8_t>(ux, uy),
+                au::grid_index<2, std::uint8_t>(ux, uy));
+        Report("  inflate_region (1 cell)", ElapsedMs(start), inflated(ux, uy));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkAccess2D(2048, 2048, 1 << 22);
+    BenchmarkAccess3D(256, 256, 128, 1 << 22);
+    BenchmarkCheckedAccess(2048, 2048, 1 << 22);
+    BenchmarkIteration(256, 256, 128);
+    BenchmarkLayouts(256, 256, 256);
+    BenchmarkAllocation(512, 512, 256);
+    BenchmarkMappedLoad(512, 512, 256, 1 << 12);
+    BenchmarkSparse(1024, 1024, 128, 1 << 22);
+    BenchmarkParallel(512, 512, 256);
+    BenchmarkSerialization(512, 512, 256);
+    BenchmarkKernels(2048, 2048, 20);
+    BenchmarkBitgrid(512, 512, 256, 1 << 22);
+    BenchmarkRollingGrid(400, 400, 1000);
+    BenchmarkMetricGrid(256, 256, 128, 1 << 22);
+    BenchmarkPyramid(2048, 2048, 128, 1 << 14);
+    BenchmarkSummedAreaTable(2048, 2048, 20, 40, 1 << 16);
+    BenchmarkConnectedComponents(2048, 2048);
+    BenchmarkMorphology(2048, 2048);
+    return 0;
+}
@@ -1,12 +1,40 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #define BOOST_TEST_MODULE GridTest
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 
+#include <spellbook/grid/bitgrid.h>
+#include <spellbook/grid/connected_components.h>
+#include <spellbook/grid/distance_transform.h>
+#include <spellbook/grid/dynamic_distance_field.h>
 #include <spellbook/grid/grid.h>
+#include <spellbook/grid/grid_view.h>
+#include <spellbook/grid/kernels.h>
+#include <spellbook/grid/mapped_grid.h>
+#include <spellbook/grid/metric_grid.h>
+#include <spellbook/grid/morphology.h>
+#include <spellbook/grid/parallel.h>
+#include <spellbook/grid/pyramid.h>
+#include <spellbook/grid/rolling_grid.h>
+#include <spellbook/grid/serialization.h>
+#include <spellbook/grid/sparse_grid.h>
+#include <spellbook/grid/summed_area_table.h>
+#include <spellbook/mapgen/MapGenerator.h>
 
 BOOST_AUTO_TEST_CASE(GridDefaultConstructorTest)
 {
@@ -166,6 +194,56 @@ BOOST_AUTO_TEST_CASE(GridOutOfBoundsTest)
     BOOST_CHECK(!g1.within_bounds(5, 5));
 }
 
+BOOST_AUTO_TEST_CASE(GridCheckedAccessTest)
+{
+    au::grid<2, int> g(5, 7);
+    g(4, 6) = 3;
+
+    // coordinates that are in range for one dimension but out of range for
+    // another must not alias a different element
+    BOOST_CHECK_THROW(g.at(0, 7), std::out_of_range);
+    BOOST_CHECK(!g.find(0, 7));
+
+    BOOST_REQUIRE(g.find(4, 6));
+    BOOST_CHECK_EQUAL(*g.find(4, 6), 3);
+    BOOST_CHECK_EQUAL(g.find(4, 6), &g(4, 6));
+    BOOST_CHECK_EQUAL(g.find(au::grid_index<2, int>(4, 6)), &g(4, 6));
+    BOOST_CHECK(!g.find(au::grid_index<2, int>(5, 0)));
+    BOOST_CHECK(noexcept(g.find(0, 0)));
+
+    // signed and floating-point coordinates
+    BOOST_CHECK(!g.within_bounds(-1, 0));
+    BOOST_CHECK(!g.within_bounds(0, (long long)-1));
+    BOOST_CHECK(!g.within_bounds((signed char)-128, 0));
+    BOOST_CHECK(!g.within_bounds(-0.5, 0.0));
+    BOOST_CHECK(!g.within_bounds(5.0, 0.0));
+    BOOST_CHECK(g.within_bounds(4.5, 6.5));
+    BOOST_CHECK(!g.within_bounds(std::nan(""), 0.0));
+    BOOST_CHECK(!g.find(-1, -1));
+    BOOST_CHECK_THROW(g.at(-1, 0), std::out_of_range);
+
+    // the error reports the coordinates as given
+    std::string what;
+    try {
+        g.at(-2.5, 1.0);
+    }
+    catch (const std::out_of_range& e) {
+        what = e.what();
+    }
+    BOOST_CHECK_EQUAL(what, "coordinates (-2.5, 1) out of range of grid of size (5, 7)");
+    try {
+        g.at(au::grid_index<2, int>(5, 0));
+    }
+    catch (const std::out_of_range& e) {
+        what = e.what();
+    }
+    BOOST_CHECK_EQUAL(what, "coordinates (5, 0) out of range of grid of size (5, 7)");
+
+    const au::grid<2, int>& cg = g;
+    BOOST_CHECK_EQUAL(cg.find(4, 6), &g(4, 6));
+    BOOST_CHECK(!cg.find(2, -3));
+}
+
 BOOST_AUTO_TEST_CASE(GridIteratorTest)
 {
     au::grid<2, int> empty;
@@ -284,3 +362,1327 @@ BOOST_AUTO_TEST_CASE(GridResizeTest)
         std::cout << std::endl;
     }
 }
+
+BOOST_AUTO_TEST_CASE(GridIteratorIndexTest)
+{
+    au::grid<3, int> g(3, 4, 5);
+    int n = 0;
+    for (size_t x = 0; x < 3; ++x) {
+        for (size_t y = 0; y < 4; ++y) {
+            for (size_t z = 0; z < 5; ++z) {
+                g(x, y, z) = n++;
+            }
+        }
+    }
+
+    // full-extent iteration visits elements in row-major order and reports
+    // the coordinates of each
+    n = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        BOOST_CHECK_EQUAL(*it, n++);
+        BOOST_CHECK_EQUAL(g(it.coord(0), it.coord(1), it.coord(2)), *it);
+    }
+    BOOST_CHECK_EQUAL(n, 60);
+
+    // a box spanning the inner dimensions fully is a contiguous slab
+    au::grid<3, int>::index start(1, 0, 0), end(2, 3, 4);
+    n = 20;
+    for (auto it = g.gbegin(start, end); it != g.gend(start, end); ++it) {
+        BOOST_CHECK_EQUAL(*it, n++);
+        BOOST_CHECK_EQUAL(g(it.cindex()), *it);
+    }
+    BOOST_CHECK_EQUAL(n, 60);
+
+    // a box with a partial inner dimension
+    au::grid<3, int>::index bstart(0, 1, 1), bend(1, 2, 3);
+    int count = 0;
+    for (auto it = g.gbegin(bstart, bend); it != g.gend(bstart, bend); ++it) {
+        BOOST_CHECK_EQUAL(g(it.cindex()), *it);
+        BOOST_CHECK(it.coord(1) >= 1 && it.coord(1) <= 2);
+        BOOST_CHECK(it.coord(2) >= 1 && it.coord(2) <= 3);
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, 2 * 2 * 3);
+}
+
+BOOST_AUTO_TEST_CASE(GridRowAlgorithmTest)
+{
+    au::grid<2, int> g(4, 6);
+    g.assign(0);
+
+    au::grid<2, int>::index start(1, 2), end(2, 4);
+    au::fill(g, start, end, 7);
+    for (size_t x = 0; x < 4; ++x) {
+        for (size_t y = 0; y < 6; ++y) {
+            const bool inside = x >= 1 && x <= 2 && y >= 2 && y <= 4;
+            BOOST_CHECK_EQUAL(g(x, y), inside ? 7 : 0);
+        }
+    }
+
+    au::grid<2, double> h(4, 6);
+    h.assign(-1.0);
+    au::transform(g, h, start, end, [](int v) { return 0.5 * v; });
+    for (size_t x = 0; x < 4; ++x) {
+        for (size_t y = 0; y < 6; ++y) {
+            const bool inside = x >= 1 && x <= 2 && y >= 2 && y <= 4;
+            BOOST_CHECK_EQUAL(h(x, y), inside ? 3.5 : -1.0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GridResizePreservesDataTest)
+{
+    au::grid<2, int> g(3, 4);
+    for (size_t x = 0; x < 3; ++x) {
+        for (size_t y = 0; y < 4; ++y) {
+            g(x, y) = 10 * x + y;
+        }
+    }
+
+    g.resize(5, 2);
+    BOOST_CHECK_EQUAL(g.size(0), 5);
+    BOOST_CHECK_EQUAL(g.size(1), 2);
+    for (size_t x = 0; x < 3; ++x) {
+        for (size_t y = 0; y < 2; ++y) {
+            BOOST_CHECK_EQUAL(g(x, y), 10 * x + y);
+        }
+    }
+
+    g.resize(2, 2);
+    for (size_t x = 0; x < 2; ++x) {
+        for (size_t y = 0; y < 2; ++y) {
+            BOOST_CHECK_EQUAL(g(x, y), 10 * x + y);
+        }
+    }
+}
+
+template <typename Layout>
+void CheckLayout()
+{
+    au::grid<3, int, Layout> g(5, 9, 17);
+    BOOST_CHECK_EQUAL(g.total_size(), 5 * 9 * 17);
+    BOOST_CHECK(g.storage_size() >= g.total_size());
+
+    // every cell maps to a distinct location in storage
+    std::vector<int> hits(g.storage_size(), 0);
+    for (size_t x = 0; x < 5; ++x) {
+        for (size_t y = 0; y < 9; ++y) {
+            for (size_t z = 0; z < 17; ++z) {
+                const int* p = &g(x, y, z);
+                BOOST_REQUIRE(p >= g.data() && p < g.data() + g.storage_size());
+                ++hits[p - g.data()];
+                g(x, y, z) = (int)(100 * x + 10 * y + z);
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(std::count(hits.begin(), hits.end(), 1), 5 * 9 * 17);
+
+    // iteration visits cells in row-major coordinate order regardless of
+    // storage order
+    size_t count = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        const size_t x = count / (9 * 17);
+        const size_t y = (count / 17) % 9;
+        const size_t z = count % 17;
+        BOOST_CHECK_EQUAL(it.coord(0), x);
+        BOOST_CHECK_EQUAL(it.coord(1), y);
+        BOOST_CHECK_EQUAL(it.coord(2), z);
+        BOOST_CHECK_EQUAL(*it, (int)(100 * x + 10 * y + z));
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, g.total_size());
+
+    typename au::grid<3, int, Layout>::index start(1, 2, 3), end(3, 4, 12);
+    au::fill(g, start, end, -1);
+    BOOST_CHECK_EQUAL(g(2, 3, 4), -1);
+    BOOST_CHECK_EQUAL(g(0, 3, 4), 34);
+
+    g.resize(4, 10, 10);
+    BOOST_CHECK_EQUAL(g(0, 8, 9), 89);
+    BOOST_CHECK_EQUAL(g(3, 4, 9), -1);
+
+    au::grid<3, int, Layout> h(g);
+    BOOST_CHECK_EQUAL(h(0, 8, 9), 89);
+}
+
+BOOST_AUTO_TEST_CASE(GridLayoutTest)
+{
+    CheckLayout<au::row_major>();
+    CheckLayout<au::tiled<4>>();
+    CheckLayout<au::tiled<8>>();
+    CheckLayout<au::morton>();
+}
+
+BOOST_AUTO_TEST_CASE(GridAllocatorTest)
+{
+    au::grid<2, double> g(7, 3);
+    BOOST_CHECK_EQUAL((uintptr_t)g.data() % 64, 0);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        BOOST_CHECK_EQUAL(*it, 0.0);
+    }
+
+    au::grid<2, float, au::row_major, au::aligned_allocator<4096, true>> h(300, 300);
+    BOOST_CHECK_EQUAL((uintptr_t)h.data() % 4096, 0);
+
+    // reuses the buffer when the size is unchanged
+    double* data = g.data();
+    g.resize_uninitialized(3, 7);
+    BOOST_CHECK_EQUAL(g.data(), data);
+    BOOST_CHECK_EQUAL(g.size(0), 3);
+    BOOST_CHECK_EQUAL(g.size(1), 7);
+
+    g.resize_uninitialized(10, 10);
+    BOOST_CHECK_EQUAL(g.total_size(), 100);
+    BOOST_CHECK_EQUAL((uintptr_t)g.data() % 64, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GridNonTrivialElementTest)
+{
+    au::grid<2, std::string> g(2, 3);
+    BOOST_CHECK(g(1, 2).empty());
+    g(1, 2) = "a string long enough to need a heap allocation";
+
+    au::grid<2, std::string> h(g);
+    BOOST_CHECK_EQUAL(h(1, 2), g(1, 2));
+
+    h.resize(4, 4);
+    BOOST_CHECK_EQUAL(h(1, 2), g(1, 2));
+    BOOST_CHECK(h(3, 3).empty());
+
+    g.clear();
+    BOOST_CHECK_EQUAL(g.total_size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MappedGridTest)
+{
+    char path[] = "/tmp/mapped_grid_testXXXXXX";
+    int fd = mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+
+    au::grid<3, int, au::tiled<4>> g(5, 6, 7);
+    int v = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = v++;
+    }
+    BOOST_REQUIRE(au::save_mapped_grid(path, g));
+
+    au::mapped_grid<3, int, au::tiled<4>> m;
+    BOOST_REQUIRE(m.open(path));
+    BOOST_CHECK(!m.writable());
+    BOOST_CHECK_EQUAL(m.size(0), 5);
+    BOOST_CHECK_EQUAL(m.size(1), 6);
+    BOOST_CHECK_EQUAL(m.size(2), 7);
+    BOOST_CHECK_EQUAL(m.storage_size(), g.storage_size());
+    BOOST_CHECK_EQUAL((uintptr_t)m.data() % 64, 0);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        BOOST_CHECK_EQUAL(m(it.cindex()), *it);
+    }
+    BOOST_CHECK(m.within_bounds(4, 5, 6));
+    BOOST_CHECK(!m.within_bounds(5, 0, 0));
+    BOOST_CHECK(!m.within_bounds(-1, 0, 0));
+    BOOST_CHECK(!m.within_bounds(0.0, -0.5, 0.0));
+
+    // header mismatches are rejected
+    au::mapped_grid<3, int> wrong_layout;
+    BOOST_CHECK(!wrong_layout.open(path));
+    au::mapped_grid<3, double, au::tiled<4>> wrong_type;
+    BOOST_CHECK(!wrong_type.open(path));
+    au::mapped_grid<2, int, au::tiled<4>> wrong_dims;
+    BOOST_CHECK(!wrong_dims.open(path));
+    BOOST_CHECK(!m.open("/nonexistent/mapped_grid"));
+    BOOST_CHECK(!m.is_open());
+
+    // private modifications are not written back
+    au::mapped_grid<3, int, au::tiled<4>> cow;
+    BOOST_REQUIRE(cow.open(path, au::mapped_grid<3, int, au::tiled<4>>::copy_on_write));
+    cow(1, 2, 3) = -1;
+    BOOST_CHECK_EQUAL(cow(1, 2, 3), -1);
+
+    au::mapped_grid<3, int, au::tiled<4>> moved(std::move(cow));
+    BOOST_CHECK(!cow.is_open());
+    BOOST_CHECK_EQUAL(moved(1, 2, 3), -1);
+
+    BOOST_REQUIRE(m.open(path));
+    BOOST_CHECK_EQUAL(m(1, 2, 3), g(1, 2, 3));
+
+    unlink(path);
+}
+
+BOOST_AUTO_TEST_CASE(GridViewTest)
+{
+    au::grid<3, int> g(4, 5, 6);
+    int v = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = v++;
+    }
+
+    au::grid_view<3, int> gv(g);
+    BOOST_CHECK_EQUAL(gv.total_size(), g.total_size());
+    BOOST_CHECK_EQUAL(gv(3, 4, 5), g(3, 4, 5));
+    BOOST_CHECK(std::equal(gv.begin(), gv.end(), g.begin()));
+
+    // windows refer to the same elements
+    au::grid_view<3, int> w = gv.window(au::grid_index<3, int>(1, 1, 2), au::grid_index<3, int>(2, 3, 4));
+    BOOST_CHECK_EQUAL(w.size(0), 2);
+    BOOST_CHECK_EQUAL(w.size(1), 3);
+    BOOST_CHECK_EQUAL(w.size(2), 3);
+    BOOST_CHECK(w.within_bounds(1, 2, 2));
+    BOOST_CHECK(!w.within_bounds(-1, 0, 0));
+    BOOST_CHECK(!w.within_bounds(0.0, 0.0, -0.5));
+    BOOST_CHECK(!w.within_bounds(2, 0, 0));
+    w(0, 0, 0) = -1;
+    BOOST_CHECK_EQUAL(g(1, 1, 2), -1);
+    size_t count = 0;
+    for (auto it = w.begin(); it != w.end(); ++it) {
+        BOOST_CHECK_EQUAL(*it, g(it.coord(0) + 1, it.coord(1) + 1, it.coord(2) + 2));
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, w.total_size());
+
+    // iterating backwards from the end visits the same elements in reverse
+    std::vector<int> forward(w.begin(), w.end());
+    std::vector<int> backward;
+    for (auto it = w.end(); it != w.begin(); ) {
+        --it;
+        backward.push_back(*it);
+    }
+    BOOST_CHECK(std::equal(forward.rbegin(), forward.rend(), backward.begin()));
+
+    // slicing the middle dimension
+    au::grid_view<2, const int> s = au::grid_view<3, const int>(gv).slice(1, 2);
+    BOOST_CHECK_EQUAL(s.size(0), 4);
+    BOOST_CHECK_EQUAL(s.size(1), 6);
+    for (auto it = s.begin(); it != s.end(); ++it) {
+        BOOST_CHECK_EQUAL(*it, g(it.coord(0), 2, it.coord(1)));
+    }
+
+    // a column-major foreign buffer, e.g. nav_msgs::OccupancyGrid data indexed
+    // as (x, y)
+    std::vector<int8_t> data(3 * 2);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (int8_t)i;
+    }
+    const size_t sizes[2] = { 3, 2 };
+    const ptrdiff_t strides[2] = { 1, 3 };
+    au::grid_view<2, const int8_t> og(data.data(), sizes, strides);
+    BOOST_CHECK_EQUAL(og(2, 1), 5);
+    BOOST_CHECK_EQUAL(og(1, 0), 1);
+    BOOST_CHECK(og.within_bounds(2, 1));
+    BOOST_CHECK(!og.within_bounds(3, 0));
+    BOOST_CHECK(!og.within_bounds(-1, 0));
+
+    au::grid_view<2, int8_t> rm(data.data(), 2, 3);
+    BOOST_CHECK_EQUAL(rm(1, 2), 5);
+    BOOST_CHECK_EQUAL(rm.stride(0), 3);
+}
+
+BOOST_AUTO_TEST_CASE(SparseGridTest)
+{
+    au::sparse_grid<3, int, 4> g(10, 9, 7);
+    g.set_background(-1);
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+    BOOST_CHECK_EQUAL(g.total_size(), 10 * 9 * 7);
+    BOOST_CHECK(g.begin() == g.end());
+    BOOST_CHECK(g.within_bounds(9, 8, 6));
+    BOOST_CHECK(!g.within_bounds(9, -1, 6));
+    BOOST_CHECK(!g.within_bounds(-0.5, 0.0, 0.0));
+
+    const au::sparse_grid<3, int, 4>& cg = g;
+    BOOST_CHECK_EQUAL(cg(9, 8, 6), -1);
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+
+    g(9, 8, 6) = 5;
+    g(0, 0, 0) = 7;
+    g(1, 1, 1) = 8;
+    BOOST_CHECK_EQUAL(g.num_blocks(), 2);
+    BOOST_CHECK_EQUAL(cg(9, 8, 6), 5);
+    BOOST_CHECK_EQUAL(cg(0, 0, 0), 7);
+    BOOST_CHECK_EQUAL(cg(8, 8, 6), -1);
+    BOOST_CHECK(g.is_allocated(au::grid_index<3, int>(8, 8, 4)));
+    BOOST_CHECK(!g.is_allocated(au::grid_index<3, int>(4, 0, 0)));
+    BOOST_CHECK(g.within_bounds(9, 8, 6));
+    BOOST_CHECK(!g.within_bounds(10, 0, 0));
+
+    // the edge block (8..9, 8, 4..6) is clipped to the grid bounds
+    size_t count = 0;
+    int sum = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        BOOST_CHECK(g.within_bounds(it.coord(0), it.coord(1), it.coord(2)));
+        BOOST_CHECK_EQUAL(&*it, &g(it.cindex()));
+        if (*it != -1) {
+            sum += *it;
+        }
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, 4 * 4 * 4 + 2 * 1 * 3);
+    BOOST_CHECK_EQUAL(sum, 20);
+
+    // copies are deep; moves leave the source empty
+    au::sparse_grid<3, int, 4> h(g);
+    h(0, 0, 0) = 0;
+    BOOST_CHECK_EQUAL(cg(0, 0, 0), 7);
+
+    au::sparse_grid<3, int, 4> m(std::move(h));
+    BOOST_CHECK_EQUAL(h.num_blocks(), 0);
+    BOOST_CHECK_EQUAL(m(0, 0, 0), 0);
+    BOOST_CHECK_EQUAL(m(9, 8, 6), 5);
+
+    g.clear();
+    BOOST_CHECK_EQUAL(g.num_blocks(), 0);
+    BOOST_CHECK_EQUAL(cg(0, 0, 0), -1);
+}
+
+template <typename Layout>
+void CheckParallel(au::thread_pool& pool)
+{
+    au::grid<3, int, Layout> g(37, 11, 6);
+    const au::grid_index<3, int> start(0, 0, 0);
+    const au::grid_index<3, int> end(36, 10, 5);
+    au::parallel_for_each(g, start, end, [](const au::grid_index<3, int>& i, int& v)
+    {
+        v = (int)(i(0) * 100 + i(1) * 10 + i(2));
+    }, pool);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        const au::grid_index<3, int>& i = it.cindex();
+        BOOST_CHECK_EQUAL(*it, (int)(i(0) * 100 + i(1) * 10 + i(2)));
+    }
+
+    const au::grid_index<3, int> box_start(3, 2, 1);
+    const au::grid_index<3, int> box_end(30, 9, 4);
+    long long expected = 0;
+    for (auto it = g.gbegin(box_start, box_end); it != g.gend(box_start, box_end); ++it) {
+        expected += *it;
+    }
+    long long sum = au::parallel_reduce(g, box_start, box_end, 0LL,
+            [](long long a, long long b) { return a + b; }, pool);
+    BOOST_CHECK_EQUAL(sum, expected);
+
+    au::grid<3, double, Layout> d(37, 11, 6);
+    au::parallel_transform(g, d, box_start, box_end, [](int v) { return 0.5 * v; }, pool);
+    BOOST_CHECK_EQUAL(d(3, 2, 1), 0.5 * g(3, 2, 1));
+    BOOST_CHECK_EQUAL(d(30, 9, 4), 0.5 * g(30, 9, 4));
+    BOOST_CHECK_EQUAL(d(2, 2, 1), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(GridParallelTest)
+{
+    au::thread_pool pool(4);
+    BOOST_CHECK_EQUAL(pool.size(), 4);
+    CheckParallel<au::row_major>(pool);
+    CheckParallel<au::tiled<4>>(pool);
+
+    // nested loops run serially instead of deadlocking
+    std::vector<int> counts(8, 0);
+    pool.parallel_for(8, [&](size_t i)
+    {
+        pool.parallel_for(3, [&](size_t) { ++counts[i]; });
+    });
+    BOOST_CHECK(std::count(counts.begin(), counts.end(), 3) == 8);
+
+    BOOST_CHECK_THROW(
+            pool.parallel_for(16, [](size_t i) { if (i == 7) throw std::runtime_error("fail"); }),
+            std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(GridParallelStressTest)
+{
+    // back-to-back small loops, so that workers often wake up late for a loop
+    // that has already completed; every index must still run exactly once
+    au::thread_pool pool(8);
+    std::vector<std::atomic<int>> counts(8);
+    int failures = 0;
+    for (int iter = 0; iter < 20000; ++iter) {
+        const size_t count = 2 + iter % 7;
+        for (size_t i = 0; i < count; ++i) {
+            counts[i] = 0;
+        }
+        pool.parallel_for(count, [&](size_t i)
+        {
+            ++counts[i];
+            std::this_thread::yield();
+        });
+        for (size_t i = 0; i < count; ++i) {
+            failures += (counts[i] != 1);
+        }
+    }
+    BOOST_CHECK_EQUAL(failures, 0);
+}
+
+BOOST_AUTO_TEST_CASE(DistanceTransformTest)
+{
+    au::thread_pool pool(3);
+
+    // compare against brute force on a random 3D grid with a tiled layout
+    au::grid<3, int, au::tiled<4>> g(9, 7, 5);
+    unsigned seed = 1;
+    std::vector<au::grid_index<3, int>> obstacles;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        seed = seed * 1103515245 + 12345;
+        *it = (seed >> 16) % 9 == 0 ? 3 : 0;
+        if (*it == 3) {
+            obstacles.push_back(it.cindex());
+        }
+    }
+    BOOST_REQUIRE(!obstacles.empty());
+
+    au::grid<3, float> sq;
+    au::squared_distance_transform(g, sq, [](int v) { return v == 3; }, pool);
+    BOOST_REQUIRE_EQUAL(sq.size(0), 9);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        const au::grid_index<3, int>& i = it.cindex();
+        long best = std::numeric_limits<long>::max();
+        for (size_t k = 0; k < obstacles.size(); ++k) {
+            long d = 0;
+            for (int j = 0; j < 3; ++j) {
+                const long dj = (long)i(j) - (long)obstacles[k](j);
+                d += dj * dj;
+            }
+            best = std::min(best, d);
+        }
+        BOOST_CHECK_EQUAL(sq(i(0), i(1), i(2)), (float)best);
+    }
+
+    // a Map with a single wall column
+    Map map(6, 4);
+    for (int y = 0; y < 4; ++y) {
+        map(2, y) = 1;
+    }
+    au::grid<2, float> d;
+    au::distance_transform(map, d);
+    BOOST_CHECK_EQUAL(d(2, 1), 0.0f);
+    BOOST_CHECK_EQUAL(d(0, 3), 2.0f);
+    BOOST_CHECK_EQUAL(d(5, 0), 3.0f);
+
+    au::grid<2, float> sd;
+    map(3, 1) = 1;
+    au::signed_distance_transform(map, sd);
+    BOOST_CHECK_EQUAL(sd(0, 0), 2.0f);
+    BOOST_CHECK_EQUAL(sd(2, 0), -1.0f);
+    BOOST_CHECK_EQUAL(sd(2, 1), -1.0f);
+    BOOST_CHECK_CLOSE(sd(4, 0), std::sqrt(2.0f), 1e-4);
+
+    // no obstacles
+    Map empty(3, 3);
+    au::distance_transform(empty, d);
+    BOOST_CHECK(std::isinf(d(1, 1)));
+}
+
+BOOST_AUTO_TEST_CASE(DynamicDistanceFieldTest)
+{
+    const int w = 16, h = 12, d = 8;
+    au::dynamic_distance_field<3> field(w, h, d);
+    au::grid<3, unsigned char> occupancy(w, h, d);
+
+    typedef au::grid_index<3, float> index;
+    BOOST_CHECK(std::isinf(field.distance(index(1, 2, 3))));
+
+    // replay random edits and compare against a full rebuild
+    unsigned seed = 7;
+    for (int batch = 0; batch < 10; ++batch) {
+        for (int e = 0; e < 20; ++e) {
+            seed = seed * 1103515245 + 12345;
+            const int x = (seed >> 8) % w;
+            const int y = (seed >> 12) % h;
+            const int z = (seed >> 16) % d;
+            if ((seed >> 20) % 3) {
+                occupancy(x, y, z) = 1;
+                field.set_obstacle(index(x, y, z));
+            }
+            else {
+                occupancy(x, y, z) = 0;
+                field.clear_obstacle(index(x, y, z));
+            }
+        }
+        BOOST_CHECK(field.update() > 0);
+
+        au::grid<3, float> exact;
+        au::distance_transform(occupancy, exact);
+        for (auto it = exact.begin(); it != exact.end(); ++it) {
+            const index& i = it.cindex();
+            BOOST_CHECK_EQUAL(field.is_obstacle(i), occupancy(i(0), i(1), i(2)) != 0);
+            BOOST_CHECK_CLOSE(field.distance(i), *it, 1e-4);
+        }
+    }
+
+    // nothing to do without changes
+    BOOST_CHECK_EQUAL(field.update(), 0);
+
+    // removing every obstacle leaves the field empty
+    for (auto it = occupancy.begin(); it != occupancy.end(); ++it) {
+        const au::grid_index<3, unsigned char>& i = it.cindex();
+        field.clear_obstacle(index(i(0), i(1), i(2)));
+    }
+    field.update();
+    index o;
+    BOOST_CHECK(!field.nearest_obstacle(index(3, 3, 3), o));
+    BOOST_CHECK(std::isinf(field.distance(index(3, 3, 3))));
+
+    // a full rebuild from an occupancy grid
+    occupancy.assign(0);
+    occupancy(4, 5, 6) = 1;
+    field.assign(occupancy, [](unsigned char v) { return v != 0; });
+    BOOST_CHECK(field.nearest_obstacle(index(0, 0, 0), o));
+    BOOST_CHECK_EQUAL(o(0), 4);
+    BOOST_CHECK_EQUAL(field.squared_distance(index(0, 0, 0)), 16 + 25 + 36);
+
+    // cell offsets are 32-bit; too many cells are rejected before allocating
+    typedef au::dynamic_distance_field<2> field2;
+    BOOST_CHECK_THROW(field2(1 << 16, 1 << 16), std::length_error);
+    BOOST_CHECK_THROW(field2((size_t)1 << 40, (size_t)1 << 40), std::length_error);
+    BOOST_CHECK_THROW(field2(46342, 46342), std::length_error);
+
+    // assign() sizes the field to the occupancy grid
+    au::grid<2, char> map(6, 5);
+    map.assign(0);
+    map(5, 4) = 1;
+    field2 sized;
+    sized.assign(map, [](char c) { return c != 0; });
+    BOOST_CHECK_EQUAL(sized.size(0), 6);
+    BOOST_CHECK_EQUAL(sized.size(1), 5);
+    BOOST_CHECK_EQUAL(sized.squared_distance(field2::index(0, 0)), 25 + 16);
+    map.resize(3, 4);
+    map.assign(0);
+    map(0, 3) = 1;
+    sized.assign(map, [](char c) { return c != 0; });
+    BOOST_CHECK_EQUAL(sized.total_size(), 12);
+    BOOST_CHECK_EQUAL(sized.squared_distance(field2::index(2, 0)), 4 + 9);
+
+    // squared distances beyond the range of int
+    au::dynamic_distance_field<1> line(50000);
+    line.set_obstacle(au::dynamic_distance_field<1>::index(0));
+    line.update();
+    BOOST_CHECK_EQUAL(
+            line.squared_distance(au::dynamic_distance_field<1>::index(49999)),
+            49999u * 49999u);
+}
+
+BOOST_AUTO_TEST_CASE(GridSerializationTest)
+{
+    au::grid<3, float> g(13, 6, 5);
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        const au::grid_index<3, float>& i = it.cindex();
+        // runs of equal values along with distinct values
+        *it = i(0) < 6 ? 1.0f : (float)(i(0) * 100 + i(1) * 10 + i(2));
+    }
+
+    au::grid_write_options options;
+    options.chunk_size = 2 * 6 * 5 * sizeof(float); // two rows per chunk
+    std::stringstream ss;
+    BOOST_REQUIRE(au::write_grid(ss, g, options));
+
+    au::grid<3, float> r;
+    BOOST_REQUIRE(au::read_grid(ss, r));
+    BOOST_CHECK_EQUAL(r.size(0), 13);
+    BOOST_CHECK(std::equal(g.begin(), g.end(), r.begin()));
+
+    // into another layout
+    ss.seekg(0);
+    au::grid<3, float, au::tiled<4>> t;
+    BOOST_REQUIRE(au::read_grid(ss, t));
+    BOOST_CHECK(std::equal(g.begin(), g.end(), t.begin()));
+
+    // a region spanning several chunks
+    ss.seekg(0);
+    const au::grid_index<3, float> start(3, 1, 2);
+    const au::grid_index<3, float> end(8, 4, 4);
+    au::grid<3, float> region;
+    BOOST_REQUIRE(au::read_grid_region(ss, start, end, region));
+    BOOST_CHECK_EQUAL(region.size(0), 6);
+    BOOST_CHECK_EQUAL(region.size(1), 4);
+    BOOST_CHECK_EQUAL(region.size(2), 3);
+    for (auto it = region.begin(); it != region.end(); ++it) {
+        const au::grid_index<3, float>& i = it.cindex();
+        BOOST_CHECK_EQUAL(*it, g(i(0) + 3, i(1) + 1, i(2) + 2));
+    }
+
+    // occupancy-like data compresses well
+    au::grid<2, char> map(200, 300);
+    for (int x = 50; x < 60; ++x) {
+        for (int y = 0; y < 300; ++y) {
+            map(x, y) = 1;
+        }
+    }
+    std::stringstream ms;
+    BOOST_REQUIRE(au::write_grid(ms, map));
+    BOOST_CHECK(ms.str().size() < map.total_size() / 50);
+    au::grid<2, char> rmap;
+    BOOST_REQUIRE(au::read_grid(ms, rmap));
+    BOOST_CHECK(std::equal(map.begin(), map.end(), rmap.begin()));
+
+    // type mismatches and corruption are detected
+    ss.seekg(0);
+    au::grid<3, int> wrong_type;
+    BOOST_CHECK(!au::read_grid(ss, wrong_type));
+
+    std::string bytes = ss.str();
+    bytes[bytes.size() - 7] ^= 0x10;
+    std::stringstream corrupt(bytes);
+    BOOST_CHECK(!au::read_grid(corrupt, r));
+
+    // corrupt sizes fail the read instead of allocating or overflowing
+    const size_t dims_offset = 40;
+    const size_t chunk_offset = dims_offset + 2 * sizeof(uint64_t);
+    std::string mbytes = ms.str();
+    std::string huge_chunk = mbytes;
+    const uint64_t huge = (uint64_t)1 << 62;
+    memcpy(&huge_chunk[chunk_offset + 16], &huge, sizeof(huge));
+    std::stringstream huge_chunk_stream(huge_chunk);
+    BOOST_CHECK(!au::read_grid(huge_chunk_stream, rmap));
+
+    std::string overflow = mbytes;
+    const uint64_t big_dims[2] = { (uint64_t)1 << 40, (uint64_t)1 << 40 };
+    memcpy(&overflow[dims_offset], big_dims, sizeof(big_dims));
+    std::stringstream overflow_stream(overflow);
+    BOOST_CHECK(!au::read_grid(overflow_stream, rmap));
+
+    std::string unallocatable = mbytes;
+    const uint64_t large_dims[2] = { (uint64_t)1 << 31, (uint64_t)1 << 31 };
+    memcpy(&unallocatable[dims_offset], large_dims, sizeof(large_dims));
+    std::stringstream unallocatable_stream(unallocatable);
+    BOOST_CHECK(!au::read_grid(unallocatable_stream, rmap));
+
+    // and so do the region reader's
+    au::grid<2, char> small(4, 8);
+    small.assign(3);
+    std::stringstream small_stream;
+    BOOST_REQUIRE(au::write_grid(small_stream, small));
+    std::string wide = small_stream.str();
+    const uint64_t wide_dims[2] = { 4, (uint64_t)1 << 44 };
+    memcpy(&wide[dims_offset], wide_dims, sizeof(wide_dims));
+    std::stringstream wide_stream(wide);
+    const au::grid_index<2, char> origin(0, 0);
+    BOOST_CHECK(!au::read_grid_region(wide_stream, origin, origin, rmap));
+
+    // a skipped chunk that claims more data than the stream holds
+    std::string truncated = ss.str();
+    truncated.resize(dims_offset + 3 * sizeof(uint64_t) + 24 + 10);
+    std::stringstream truncated_stream(truncated);
+    BOOST_CHECK(!au::read_grid_region(truncated_stream, start, end, region));
+}
+
+BOOST_AUTO_TEST_CASE(GridKernelsTest)
+{
+    // odd sizes exercise the scalar tails of the vector loops
+    const size_t n = 1000 + 37;
+    std::vector<int8_t> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = (int8_t)(i * 37 + 11);
+        b[i] = (int8_t)(i * 101 + 3);
+    }
+    const uint8_t* ua = (const uint8_t*)a.data();
+    const uint8_t* ub = (const uint8_t*)b.data();
+
+    const au::simd_isa isas[] = { au::simd_scalar, au::simd_sse2, au::simd_avx2 };
+    for (au::simd_isa isa : isas) {
+        au::set_simd_isa(isa);
+        BOOST_CHECK(au::active_simd_isa() <= isa);
+
+        std::vector<uint8_t> mask(n);
+        std::vector<int8_t> s(n);
+        std::vector<uint8_t> u(n);
+        au::threshold(a.data(), n, (int8_t)-5, mask.data());
+        au::threshold(ua, n, (uint8_t)200, u.data());
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(mask[i], a[i] >= -5);
+            BOOST_CHECK_EQUAL(u[i], ua[i] >= 200);
+            count += a[i] >= -5;
+        }
+        BOOST_CHECK_EQUAL(au::count_at_least(a.data(), n, (int8_t)-5), count);
+        BOOST_CHECK_EQUAL(au::count_nonzero(mask.data(), n), count);
+
+        au::elementwise_min(a.data(), b.data(), n, s.data());
+        au::elementwise_max(ua, ub, n, u.data());
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(s[i], std::min(a[i], b[i]));
+            BOOST_CHECK_EQUAL(u[i], std::max(ua[i], ub[i]));
+        }
+
+        au::add_saturate(a.data(), b.data(), n, s.data());
+        au::add_saturate(ua, ub, n, u.data());
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(s[i], std::max(-128, std::min(127, a[i] + b[i])));
+            BOOST_CHECK_EQUAL(u[i], std::min(255, ua[i] + ub[i]));
+        }
+
+        std::vector<uint64_t> bits((n + 63) / 64, ~(uint64_t)0);
+        au::pack_bits(mask.data(), n, bits.data());
+        for (size_t i = 0; i < bits.size() * 64; ++i) {
+            const bool bit = (bits[i / 64] >> (i % 64)) & 1;
+            BOOST_CHECK_EQUAL(bit, i < n && mask[i]);
+        }
+    }
+    au::set_simd_isa(au::simd_avx2);
+
+    // grid overloads, including a non-byte element type
+    au::grid<2, char> g(31, 45);
+    au::grid<2, char> h(31, 45);
+    au::grid<2, float> f(31, 45);
+    for (int x = 0; x < 31; ++x) {
+        for (int y = 0; y < 45; ++y) {
+            g(x, y) = (char)((x * y) % 100);
+            h(x, y) = (char)(x + y);
+            f(x, y) = (float)(x - y);
+        }
+    }
+    au::grid<2, uint8_t> gmask;
+    au::threshold(g, (char)50, gmask);
+    BOOST_CHECK_EQUAL(gmask.size(0), 31);
+    BOOST_CHECK_EQUAL(gmask.size(1), 45);
+    BOOST_CHECK_EQUAL(au::count_nonzero(gmask), au::count_if(g, [](char c) { return c >= 50; }));
+    BOOST_CHECK_EQUAL(au::count_at_least(g, (char)50), au::count_nonzero(gmask));
+
+    au::elementwise_max(g, h, g);
+    BOOST_CHECK_EQUAL(g(30, 44), std::max((30 * 44) % 100, 74));
+
+    au::grid<2, uint8_t> fmask;
+    au::threshold(f, 0.0f, fmask);
+    BOOST_CHECK_EQUAL(au::count_nonzero(fmask), au::count_at_least(f, 0.0f));
+    std::vector<uint64_t> fbits;
+    au::pack_bits(f, fbits);
+    BOOST_CHECK_EQUAL(fbits.size(), (31 * 45 + 63) / 64);
+    BOOST_CHECK_EQUAL(fbits[0] & 1, 0);
+    BOOST_CHECK_EQUAL((fbits[0] >> 1) & 1, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BitgridTest)
+{
+    // rows that are not a multiple of the word size
+    au::bitgrid<3> b(4, 5, 70);
+    BOOST_CHECK_EQUAL(b.total_size(), 4 * 5 * 70);
+    BOOST_CHECK_EQUAL(b.words_per_row(), 2);
+    BOOST_CHECK_EQUAL(b.num_rows(), 20);
+    BOOST_CHECK(b.none());
+
+    au::grid<3, char> g(4, 5, 70);
+    for (int x = 0; x < 4; ++x) {
+        for (int y = 0; y < 5; ++y) {
+            for (int z = 0; z < 70; ++z) {
+                g(x, y, z) = (x * 7 + y * 3 + z) % 5 == 0;
+                b(x, y, z) = g(x, y, z) != 0;
+            }
+        }
+    }
+    const size_t expected = std::count(g.begin(), g.end(), 1);
+    BOOST_CHECK_EQUAL(b.count(), expected);
+
+    au::bitgrid<3> p;
+    p.assign(g);
+    BOOST_CHECK_EQUAL(p.size(2), 70);
+    BOOST_CHECK(std::equal(b.words(), b.words() + b.num_words(), p.words()));
+
+    au::grid<3, char> u;
+    p.unpack(u);
+    BOOST_CHECK(std::equal(g.begin(), g.end(), u.begin()));
+
+    // scanning visits the set cells in row-major order
+    size_t visited = 0;
+    au::bitgrid<3>::index i;
+    for (bool found = b.find_first(i); found; found = b.find_next(i)) {
+        BOOST_CHECK(g(i(0), i(1), i(2)) != 0);
+        ++visited;
+    }
+    BOOST_CHECK_EQUAL(visited, expected);
+
+    // flip leaves the padding clear
+    au::bitgrid<3> f = b;
+    f.flip();
+    BOOST_CHECK_EQUAL(f.count(), b.total_size() - expected);
+    f &= b;
+    BOOST_CHECK(f.none());
+    f |= b;
+    f ^= b;
+    BOOST_CHECK(f.none());
+
+    // proxy references
+    b(1, 2, 65) = true;
+    b(1, 2, 66) = b(1, 2, 65);
+    b(1, 2, 67).flip();
+    BOOST_CHECK(b(1, 2, 66));
+    BOOST_CHECK_EQUAL(b(1, 2, 67), !g(1, 2, 67));
+
+    // row extraction at an unaligned offset
+    uint64_t bits[2];
+    b.extract(au::bitgrid<3>::index(3, 4, 3), 67, bits);
+    for (int z = 0; z < 128; ++z) {
+        const bool bit = (bits[z / 64] >> (z % 64)) & 1;
+        BOOST_CHECK_EQUAL(bit, z < 67 && b(3, 4, z + 3));
+    }
+
+    b.assign(true);
+    BOOST_CHECK_EQUAL(b.count(), b.total_size());
+    BOOST_CHECK(b.within_bounds(3, 4, 69));
+    BOOST_CHECK(!b.within_bounds(3, 4, 70));
+    BOOST_CHECK(!b.within_bounds(3, -4, 0));
+    BOOST_CHECK(!b.within_bounds(3.0, 4.0, -0.5));
+}
+
+BOOST_AUTO_TEST_CASE(RollingGridTest)
+{
+    typedef au::rolling_grid<2, int> rolling_grid;
+    auto value = [](ptrdiff_t x, ptrdiff_t y) { return (int)(x * 1000 + y); };
+
+    rolling_grid g(7, 10);
+    g.set_background(-1);
+    for (ptrdiff_t x = 0; x < 7; ++x) {
+        for (ptrdiff_t y = 0; y < 10; ++y) {
+            g(x, y) = value(x, y);
+        }
+    }
+
+    const ptrdiff_t shifts[][2] = {
+        { 1, 0 }, { 0, -3 }, { 2, 4 }, { -5, 9 }, { -1, -1 }, { 7, 0 }, { 30, -40 }, { 0, 0 }
+    };
+    for (const ptrdiff_t* delta : shifts) {
+        const ptrdiff_t old_origin[2] = { g.origin(0), g.origin(1) };
+        std::vector<rolling_grid::box> invalidated;
+        g.shift(delta, &invalidated);
+        BOOST_CHECK_EQUAL(g.origin(0), old_origin[0] + delta[0]);
+        BOOST_CHECK_EQUAL(g.origin(1), old_origin[1] + delta[1]);
+
+        // the invalidated boxes are disjoint and cover exactly the cells
+        // that were not in the old window
+        au::grid<2, int> covered(7, 10);
+        for (const rolling_grid::box& b : invalidated) {
+            for (ptrdiff_t x = b.min[0]; x <= b.max[0]; ++x) {
+                for (ptrdiff_t y = b.min[1]; y <= b.max[1]; ++y) {
+                    BOOST_REQUIRE(g.within_bounds(x, y));
+                    BOOST_CHECK_EQUAL(g(x, y), -1);
+                    ++covered(x - g.origin(0), y - g.origin(1));
+                    g(x, y) = value(x, y);
+                }
+            }
+        }
+        for (ptrdiff_t x = g.origin(0); x < g.origin(0) + 7; ++x) {
+            for (ptrdiff_t y = g.origin(1); y < g.origin(1) + 10; ++y) {
+                const bool was_inside =
+                        x >= old_origin[0] && x < old_origin[0] + 7 &&
+                        y >= old_origin[1] && y < old_origin[1] + 10;
+                BOOST_CHECK_EQUAL(covered(x - g.origin(0), y - g.origin(1)), was_inside ? 0 : 1);
+                BOOST_CHECK_EQUAL(g(x, y), value(x, y));
+            }
+        }
+    }
+    BOOST_CHECK(!g.within_bounds(g.origin(0) - 1, g.origin(1)));
+    BOOST_CHECK(!g.within_bounds(g.origin(0), g.origin(1) + 10));
+
+    // world coordinates follow the cells, not the window
+    rolling_grid w(5, 5);
+    w.set_resolution(0.5);
+    const double p[2] = { 3.2, -1.1 };
+    ptrdiff_t c[2];
+    w.world_to_cell(p, c);
+    BOOST_CHECK_EQUAL(c[0], 6);
+    BOOST_CHECK_EQUAL(c[1], -3);
+    w.recenter(p);
+    BOOST_CHECK_EQUAL(w.origin(0), 4);
+    BOOST_CHECK_EQUAL(w.origin(1), -5);
+    double q[2];
+    w.cell_to_world(c, q);
+    BOOST_CHECK_CLOSE(q[0], 3.25, 1e-9);
+    BOOST_CHECK_CLOSE(q[1], -1.25, 1e-9);
+
+    // non-const coordinate arrays select the array overloads
+    BOOST_CHECK(w.within_bounds(c));
+    w(c) = 42;
+    BOOST_CHECK_EQUAL(w(c[0], c[1]), 42);
+
+    au::rolling_grid<1, int> line(5);
+    ptrdiff_t i[1] = { 2 };
+    BOOST_CHECK(line.within_bounds(i));
+    line(i) = 7;
+    BOOST_CHECK_EQUAL(line(2), 7);
+    i[0] = 5;
+    BOOST_CHECK(!line.within_bounds(i));
+}
+
+BOOST_AUTO_TEST_CASE(MetricGridTest)
+{
+    const double origin[3] = { -1.0, 2.0, 0.5 };
+    const au::grid_frame<3> frame(origin, 0.25);
+
+    // points on both sides of cell boundaries, including negative cells
+    const double p[3] = { -1.01, 2.0, 0.99 };
+    ptrdiff_t c[3];
+    frame.world_to_grid(p, c);
+    BOOST_CHECK_EQUAL(c[0], -1);
+    BOOST_CHECK_EQUAL(c[1], 0);
+    BOOST_CHECK_EQUAL(c[2], 1);
+    double q[3];
+    frame.grid_to_world(c, q);
+    BOOST_CHECK_CLOSE(q[0], -1.125, 1e-9);
+    BOOST_CHECK_CLOSE(q[1], 2.125, 1e-9);
+    BOOST_CHECK_CLOSE(q[2], 0.875, 1e-9);
+
+    // batched conversion of padded float points matches the scalar one
+    std::vector<float> cloud;
+    for (int i = 0; i < 100; ++i) {
+        cloud.push_back(-1.5f + 0.037f * i);
+        cloud.push_back(1.9f + 0.011f * i);
+        cloud.push_back(0.5f + 0.029f * i);
+        cloud.push_back(1.0f);
+    }
+    std::vector<ptrdiff_t> cells(3 * 100);
+    frame.world_to_grid(cloud.data(), 100, 4, cells.data());
+    for (int i = 0; i < 100; ++i) {
+        const double pi[3] = { cloud[4 * i], cloud[4 * i + 1], cloud[4 * i + 2] };
+        ptrdiff_t ci[3];
+        frame.world_to_grid(pi, ci);
+        BOOST_CHECK_EQUAL(cells[3 * i], ci[0]);
+        BOOST_CHECK_EQUAL(cells[3 * i + 1], ci[1]);
+        BOOST_CHECK_EQUAL(cells[3 * i + 2], ci[2]);
+    }
+    std::vector<double> centers(3 * 100);
+    frame.grid_to_world(cells.data(), 100, centers.data(), 3);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_SMALL(centers[3 * i] - cloud[4 * i], 0.125 + 1e-6);
+    }
+
+    au::metric_grid<3, int> g(frame, 8, 8, 8);
+    BOOST_CHECK(!g.find(p));
+    const double inside[3] = { -0.6, 2.3, 2.4 };
+    BOOST_REQUIRE(g.find(inside));
+    *g.find(inside) = 7;
+    BOOST_CHECK_EQUAL(g.cells()(1, 1, 7), 7);
+    au::metric_grid<3, int>::index i;
+    BOOST_CHECK(g.world_to_grid(inside, i));
+    BOOST_CHECK_EQUAL(i(2), 7);
+
+    size_t in_bounds = 0;
+    for (size_t k = 0; k < 100; ++k) {
+        bool inside = true;
+        for (int d = 0; d < 3; ++d) {
+            inside &= cells[3 * k + d] >= 0 && cells[3 * k + d] < 8;
+        }
+        in_bounds += inside;
+    }
+    BOOST_CHECK_EQUAL(g.insert(cloud.data(), 100, 4, 1), in_bounds);
+    BOOST_CHECK(in_bounds > 0 && in_bounds < 100);
+
+    // invalid points, as in organized clouds, and far away points are
+    // outside the grid rather than undefined
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const float invalid[4][4] = {
+        { nan, nan, nan, 1.0f },
+        { -0.6f, inf, 2.4f, 1.0f },
+        { -0.6f, 2.3f, -inf, 1.0f },
+        { 1e30f, 2.3f, 2.4f, 1.0f },
+    };
+    BOOST_CHECK_EQUAL(g.insert(&invalid[0][0], 4, 4, 2), 0);
+    for (int k = 0; k < 4; ++k) {
+        const double pk[3] = { invalid[k][0], invalid[k][1], invalid[k][2] };
+        BOOST_CHECK(!g.find(pk));
+        BOOST_CHECK(!g.world_to_grid(pk, i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GridPyramidTest)
+{
+    // odd sizes so that the coarser levels have partial cells
+    au::grid<3, int> g(13, 6, 21);
+    int v = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = (v = (v * 37 + 11) % 1001);
+    }
+
+    au::max_pyramid<3, int> maxp(g);
+    au::min_pyramid<3, int> minp(g);
+    BOOST_CHECK_EQUAL(maxp.num_levels(), 6);
+    BOOST_CHECK_EQUAL(maxp.level(5).total_size(), 1);
+    BOOST_CHECK_EQUAL(maxp.level(5)(0, 0, 0), *std::max_element(g.begin(), g.end()));
+    BOOST_CHECK_EQUAL(minp.level(5)(0, 0, 0), *std::min_element(g.begin(), g.end()));
+
+    auto check_boxes = [&]()
+    {
+        for (int b = 0; b < 50; ++b) {
+            const au::grid_index<3, int> start(b % 13, (b * 7) % 6, (b * 5) % 21);
+            const au::grid_index<3, int> end(
+                    std::min<size_t>(12, start(0) + b % 5), std::min<size_t>(5, start(1) + b % 4), std::min<size_t>(20, start(2) + b % 11));
+            int lo = std::numeric_limits<int>::max();
+            int hi = std::numeric_limits<int>::min();
+            for (auto it = g.gbegin(start, end); it != g.gend(start, end); ++it) {
+                lo = std::min(lo, *it);
+                hi = std::max(hi, *it);
+            }
+            BOOST_CHECK_EQUAL(maxp.reduce(start, end), hi);
+            BOOST_CHECK_EQUAL(minp.reduce(start, end), lo);
+            BOOST_CHECK(maxp.any_at_least(start, end, hi));
+            BOOST_CHECK(!maxp.any_at_least(start, end, hi + 1));
+            BOOST_CHECK(minp.any_at_least(start, end, lo));
+            BOOST_CHECK(!minp.any_at_least(start, end, lo - 1));
+        }
+    };
+    check_boxes();
+
+    // incremental updates
+    const au::grid_index<3, int> start(4, 2, 9);
+    const au::grid_index<3, int> end(6, 3, 12);
+    for (auto it = g.gbegin(start, end); it != g.gend(start, end); ++it) {
+        *it = 5000 + (int)it.coord(2);
+        maxp.base()(it.cindex()) = *it;
+        minp.base()(it.cindex()) = *it;
+    }
+    g(0, 0, 0) = -7;
+    maxp.base()(0, 0, 0) = -7;
+    minp.base()(0, 0, 0) = -7;
+    maxp.update(start, end);
+    minp.update(start, end);
+    maxp.update(au::grid_index<3, int>(0, 0, 0), au::grid_index<3, int>(0, 0, 0));
+    minp.update(au::grid_index<3, int>(0, 0, 0), au::grid_index<3, int>(0, 0, 0));
+    BOOST_CHECK_EQUAL(maxp.level(5)(0, 0, 0), 5012);
+    BOOST_CHECK_EQUAL(minp.level(5)(0, 0, 0), -7);
+    check_boxes();
+}
+
+BOOST_AUTO_TEST_CASE(SummedAreaTableTest)
+{
+    au::grid<3, int> g(9, 14, 11);
+    int v = 1;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        *it = (v = (v * 29 + 7) % 97) - 48;
+    }
+
+    au::thread_pool pool(3);
+    au::summed_area_table<3, int> sat(g, pool);
+    BOOST_CHECK_EQUAL(sat.size(0), 9);
+    BOOST_CHECK_EQUAL(sat.table().size(2), 12);
+
+    auto check_boxes = [&]()
+    {
+        for (int b = 0; b < 60; ++b) {
+            const au::grid_index<3, int> start(b % 9, (b * 5) % 14, (b * 3) % 11);
+            const au::grid_index<3, int> end(
+                    std::min<size_t>(8, start(0) + b % 4),
+                    std::min<size_t>(13, start(1) + b % 7),
+                    std::min<size_t>(10, start(2) + b % 6));
+            int64_t expected = 0;
+            for (auto it = g.gbegin(start, end); it != g.gend(start, end); ++it) {
+                expected += *it;
+            }
+            BOOST_CHECK_EQUAL(sat.sum(start, end), expected);
+        }
+    };
+    check_boxes();
+
+    const au::grid_index<3, int> start(3, 8, 2);
+    const au::grid_index<3, int> end(5, 9, 2);
+    for (auto it = g.gbegin(start, end); it != g.gend(start, end); ++it) {
+        *it += 1000;
+    }
+    sat.update(g, start, end);
+    check_boxes();
+
+    // a change reaching the high corner, and one near the origin, which
+    // rebuilds the table
+    const au::grid_index<3, int> corners[2][2] = {
+        { au::grid_index<3, int>(6, 11, 7), au::grid_index<3, int>(8, 13, 10) },
+        { au::grid_index<3, int>(0, 1, 0), au::grid_index<3, int>(2, 1, 4) },
+    };
+    for (int c = 0; c < 2; ++c) {
+        const au::grid_index<3, int>& lo = corners[c][0];
+        const au::grid_index<3, int>& hi = corners[c][1];
+        for (auto it = g.gbegin(lo, hi); it != g.gend(lo, hi); ++it) {
+            *it -= 77;
+        }
+        sat.update(g, lo, hi, pool);
+        check_boxes();
+    }
+
+    // unsigned sums wrap but box sums stay exact
+    au::grid<2, uint8_t> u(300, 301);
+    u.assign(255);
+    au::summed_area_table<2, uint8_t, uint32_t> usat(u);
+    const au::grid_index<2, uint8_t> lo(100, 100);
+    const au::grid_index<2, uint8_t> hi(199, 199);
+    BOOST_CHECK_EQUAL(usat.sum(lo, hi), 255u * 100 * 100);
+
+    // in one dimension the slabs of an update split the runs
+    au::grid<1, int> line(1000);
+    for (size_t i = 0; i < line.size(0); ++i) {
+        line(i) = (int)(i % 13);
+    }
+    au::thread_pool pool4(4);
+    au::summed_area_table<1, int> lsat(line, pool4);
+    const au::grid_index<1, int> changed_lo(600);
+    const au::grid_index<1, int> changed_hi(610);
+    for (int i = 600; i <= 610; ++i) {
+        line(i) += 1000;
+    }
+    lsat.update(line, changed_lo, changed_hi, pool4);
+    int64_t expected = 0;
+    bool line_ok = true;
+    for (int i = 0; i < 1000; ++i) {
+        expected += line(i);
+        line_ok &= lsat.sum(au::grid_index<1, int>(0), au::grid_index<1, int>(i)) == expected;
+    }
+    BOOST_CHECK(line_ok);
+}
+
+// Reference labeling by breadth-first flood fill from each unlabeled
+// foreground cell in row-major order.
+uint32_t FloodFillLabels(const au::grid<3, char>& g, au::grid<3, uint32_t>& labels, bool all)
+{
+    typedef au::grid_index<3, char> index;
+    typedef au::grid_index<3, uint32_t> label_index;
+    labels.resize(g.size(0), g.size(1), g.size(2));
+    labels.assign(0);
+    uint32_t count = 0;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        const index& seed = it.cindex();
+        const label_index lseed(seed(0), seed(1), seed(2));
+        if (!*it || labels(lseed)) {
+            continue;
+        }
+        ++count;
+        std::vector<index> queue(1, seed);
+        labels(lseed) = count;
+        for (size_t q = 0; q < queue.size(); ++q) {
+            const index c = queue[q];
+            for (int n = 0; n < 27; ++n) {
+                const int d[3] = { n / 9 - 1, n / 3 % 3 - 1, n % 3 - 1 };
+                if (!all && std::abs(d[0]) + std::abs(d[1]) + std::abs(d[2]) != 1) {
+                    continue;
+                }
+                const index nb(c(0) + d[0], c(1) + d[1], c(2) + d[2]);
+                if (!g.within_bounds(nb(0), nb(1), nb(2)) || !g(nb)) {
+                    continue;
+                }
+                const label_index lnb(nb(0), nb(1), nb(2));
+                if (!labels(lnb)) {
+                    labels(lnb) = count;
+                    queue.push_back(nb);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+BOOST_AUTO_TEST_CASE(ConnectedComponentsTest)
+{
+    au::grid<3, char> g(23, 17, 9);
+    unsigned v = 3;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        v = (v * 1103515245 + 12345) & 0x7fffffff;
+        *it = (v >> 16) % 100 < 40;
+    }
+
+    au::thread_pool pool(3);
+    for (int all = 0; all < 2; ++all) {
+        const au::grid_connectivity conn = all ? au::connect_all : au::connect_faces;
+        au::grid<3, uint32_t> expected;
+        const uint32_t expected_count = FloodFillLabels(g, expected, all != 0);
+
+        au::grid<3, uint32_t> labels;
+        const uint32_t count = au::label_components(g, labels, [](char c) { return c != 0; }, conn, pool);
+        BOOST_CHECK_EQUAL(count, expected_count);
+        BOOST_CHECK(std::equal(labels.begin(), labels.end(), expected.begin()));
+
+        BOOST_CHECK_EQUAL(au::label_components(g, labels, conn), expected_count);
+        BOOST_CHECK(std::equal(labels.begin(), labels.end(), expected.begin()));
+    }
+
+    // statistics of two known blobs in 2D
+    au::grid<2, int> m(10, 12);
+    for (int x = 1; x <= 3; ++x) {
+        for (int y = 2; y <= 5; ++y) {
+            m(x, y) = 1;
+        }
+    }
+    m(7, 9) = m(8, 10) = 1;
+    au::grid<2, uint32_t> labels;
+    BOOST_CHECK_EQUAL(au::label_components(m, labels, au::connect_faces), 3);
+    BOOST_CHECK_EQUAL(au::label_components(m, labels, au::connect_all), 2);
+    std::vector<au::component_stats<2>> stats;
+    au::component_statistics(labels, 2, stats);
+    BOOST_CHECK_EQUAL(stats[0].size, 12);
+    BOOST_CHECK_EQUAL(stats[0].min[0], 1);
+    BOOST_CHECK_EQUAL(stats[0].max[1], 5);
+    BOOST_CHECK_CLOSE(stats[0].centroid[0], 2.0, 1e-9);
+    BOOST_CHECK_CLOSE(stats[0].centroid[1], 3.5, 1e-9);
+    BOOST_CHECK_EQUAL(stats[1].size, 2);
+    BOOST_CHECK_CLOSE(stats[1].centroid[1], 9.5, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(MorphologyTest)
+{
+    au::grid<2, int> g(31, 19);
+    unsigned v = 7;
+    for (auto it = g.begin(); it != g.end(); ++it) {
+        v = (v * 1103515245 + 12345) & 0x7fffffff;
+        *it = (v >> 16) % 1000 - 500;
+    }
+
+    // box filters against brute force, including in place
+    au::thread_pool pool(3);
+    const size_t radii[2] = { 3, 1 };
+    au::grid<2, int> dilated;
+    au::grid<2, int> eroded = g;
+    au::dilate(g, dilated, radii, pool);
+    au::erode(eroded, eroded, radii, pool);
+    bool dilate_ok = true;
+    bool erode_ok = true;
+    for (int x = 0; x < 31; ++x) {
+        for (int y = 0; y < 19; ++y) {
+            int hi = std::numeric_limits<int>::lowest();
+            int lo = std::numeric_limits<int>::max();
+            for (int i = std::max(0, x - 3); i <= std::min(30, x + 3); ++i) {
+                for (int j = std::max(0, y - 1); j <= std::min(18, y + 1); ++j) {
+                    hi = std::max(hi, g(i, j));
+                    lo = std::min(lo, g(i, j));
+                }
+            }
+            dilate_ok = dilate_ok && dilated(x, y) == hi;
+            erode_ok = erode_ok && eroded(x, y) == lo;
+        }
+    }
+    BOOST_CHECK(dilate_ok);
+    BOOST_CHECK(erode_ok);
+
+    // disc inflation against brute force
+    au::grid<2, char> obstacles(40, 33);
+    for (auto it = obstacles.begin(); it != obstacles.end(); ++it) {
+        v = (v * 1103515245 + 12345) & 0x7fffffff;
+        *it = (v >> 16) % 100 < 2;
+    }
+    const double radius = 4.5;
+    au::grid<2, uint8_t> inflated;
+    au::inflate(obstacles, inflated, radius, [](char c) { return c != 0; }, pool);
+    bool inflate_ok = true;
+    for (int x = 0; x < 40; ++x) {
+        for (int y = 0; y < 33; ++y) {
+            bool near = false;
+            for (int i = 0; i < 40; ++i) {
+                for (int j = 0; j < 33; ++j) {
+                    near = near || (obstacles(i, j) &&
+                            (i - x) * (i - x) + (j - y) * (j - y) <= radius * radius);
+                }
+            }
+            inflate_ok = inflate_ok && inflated(x, y) == (near ? 1 : 0);
+        }
+    }
+    BOOST_CHECK(inflate_ok);
+
+    // the default predicate with a pool
+    au::grid<2, uint8_t> pooled;
+    au::inflate(obstacles, pooled, radius, pool);
+    BOOST_CHECK(std::equal(inflated.begin(), inflated.end(), pooled.begin()));
+
+    // incremental updates match a full inflation
+    au::grid_index<2, char> start(10, 12);
+    au::grid_index<2, char> end(13, 14);
+    for (size_t x = 10; x <= 13; ++x) {
+        for (size_t y = 12; y <= 14; ++y) {
+            obstacles(x, y) = (x + y) % 3 == 0;
+        }
+    }
+    obstacles(0, 0) = 0;
+    au::inflate_region(obstacles, inflated, radius, start, end);
+    au::inflate_region(obstacles, inflated, radius,
+            au::grid_index<2, char>(0, 0), au::grid_index<2, char>(0, 0));
+    au::grid<2, uint8_t> expected;
+    au::inflate(obstacles, expected, radius);
+    BOOST_CHECK(std::equal(inflated.begin(), inflated.end(), expected.begin()));
+}
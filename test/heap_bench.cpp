@@ -0,0 +1,882 @@
+// standard includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+// system includes
+#include <spellbook/grid/grid.h>
+#include <spellbook/heap/dary_heap.h>
+#include <spellbook/heap/heap.h>
+#include <spellbook/heap/intrusive_heap.h>
+#include <spellbook/heap/pairing_heap.h>
+#include <spellbook/heap/radix_heap.h>
+#include <spellbook/mapgen/DFSMazeGenerator.h>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock clock_type;
+
+double ElapsedMs(const clock_type::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void Report(const char* name, double ms, std::uint64_t checksum)
+{
+    std::cout << "  " << name << ": " << ms << " ms (checksum " << checksum << ")" << std::endl;
+}
+
+// An 8-connected grid graph with random positive cell costs; searches run
+// Dijkstra from the center, which is the push/decrease/pop mix of A* with a
+// zero heuristic.
+struct GridGraph
+{
+    int w;
+    int h;
+    std::vector<std::uint32_t> cost;
+
+    GridGraph(int w, int h) : w(w), h(h), cost(w * h)
+    {
+        std::mt19937 rng(0);
+        for (size_t i = 0; i < cost.size(); ++i) {
+            cost[i] = 1 + rng() % 16;
+        }
+    }
+
+    template <typename Visit>
+    void for_each_successor(int v, Visit visit) const
+    {
+        const int x = v % w;
+        const int y = v / w;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int nx = x + dx;
+                const int ny = y + dy;
+                if ((dx | dy) && nx >= 0 && nx < w && ny >= 0 && ny < h) {
+                    const int u = ny * w + nx;
+                    visit(u, cost[u] * ((dx & dy) ? 14 : 10));
+                }
+            }
+        }
+    }
+};
+
+struct SearchState : public au::heap_element
+{
+    std::uint32_t g;
+    bool closed;
+};
+
+struct SearchStateLess
+{
+    bool operator()(const SearchState& a, const SearchState& b) const { return a.g < b.g; }
+};
+
+std::uint64_t DijkstraIntrusive(const GridGraph& graph, int start)
+{
+    std::vector<SearchState> states(graph.cost.size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i].g = std::numeric_limits<std::uint32_t>::max();
+        states[i].closed = false;
+    }
+
+    au::intrusive_heap<SearchState, SearchStateLess> open;
+    open.reserve(states.size());
+    states[start].g = 0;
+    open.push(&states[start]);
+
+    std::uint64_t sum = 0;
+    while (!open.empty()) {
+        SearchState* s = open.min();
+        open.pop();
+        s->closed = true;
+        sum += s->g;
+        graph.for_each_successor((int)(s - &states[0]), [&](int u, std::uint32_t c)
+        {
+            SearchState& t = states[u];
+            if (t.closed || s->g + c >= t.g) {
+                return;
+            }
+            t.g = s->g + c;
+            if (open.contains(&t)) {
+                open.decrease(&t);
+            }
+            else {
+                open.push(&t);
+            }
+        });
+    }
+    return sum;
+}
+
+template <typename Heap>
+std::uint64_t DijkstraHandles(const GridGraph& graph, int start)
+{
+    typedef std::pair<std::uint32_t, int> entry;
+    typedef Heap heap_type;
+
+    std::vector<std::uint32_t> g(graph.cost.size(), std::numeric_limits<std::uint32_t>::max());
+    std::vector<bool> closed(graph.cost.size(), false);
+    std::vector<typename heap_type::handle_type> handles(graph.cost.size());
+
+    heap_type open;
+    open.reserve(graph.cost.size());
+    g[start] = 0;
+    handles[start] = open.push(entry(0, start));
+
+    std::uint64_t sum = 0;
+    while (!open.empty()) {
+        const entry e = open.min();
+        open.pop();
+        closed[e.second] = true;
+        sum += e.first;
+        graph.for_each_successor(e.second, [&](int u, std::uint32_t c)
+        {
+            if (closed[u] || e.first + c >= g[u]) {
+                return;
+            }
+            g[u] = e.first + c;
+            if (open.contains(handles[u])) {
+                open.decrease(handles[u], entry(g[u], u));
+            }
+            else {
+                handles[u] = open.push(entry(g[u], u));
+            }
+        });
+    }
+    return sum;
+}
+
+std::uint64_t DijkstraPriorityQueue(const GridGraph& graph, int start)
+{
+    typedef std::pair<std::uint32_t, int> entry;
+
+    std::vector<std::uint32_t> g(graph.cost.size(), std::numeric_limits<std::uint32_t>::max());
+    std::vector<bool> closed(graph.cost.size(), false);
+
+    // duplicates instead of decrease-key; stale entries are skipped
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    g[start] = 0;
+    open.push(entry(0, start));
+
+    std::uint64_t sum = 0;
+    while (!open.empty()) {
+        const entry e = open.top();
+        open.pop();
+        if (closed[e.second]) {
+            continue;
+        }
+        closed[e.second] = true;
+        sum += e.first;
+        graph.for_each_successor(e.second, [&](int u, std::uint32_t c)
+        {
+            if (closed[u] || e.first + c >= g[u]) {
+                return;
+            }
+            g[u] = e.first + c;
+            open.push(entry(g[u], u));
+        });
+    }
+    return sum;
+}
+
+void BenchmarkDijkstra(int w, int h)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Dijkstra 8-connected (" << w << " x " << h << ")" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    const GridGraph graph(w, h);
+    const int start = (h / 2) * w + w / 2;
+
+    auto t = clock_type::now();
+    std::uint64_t sum = DijkstraHandles<au::heap<std::pair<std::uint32_t, int>>>(graph, start);
+    Report("au::heap", ElapsedMs(t), sum);
+
+    t = clock_type::now();
+    sum = DijkstraHandles<au::pairing_heap<std::pair<std::uint32_t, int>>>(graph, start);
+    Report("au::pairing_heap", ElapsedMs(t), sum);
+
+    t = clock_type::now();
+    sum = DijkstraPriorityQueue(graph, start);
+    Report("std::priority_queue (lazy deletion)", ElapsedMs(t), sum);
+
+    t = clock_type::now();
+    sum = DijkstraIntrusive(graph, start);
+    Report("au::intrusive_heap", ElapsedMs(t), sum);
+}
+
+// A* over an 8-connected occupancy grid with an octile heuristic. Costs are
+// 10 per straight and 14 per diagonal step.
+struct AstarState : public au::heap_element
+{
+    std::uint32_t g;
+    std::uint32_t f;
+    std::uint32_t search; // states are reset lazily, on first visit
+    bool closed;
+};
+
+struct AstarStateLess
+{
+    bool operator()(const AstarState& a, const AstarState& b) const { return a.f < b.f; }
+};
+
+std::uint32_t Octile(int x0, int y0, int x1, int y1)
+{
+    const int dx = std::abs(x1 - x0);
+    const int dy = std::abs(y1 - y0);
+    return 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+}
+
+// Adapters that give the heaps a common interface, so that the searches
+// below differ only in the open list. Each is constructed with the array of
+// search states it will hold.
+struct IntrusiveOpenList
+{
+    au::intrusive_heap<AstarState, AstarStateLess> heap;
+
+    IntrusiveOpenList(AstarState* states, size_t n) { heap.reserve(n); }
+    bool empty() const { return heap.empty(); }
+    AstarState* pop() { AstarState* s = heap.min(); heap.pop(); return s; }
+    void insert_or_decrease(AstarState* s)
+    {
+        if (heap.contains(s)) {
+            heap.decrease(s);
+        }
+        else {
+            heap.push(s);
+        }
+    }
+};
+
+template <int Arity>
+struct DaryOpenList
+{
+    au::dary_heap<AstarState, std::uint32_t, std::less<std::uint32_t>, Arity> heap;
+
+    DaryOpenList(AstarState* states, size_t n) { heap.reserve(n); }
+    bool empty() const { return heap.empty(); }
+    AstarState* pop() { AstarState* s = heap.min(); heap.pop(); return s; }
+    void insert_or_decrease(AstarState* s)
+    {
+        if (heap.contains(s)) {
+            heap.decrease(s, s->f);
+        }
+        else {
+            heap.push(s, s->f);
+        }
+    }
+};
+
+// The radix heap that monotone_heap selects for the integer keys of grid
+// search.
+struct MonotoneOpenList
+{
+    au::monotone_heap<AstarState, std::uint32_t>::type heap;
+
+    MonotoneOpenList(AstarState* states, size_t n) { heap.reserve(n); }
+    bool empty() const { return heap.empty(); }
+    AstarState* pop() { AstarState* s = heap.min(); heap.pop(); return s; }
+    void insert_or_decrease(AstarState* s)
+    {
+        if (heap.contains(s)) {
+            heap.decrease(s, s->f);
+        }
+        else {
+            heap.push(s, s->f);
+        }
+    }
+};
+
+// au::heap and au::pairing_heap hold copies of (f, state index) and hand out
+// a handle per push, kept in a table indexed by state that is reused between
+// searches. The heap is reused too, and cleared at the end of each search,
+// which invalidates the handles it issued; a pairing_heap handle must not
+// outlive the heap's node pool, even to be tested with contains().
+template <typename Heap>
+struct HandleOpenList
+{
+    typedef Heap heap_type;
+
+    heap_type& heap;
+    AstarState* states;
+    std::vector<typename heap_type::handle_type>& handles;
+
+    static heap_type& shared_heap()
+    {
+        static heap_type heap;
+        return heap;
+    }
+
+    static std::vector<typename heap_type::handle_type>& handle_table()
+    {
+        static std::vector<typename heap_type::handle_type> table;
+        return table;
+    }
+
+    HandleOpenList(AstarState* states, size_t n) :
+        heap(shared_heap()), states(states), handles(handle_table())
+    {
+        heap.reserve(n);
+        if (handles.size() < n) {
+            handles.resize(n);
+        }
+    }
+
+    ~HandleOpenList() { heap.clear(); }
+
+    bool empty() const { return heap.empty(); }
+
+    AstarState* pop()
+    {
+        AstarState* s = &states[heap.min().second];
+        heap.pop();
+        return s;
+    }
+
+    void insert_or_decrease(AstarState* s)
+    {
+        const std::uint32_t i = (std::uint32_t)(s - states);
+        if (heap.contains(handles[i])) {
+            heap.decrease(handles[i], std::make_pair(s->f, i));
+        }
+        else {
+            handles[i] = heap.push(std::make_pair(s->f, i));
+        }
+    }
+};
+
+typedef HandleOpenList<au::heap<std::pair<std::uint32_t, std::uint32_t>>> HeapOpenList;
+typedef HandleOpenList<au::pairing_heap<std::pair<std::uint32_t, std::uint32_t>>> PairingOpenList;
+
+// Records the open list operations of a search, to replay them against
+// other heaps without the cost of the search itself.
+struct HeapOp
+{
+    enum Type { Insert, Pop, Clear } type;
+    std::uint32_t id;
+    std::uint32_t key;
+};
+
+std::vector<HeapOp>* g_trace = nullptr;
+AstarState* g_trace_base = nullptr;
+
+struct TracingOpenList : public IntrusiveOpenList
+{
+    TracingOpenList(AstarState* states, size_t n) : IntrusiveOpenList(states, n) { }
+
+    ~TracingOpenList()
+    {
+        HeapOp op = { HeapOp::Clear, 0, 0 };
+        g_trace->push_back(op);
+    }
+
+    AstarState* pop()
+    {
+        HeapOp op = { HeapOp::Pop, 0, 0 };
+        g_trace->push_back(op);
+        return IntrusiveOpenList::pop();
+    }
+
+    void insert_or_decrease(AstarState* s)
+    {
+        HeapOp op = { HeapOp::Insert, (std::uint32_t)(s - g_trace_base), s->f };
+        g_trace->push_back(op);
+        IntrusiveOpenList::insert_or_decrease(s);
+    }
+};
+
+struct TraceNode : public au::heap_element
+{
+    std::uint32_t key;
+};
+
+struct TraceNodeLess
+{
+    bool operator()(const TraceNode& a, const TraceNode& b) const { return a.key < b.key; }
+};
+
+// Heaps may break ties differently from the recorded one, so an insert of an
+// element that is not queued pushes it, and a pop from an empty heap is
+// skipped; every heap sees nearly the same sequence of sizes.
+std::uint64_t ReplayIntrusive(const std::vector<HeapOp>& trace, std::vector<TraceNode>& nodes)
+{
+    au::intrusive_heap<TraceNode, TraceNodeLess> heap;
+    heap.reserve(nodes.size());
+    std::uint64_t sum = 0;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const HeapOp& op = trace[i];
+        if (op.type == HeapOp::Pop) {
+            if (!heap.empty()) {
+                sum += heap.min()->key;
+                heap.pop();
+            }
+        }
+        else if (op.type == HeapOp::Clear) {
+            heap.clear();
+        }
+        else {
+            TraceNode* n = &nodes[op.id];
+            n->key = op.key;
+            if (heap.contains(n)) {
+                heap.update(n);
+            }
+            else {
+                heap.push(n);
+            }
+        }
+    }
+    return sum;
+}
+
+template <int Arity>
+std::uint64_t ReplayDary(const std::vector<HeapOp>& trace, std::vector<TraceNode>& nodes)
+{
+    au::dary_heap<TraceNode, std::uint32_t, std::less<std::uint32_t>, Arity> heap;
+    heap.reserve(nodes.size());
+    std::uint64_t sum = 0;
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const HeapOp& op = trace[i];
+        if (op.type == HeapOp::Pop) {
+            if (!heap.empty()) {
+                sum += heap.min_key();
+                heap.pop();
+            }
+        }
+        else if (op.type == HeapOp::Clear) {
+            heap.clear();
+        }
+        else {
+            TraceNode* n = &nodes[op.id];
+            if (heap.contains(n)) {
+                heap.update(n, op.key);
+            }
+            else {
+                heap.push(n, op.key);
+            }
+        }
+    }
+    return sum;
+}
+
+// With a zero heuristic weight the search is Dijkstra's algorithm, which
+// expands far more states and keeps a much larger open list.
+template <typename OpenList, typename Map>
+std::uint64_t Astar(
+    const Map& map,
+    std::vector<AstarState>& states,
+    std::uint32_t search,
+    int sx, int sy, int gx, int gy,
+    std::uint32_t weight)
+{
+    const int w = (int)map.size(0);
+    const int h = (int)map.size(1);
+
+    OpenList open(&states[0], states.size());
+    AstarState* start = &states[sx * h + sy];
+    start->search = search;
+    start->closed = false;
+    start->g = 0;
+    start->f = weight * Octile(sx, sy, gx, gy);
+    open.insert_or_decrease(start);
+
+    while (!open.empty()) {
+        AstarState* s = open.pop();
+        s->closed = true;
+        const int i = (int)(s - &states[0]);
+        const int x = i / h;
+        const int y = i % h;
+        if (x == gx && y == gy) {
+            return s->g;
+        }
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                const int nx = x + dx;
+                const int ny = y + dy;
+                if (!(dx | dy) || nx < 0 || nx >= w || ny < 0 || ny >= h || map(nx, ny)) {
+                    continue;
+                }
+                AstarState* t = &states[nx * h + ny];
+                if (t->search != search) {
+                    t->search = search;
+                    t->closed = false;
+                    t->g = std::numeric_limits<std::uint32_t>::max();
+                }
+                const std::uint32_t g = s->g + ((dx & dy) ? 14 : 10);
+                if (t->closed || g >= t->g) {
+                    continue;
+                }
+                t->g = g;
+                t->f = g + weight * Octile(nx, ny, gx, gy);
+                open.insert_or_decrease(t);
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename OpenList, typename Map>
+void RunAstarQueries(
+    const char* name,
+    const Map& map,
+    const std::vector<int>& queries,
+    std::uint32_t weight)
+{
+    std::vector<AstarState> states(map.total_size());
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i].search = 0;
+    }
+
+    // the checksum is the total path cost, which does not depend on how the
+    // heap breaks ties
+    std::uint64_t sum = 0;
+    auto t = clock_type::now();
+    for (size_t q = 0; q + 3 < queries.size(); q += 4) {
+        const std::uint32_t search = (std::uint32_t)(q / 4 + 1);
+        sum += Astar<OpenList>(map, states, search,
+                queries[q], queries[q + 1], queries[q + 2], queries[q + 3], weight);
+    }
+    Report(name, ElapsedMs(t), sum);
+}
+
+void BenchmarkGridAstar(int w, int h, int num_queries)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Grid A* (" << w << " x " << h << ", " << num_queries << " queries)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    // random rectangular obstacles covering roughly a quarter of the map
+    au::grid<2, std::uint8_t> map(w, h);
+    std::mt19937 rng(0);
+    for (int b = 0; b < w * h / 400; ++b) {
+        const int cx = rng() % w;
+        const int cy = rng() % h;
+        const int rx = 1 + rng() % 12;
+        const int ry = 1 + rng() % 12;
+        for (int x = std::max(0, cx - rx); x < std::min(w, cx + rx); ++x) {
+            for (int y = std::max(0, cy - ry); y < std::min(h, cy + ry); ++y) {
+                map(x, y) = 1;
+            }
+        }
+    }
+
+    // free start and goal cells far apart
+    std::vector<int> queries;
+    while ((int)queries.size() < 4 * num_queries) {
+        const int sx = rng() % (w / 4);
+        const int sy = rng() % h;
+        const int gx = w - 1 - rng() % (w / 4);
+        const int gy = rng() % h;
+        if (!map(sx, sy) && !map(gx, gy)) {
+            queries.push_back(sx);
+            queries.push_back(sy);
+            queries.push_back(gx);
+            queries.push_back(gy);
+        }
+    }
+
+    for (std::uint32_t weight = 0; weight <= 1; ++weight) {
+        std::cout << (weight ? "octile heuristic" : "zero heuristic") << std::endl;
+        RunAstarQueries<IntrusiveOpenList>("  intrusive_heap", map, queries, weight);
+        RunAstarQueries<DaryOpenList<2>>("  dary_heap<2>", map, queries, weight);
+        RunAstarQueries<DaryOpenList<4>>("  dary_heap<4>", map, queries, weight);
+        RunAstarQueries<DaryOpenList<8>>("  dary_heap<8>", map, queries, weight);
+    }
+
+    // the open list operations alone, recorded from the same searches
+    for (std::uint32_t weight = 0; weight <= 1; ++weight) {
+        std::vector<HeapOp> trace;
+        std::vector<AstarState> states(map.total_size());
+        for (size_t i = 0; i < states.size(); ++i) {
+            states[i].search = 0;
+        }
+        g_trace = &trace;
+        g_trace_base = &states[0];
+        for (size_t q = 0; q + 3 < queries.size(); q += 4) {
+            Astar<TracingOpenList>(map, states, (std::uint32_t)(q / 4 + 1),
+                    queries[q], queries[q + 1], queries[q + 2], queries[q + 3], weight);
+        }
+        g_trace = nullptr;
+
+        std::cout << "replayed " << (weight ? "octile" : "zero") << " heuristic trace (" <<
+                trace.size() << " operations)" << std::endl;
+        std::vector<TraceNode> nodes(map.total_size());
+        auto t = clock_type::now();
+        std::uint64_t sum = ReplayIntrusive(trace, nodes);
+        Report("  intrusive_heap", ElapsedMs(t), sum);
+        t = clock_type::now();
+        sum = ReplayDary<2>(trace, nodes);
+        Report("  dary_heap<2>", ElapsedMs(t), sum);
+        t = clock_type::now();
+        sum = ReplayDary<4>(trace, nodes);
+        Report("  dary_heap<4>", ElapsedMs(t), sum);
+        t = clock_type::now();
+        sum = ReplayDary<8>(trace, nodes);
+        Report("  dary_heap<8>", ElapsedMs(t), sum);
+    }
+}
+
+template <int Arity>
+std::uint64_t PushPopDary(const std::vector<std::uint32_t>& keys, std::vector<TraceNode>& nodes)
+{
+    au::dary_heap<TraceNode, std::uint32_t, std::less<std::uint32_t>, Arity> heap;
+    heap.reserve(nodes.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        heap.push(&nodes[i], keys[i]);
+    }
+    std::uint64_t sum = 0;
+    while (!heap.empty()) {
+        sum = 31 * sum + heap.min_key();
+        heap.pop();
+    }
+    return sum;
+}
+
+void BenchmarkHeapSort(size_t n)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Push then pop " << n << " random keys" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    std::vector<std::uint32_t> keys(n);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = rng();
+    }
+    std::vector<TraceNode> nodes(n);
+
+    au::intrusive_heap<TraceNode, TraceNodeLess> heap;
+    heap.reserve(n);
+    auto t = clock_type::now();
+    for (size_t i = 0; i < n; ++i) {
+        nodes[i].key = keys[i];
+        heap.push(&nodes[i]);
+    }
+    std::uint64_t sum = 0;
+    while (!heap.empty()) {
+        sum = 31 * sum + heap.min()->key;
+        heap.pop();
+    }
+    Report("intrusive_heap", ElapsedMs(t), sum);
+
+    t = clock_type::now();
+    sum = PushPopDary<2>(keys, nodes);
+    Report("dary_heap<2>", ElapsedMs(t), sum);
+    t = clock_type::now();
+    sum = PushPopDary<4>(keys, nodes);
+    Report("dary_heap<4>", ElapsedMs(t), sum);
+    t = clock_type::now();
+    sum = PushPopDary<8>(keys, nodes);
+    Report("dary_heap<8>", ElapsedMs(t), sum);
+}
+
+void BenchmarkMazeSearch(int w, int h, int hall_girth, int wall_girth, int num_queries)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Maze search (" << w << " x " << h << ", halls " << hall_girth <<
+            ", walls " << wall_girth << ", " << num_queries << " queries)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    Map map(w, h);
+    DFSMazeGenerator mazegen(hall_girth, wall_girth);
+    mazegen.generate(map);
+
+    std::vector<int> queries;
+    std::mt19937 rng(0);
+    while ((int)queries.size() < 4 * num_queries) {
+        const int sx = rng() % w;
+        const int sy = rng() % h;
+        const int gx = rng() % w;
+        const int gy = rng() % h;
+        if (!map(sx, sy) && !map(gx, gy)) {
+            queries.push_back(sx);
+            queries.push_back(sy);
+            queries.push_back(gx);
+            queries.push_back(gy);
+        }
+    }
+
+    for (std::uint32_t weight = 0; weight <= 1; ++weight) {
+        std::cout << (weight ? "octile heuristic" : "zero heuristic") << std::endl;
+        RunAstarQueries<HeapOpenList>("  au::heap", map, queries, weight);
+        RunAstarQueries<PairingOpenList>("  au::pairing_heap", map, queries, weight);
+        RunAstarQueries<DaryOpenList<4>>("  dary_heap<4>", map, queries, weight);
+        RunAstarQueries<MonotoneOpenList>("  radix_heap", map, queries, weight);
+    }
+}
+
+std::uint64_t DrainHeap(au::heap<std::uint32_t>& heap)
+{
+    std::uint64_t sum = 0;
+    while (!heap.empty()) {
+        sum = 31 * sum + heap.min();
+        heap.pop();
+    }
+    return sum;
+}
+
+void BenchmarkHeapBuild(size_t n, size_t batch)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Build au::heap from " << n << " random keys" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    std::vector<std::uint32_t> keys(n);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = rng();
+    }
+
+    // untimed build so the first timed one does not pay for faulting in memory
+    {
+        au::heap<std::uint32_t> heap(keys.begin(), keys.end());
+    }
+
+    std::uint64_t sum;
+    {
+        au::heap<std::uint32_t> heap;
+        heap.reserve(n);
+        auto t = clock_type::now();
+        for (size_t i = 0; i < n; ++i) {
+            heap.push(keys[i]);
+        }
+        Report("push loop", ElapsedMs(t), heap.size());
+        sum = DrainHeap(heap);
+    }
+    {
+        auto t = clock_type::now();
+        au::heap<std::uint32_t> heap(au::heap<std::uint32_t>::compare(), keys);
+        Report("container constructor", ElapsedMs(t), heap.size());
+        if (DrainHeap(heap) != sum) {
+            std::cerr << "checksum mismatch" << std::endl;
+        }
+    }
+    {
+        au::heap<std::uint32_t> heap;
+        auto t = clock_type::now();
+        heap.assign(keys.begin(), keys.end());
+        Report("assign", ElapsedMs(t), heap.size());
+        if (DrainHeap(heap) != sum) {
+            std::cerr << "checksum mismatch" << std::endl;
+        }
+    }
+    {
+        au::heap<std::uint32_t> heap;
+        auto t = clock_type::now();
+        for (size_t i = 0; i < n; i += batch) {
+            heap.push_range(keys.begin() + i, keys.begin() + std::min(n, i + batch));
+        }
+        Report("push_range batches", ElapsedMs(t), heap.size());
+        if (DrainHeap(heap) != sum) {
+            std::cerr << "checksum mismatch" << std::endl;
+        }
+    }
+
+    // expand the best batch repeatedly, as a batch-expanding planner would
+    std::vector<std::uint32_t> out;
+    out.reserve(batch);
+    {
+        au::heap<std::uint32_t> heap(keys.begin(), keys.end());
+        auto t = clock_type::now();
+        std::uint64_t s = 0;
+        while (!heap.empty()) {
+            for (size_t i = 0; i < batch && !heap.empty(); ++i) {
+                s = 31 * s + heap.min();
+                heap.pop();
+            }
+        }
+        Report("pop loop", ElapsedMs(t), s);
+    }
+    {
+        au::heap<std::uint32_t> heap(keys.begin(), keys.end());
+        auto t = clock_type::now();
+        std::uint64_t s = 0;
+        while (!heap.empty()) {
+            out.clear();
+            heap.pop_n(batch, std::back_inserter(out));
+            for (std::uint32_t k : out) {
+                s = 31 * s + k;
+            }
+        }
+        Report("pop_n", ElapsedMs(t), s);
+    }
+}
+
+// Replanning mix: after the initial n pushes, each round decreases the keys
+// of `decreases` random queued elements, to a random value no smaller than
+// the current minimum, then pops once. Each popped element is pushed back
+// with a larger key, so the heap keeps its size.
+template <typename Heap>
+std::uint64_t DecreaseKeyRounds(size_t n, int decreases, int rounds)
+{
+    typedef std::pair<std::uint32_t, std::uint32_t> entry;
+
+    Heap heap;
+    heap.reserve(n);
+    std::vector<typename Heap::handle_type> handles(n);
+    std::vector<std::uint32_t> keys(n);
+    std::mt19937 rng(0);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = (1u << 30) + rng() % (1u << 30);
+        handles[i] = heap.push(entry(keys[i], (std::uint32_t)i));
+    }
+
+    std::uint64_t sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        const std::uint32_t lo = heap.min().first;
+        for (int d = 0; d < decreases; ++d) {
+            const std::uint32_t i = rng() % n;
+            if (keys[i] > lo) {
+                keys[i] = lo + rng() % (keys[i] - lo);
+                heap.decrease(handles[i], entry(keys[i], i));
+            }
+        }
+        const entry e = heap.min();
+        heap.pop();
+        sum = 31 * sum + e.first;
+        keys[e.second] = e.first + (1u << 20) + rng() % (1u << 20);
+        handles[e.second] = heap.push(entry(keys[e.second], e.second));
+    }
+    return sum;
+}
+
+void BenchmarkDecreaseKey(size_t n, int rounds)
+{
+    std::cout << "----------------------" << std::endl;
+    std::cout << "| Decrease-key rounds (" << n << " elements, " << rounds << " pops)" << std::endl;
+    std::cout << "----------------------" << std::endl;
+
+    typedef std::pair<std::uint32_t, std::uint32_t> entry;
+    const int ratios[] = { 1, 8, 64 };
+    for (int decreases : ratios) {
+        std::cout << decreases << " decreases per pop" << std::endl;
+        auto t = clock_type::now();
+        std::uint64_t sum = DecreaseKeyRounds<au::heap<entry>>(n, decreases, rounds);
+        Report("  au::heap", ElapsedMs(t), sum);
+        t = clock_type::now();
+        sum = DecreaseKeyRounds<au::pairing_heap<entry>>(n, decreases, rounds);
+        Report("  au::pairing_heap", ElapsedMs(t), sum);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkDijkstra(1000, 1000);
+    BenchmarkGridAstar(1000, 1000, 20);
+    BenchmarkHeapSort(1 << 21);
+    BenchmarkMazeSearch(1000, 1000, 3, 1, 20);
+    BenchmarkHeapBuild(1 << 20, 1 << 10);
+    BenchmarkDecreaseKey(1 << 18, 1 << 16);
+    return 0;
+}
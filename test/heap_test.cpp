@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define BOOST_TEST_MODULE HeapTest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <spellbook/heap/dary_heap.h>
+#include <spellbook/heap/heap.h>
+#include <spellbook/heap/intrusive_heap.h>
+#include <spellbook/heap/pairing_heap.h>
+#include <spellbook/heap/radix_heap.h>
+
+namespace {
+
+struct node : public au::heap_element
+{
+    int key;
+    int id;
+};
+
+struct node_less
+{
+    bool operator()(const node& a, const node& b) const { return a.key < b.key; }
+};
+
+// counts live instances, to observe when the heap frees its elements
+struct counted
+{
+    static int live;
+    int value;
+
+    counted(int v) : value(v) { ++live; }
+    counted(const counted& o) : value(o.value) { ++live; }
+    counted& operator=(const counted& o) { value = o.value; return *this; }
+    ~counted() { --live; }
+
+    bool operator<(const counted& o) const { return value < o.value; }
+};
+
+int counted::live = 0;
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(HeapEraseTest)
+{
+    au::heap<int> h;
+    auto a = h.push(5);
+    h.push(3);
+    h.push(8);
+    auto d = h.push(9);
+    h.push(10);
+    h.push(11);
+    auto g = h.push(1);
+
+    // erasing an element whose replacement must move up
+    h.erase(d);
+    BOOST_CHECK(!h.contains(d));
+    BOOST_CHECK(h.contains(g));
+    BOOST_CHECK_EQUAL(h.size(), 6);
+
+    h.erase(a);
+    std::vector<int> popped;
+    while (!h.empty()) {
+        popped.push_back(h.min());
+        h.pop();
+    }
+    BOOST_CHECK((popped == std::vector<int>{ 1, 3, 8, 10, 11 }));
+
+    // popping the only element must not leave it in the heap
+    auto last = h.push(4);
+    h.pop();
+    BOOST_CHECK(!h.contains(last));
+}
+
+BOOST_AUTO_TEST_CASE(HeapBulkTest)
+{
+    std::mt19937 rng(0);
+    std::vector<int> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = rng() % 500;
+    }
+    std::vector<int> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    au::heap<int> h(values.begin(), values.end());
+    BOOST_CHECK_EQUAL(h.size(), values.size());
+    std::vector<int> popped;
+    h.pop_n(h.size(), std::back_inserter(popped));
+    BOOST_CHECK(popped == sorted);
+    BOOST_CHECK(h.empty());
+
+    // a small batch is percolated up, a large one triggers a rebuild
+    h.assign(values.begin(), values.begin() + 500);
+    h.push_range(values.begin() + 500, values.begin() + 510);
+    h.push_range(values.begin() + 510, values.end());
+    BOOST_CHECK_EQUAL(h.size(), values.size());
+
+    // handles to bulk-inserted elements are obtained by iteration
+    std::vector<au::heap<int>::handle_type> handles;
+    for (auto it = h.begin(); it != h.end(); ++it) {
+        handles.push_back(au::heap<int>::s_iterator_to_handle(it));
+    }
+    for (size_t i = 0; i < handles.size(); i += 2) {
+        BOOST_CHECK(h.contains(handles[i]));
+        h.erase(handles[i]);
+        BOOST_CHECK(!h.contains(handles[i]));
+    }
+
+    std::vector<int> top;
+    h.pop_n(10, std::back_inserter(top));
+    BOOST_CHECK_EQUAL(top.size(), 10);
+    BOOST_CHECK(std::is_sorted(top.begin(), top.end()));
+    BOOST_CHECK(h.empty() || top.back() <= h.min());
+    BOOST_CHECK_EQUAL(h.size(), values.size() - (handles.size() + 1) / 2 - 10);
+
+    // asking for more than is left drains the heap
+    popped.clear();
+    h.pop_n(values.size(), std::back_inserter(popped));
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK(std::is_sorted(popped.begin(), popped.end()));
+
+    // bulk-allocated elements are freed a block at a time, not all at once
+    {
+        std::vector<counted> cs(values.begin(), values.end());
+        au::heap<counted> c(cs.begin(), cs.end());
+        cs.clear();
+        BOOST_CHECK_EQUAL(counted::live, (int)values.size());
+        while (c.size() > 1) {
+            c.pop();
+        }
+        BOOST_CHECK(counted::live <= (int)au::heap<counted>::bulk_block_size);
+    }
+    BOOST_CHECK_EQUAL(counted::live, 0);
+}
+
+BOOST_AUTO_TEST_CASE(IntrusiveHeapTest)
+{
+    const int n = 1000;
+    std::vector<node> nodes(n);
+    std::mt19937 rng(0);
+    for (int i = 0; i < n; ++i) {
+        nodes[i].key = rng() % 500;
+        nodes[i].id = i;
+    }
+
+    au::intrusive_heap<node, node_less> h;
+    h.reserve(n);
+    BOOST_CHECK(h.empty());
+    for (int i = 0; i < n; ++i) {
+        h.push(&nodes[i]);
+    }
+    BOOST_CHECK_EQUAL(h.size(), n);
+    BOOST_CHECK(h.contains(&nodes[17]));
+
+    // change priorities in every direction, and remove some elements
+    for (int i = 0; i < n; i += 3) {
+        nodes[i].key -= 100;
+        h.decrease(&nodes[i]);
+    }
+    for (int i = 1; i < n; i += 7) {
+        nodes[i].key += 200;
+        h.increase(&nodes[i]);
+    }
+    for (int i = 2; i < n; i += 5) {
+        nodes[i].key = rng() % 1000 - 300;
+        h.update(&nodes[i]);
+    }
+    int erased = 0;
+    for (int i = 4; i < n; i += 11) {
+        h.erase(&nodes[i]);
+        BOOST_CHECK(!h.contains(&nodes[i]));
+        BOOST_CHECK_EQUAL(nodes[i].heap_index(), 0);
+        ++erased;
+    }
+    BOOST_CHECK_EQUAL(h.size(), n - erased);
+    BOOST_CHECK_EQUAL((int)std::distance(h.begin(), h.end()), n - erased);
+
+    std::vector<int> expected;
+    for (int i = 0; i < n; ++i) {
+        if (h.contains(&nodes[i])) {
+            expected.push_back(nodes[i].key);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<int> popped;
+    while (!h.empty()) {
+        node* e = h.min();
+        popped.push_back(e->key);
+        h.pop();
+        BOOST_CHECK(!h.contains(e));
+    }
+    BOOST_CHECK(popped == expected);
+
+    // bulk construction and clear
+    std::vector<node*> ptrs;
+    for (int i = 0; i < n; ++i) {
+        ptrs.push_back(&nodes[i]);
+    }
+    au::intrusive_heap<node, node_less> b(ptrs.begin(), ptrs.end());
+    BOOST_CHECK_EQUAL(b.size(), n);
+    BOOST_CHECK_EQUAL(b.min()->key, std::min_element(nodes.begin(), nodes.end(), node_less())->key);
+
+    au::intrusive_heap<node, node_less> m(std::move(b));
+    BOOST_CHECK(b.empty());
+    BOOST_CHECK_EQUAL(m.size(), n);
+    m.clear();
+    BOOST_CHECK(m.empty());
+    BOOST_CHECK(!m.contains(&nodes[0]));
+    BOOST_CHECK_EQUAL(nodes[0].heap_index(), 0);
+}
+
+template <int Arity>
+void CheckDaryHeap()
+{
+    const int n = 1000;
+    std::vector<node> nodes(n);
+    std::vector<double> keys(n);
+    std::mt19937 rng(Arity);
+    for (int i = 0; i < n; ++i) {
+        nodes[i].id = i;
+        keys[i] = rng() % 500;
+    }
+
+    au::dary_heap<node, double, std::less<double>, Arity> h;
+    BOOST_CHECK(h.empty());
+    for (int i = 0; i < n; ++i) {
+        h.push(&nodes[i], keys[i]);
+    }
+    BOOST_CHECK_EQUAL(h.size(), n);
+
+    // with 16-byte entries, every child group starts on a cache line
+    if (Arity % 4 == 0) {
+        BOOST_CHECK_EQUAL((size_t)(h.begin() + 1) % 64, 0);
+    }
+
+    for (int i = 0; i < n; i += 3) {
+        keys[i] -= 100;
+        h.decrease(&nodes[i], keys[i]);
+    }
+    for (int i = 1; i < n; i += 7) {
+        keys[i] += 200;
+        h.increase(&nodes[i], keys[i]);
+    }
+    for (int i = 2; i < n; i += 5) {
+        keys[i] = rng() % 1000 - 300.0;
+        h.update(&nodes[i], keys[i]);
+    }
+    for (int i = 4; i < n; i += 11) {
+        h.erase(&nodes[i]);
+        BOOST_CHECK(!h.contains(&nodes[i]));
+    }
+    BOOST_CHECK_EQUAL(h.key(&nodes[5]), keys[5]);
+
+    std::vector<std::pair<double, int>> expected;
+    for (int i = 0; i < n; ++i) {
+        if (h.contains(&nodes[i])) {
+            expected.push_back(std::make_pair(keys[i], i));
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(h.size(), expected.size());
+
+    std::vector<double> popped;
+    while (!h.empty()) {
+        BOOST_CHECK_EQUAL(h.min_key(), keys[h.min()->id]);
+        popped.push_back(h.min_key());
+        node* e = h.min();
+        h.pop();
+        BOOST_CHECK(!h.contains(e));
+    }
+    BOOST_REQUIRE_EQUAL(popped.size(), expected.size());
+    for (size_t i = 0; i < popped.size(); ++i) {
+        BOOST_CHECK_EQUAL(popped[i], expected[i].first);
+    }
+
+    h.push(&nodes[0], 1.0);
+    h.push(&nodes[1], 0.0);
+    h.clear();
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK_EQUAL(nodes[1].heap_index(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(DaryHeapTest)
+{
+    CheckDaryHeap<2>();
+    CheckDaryHeap<3>();
+    CheckDaryHeap<4>();
+    CheckDaryHeap<8>();
+}
+
+BOOST_AUTO_TEST_CASE(RadixHeapTest)
+{
+    static_assert(std::is_same<
+            au::monotone_heap<node, unsigned>::type,
+            au::radix_heap<node, unsigned>>::value, "unsigned keys should select radix_heap");
+    static_assert(std::is_same<
+            au::monotone_heap<node, double>::type,
+            au::dary_heap<node, double>>::value, "other keys should select dary_heap");
+
+    // random monotone operations, checked against a linear scan
+    const int n = 2000;
+    std::vector<node> nodes(n);
+    std::vector<std::uint32_t> keys(n);
+    for (int i = 0; i < n; ++i) {
+        nodes[i].id = i;
+    }
+
+    au::radix_heap<node, std::uint32_t> h;
+    h.reserve(n);
+    std::mt19937 rng(0);
+    std::uint32_t last = 0;
+    int pops = 0;
+    for (int step = 0; step < 20000; ++step) {
+        node* e = &nodes[rng() % n];
+        const std::uint32_t key = last + rng() % 1000;
+        switch (rng() % 4) {
+        case 0:
+        case 1:
+            if (h.contains(e)) {
+                if (key < keys[e->id]) {
+                    keys[e->id] = key;
+                    h.decrease(e, key);
+                }
+            }
+            else {
+                keys[e->id] = key;
+                h.push(e, key);
+            }
+            break;
+        case 2:
+            if (!h.empty()) {
+                std::uint32_t expected = std::numeric_limits<std::uint32_t>::max();
+                for (int i = 0; i < n; ++i) {
+                    if (h.contains(&nodes[i])) {
+                        expected = std::min(expected, keys[i]);
+                    }
+                }
+                BOOST_REQUIRE_EQUAL(h.min_key(), expected);
+                BOOST_REQUIRE_EQUAL(keys[h.top()->id], expected);
+                last = h.min_key();
+                node* m = h.top();
+                h.pop();
+                BOOST_REQUIRE(!h.contains(m));
+                ++pops;
+            }
+            break;
+        case 3:
+            if (h.contains(e)) {
+                if (rng() % 2) {
+                    h.erase(e);
+                    BOOST_REQUIRE(!h.contains(e));
+                }
+                else {
+                    keys[e->id] = key;
+                    h.update(e, key);
+                    BOOST_REQUIRE_EQUAL(h.key(e), key);
+                }
+            }
+            break;
+        }
+    }
+    BOOST_CHECK(pops > 1000);
+
+    size_t count = 0;
+    for (int i = 0; i < n; ++i) {
+        count += h.contains(&nodes[i]);
+    }
+    BOOST_CHECK_EQUAL(h.size(), count);
+
+    std::uint32_t prev = 0;
+    while (!h.empty()) {
+        BOOST_CHECK(h.min_key() >= prev);
+        prev = h.min_key();
+        h.pop();
+    }
+
+    // clear() starts a new monotone sequence
+    h.clear();
+    h.push(&nodes[0], 7);
+    h.push(&nodes[1], 5);
+    BOOST_CHECK_EQUAL(h.top(), &nodes[1]);
+    h.clear();
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK(!h.contains(&nodes[1]));
+}
+
+BOOST_AUTO_TEST_CASE(PairingHeapTest)
+{
+    typedef std::pair<int, int> entry; // (key, id)
+    typedef au::pairing_heap<entry> heap_type;
+
+    // random mutations, checked against a linear scan
+    const int n = 2000;
+    std::vector<heap_type::handle_type> handles(n);
+    std::vector<int> keys(n);
+
+    heap_type h;
+    std::mt19937 rng(0);
+    int pops = 0;
+    for (int step = 0; step < 20000; ++step) {
+        const int i = rng() % n;
+        const int key = rng() % 1000;
+        switch (rng() % 5) {
+        case 0:
+        case 1:
+            if (h.contains(handles[i])) {
+                if (key < keys[i]) {
+                    keys[i] = key;
+                    h.decrease(handles[i], entry(key, i));
+                }
+            }
+            else {
+                keys[i] = key;
+                handles[i] = h.push(entry(key, i));
+            }
+            break;
+        case 2:
+            if (!h.empty()) {
+                entry expected(std::numeric_limits<int>::max(), 0);
+                for (int j = 0; j < n; ++j) {
+                    if (h.contains(handles[j])) {
+                        expected = std::min(expected, entry(keys[j], j));
+                    }
+                }
+                BOOST_REQUIRE(h.min() == expected);
+                h.pop();
+                BOOST_REQUIRE(!h.contains(handles[expected.second]));
+                ++pops;
+            }
+            break;
+        case 3:
+            if (h.contains(handles[i])) {
+                keys[i] = std::max(keys[i], key);
+                h.increase(handles[i], entry(keys[i], i));
+                BOOST_REQUIRE_EQUAL((*handles[i]).first, keys[i]);
+            }
+            break;
+        case 4:
+            if (h.contains(handles[i])) {
+                if (rng() % 2) {
+                    h.erase(handles[i]);
+                    BOOST_REQUIRE(!h.contains(handles[i]));
+                }
+                else {
+                    keys[i] = key;
+                    h.update(handles[i], entry(key, i));
+                }
+            }
+            break;
+        }
+    }
+    BOOST_CHECK(pops > 1000);
+
+    size_t count = 0;
+    for (int i = 0; i < n; ++i) {
+        count += h.contains(handles[i]);
+    }
+    BOOST_CHECK_EQUAL(h.size(), count);
+
+    // moving transfers the elements and the handles stay usable
+    heap_type g(std::move(h));
+    BOOST_CHECK(h.empty());
+    BOOST_CHECK_EQUAL(g.size(), count);
+    entry prev(-1, 0);
+    while (!g.empty()) {
+        BOOST_CHECK(prev < g.min());
+        prev = g.min();
+        g.pop();
+    }
+
+    // a recycled node does not revive a stale handle
+    heap_type::handle_type a = g.push(entry(1, 0));
+    g.pop();
+    heap_type::handle_type b = g.push(entry(2, 1));
+    BOOST_CHECK(!g.contains(a));
+    BOOST_CHECK(g.contains(b));
+    g.clear();
+    BOOST_CHECK(!g.contains(b));
+    BOOST_CHECK(!g.contains(heap_type::handle_type()));
+
+    // elements with non-trivial destructors are destroyed
+    au::pairing_heap<std::string> s;
+    s.reserve(4);
+    s.push("pairing");
+    auto c = s.push("heap");
+    s.push("test");
+    s.decrease(c, "a heap");
+    BOOST_CHECK_EQUAL(s.top(), "a heap");
+    s.pop();
+    BOOST_CHECK_EQUAL(s.top(), "pairing");
+}